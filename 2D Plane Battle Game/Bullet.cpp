@@ -1,33 +1,36 @@
 #include "Bullet.h"
 
-Bullet::Bullet(const BackBuffer *pBackBuffer, std::string owner)
+static const char *BULLET_IMAGE_FILE	= "data/bullet1.bmp";
+static const char *BULLET_MASK_FILE		= "data/bullet1_mask.bmp";
+
+BulletPool::BulletPool(const BackBuffer *pBackBuffer, CEntityStore *pStore, const CAssetLoader *pAssets) : m_pStore(pStore)
 {
-	this->owner = owner;
-	m_pSprite = new Sprite("data/bullet1.bmp", "data/bullet1_mask.bmp");
+	// the bullet image is loaded once and shared by all the bullets
+	m_pSprite = new Sprite(BULLET_IMAGE_FILE, BULLET_MASK_FILE, pAssets);
 	m_pSprite->setBackBuffer(pBackBuffer);
 }
 
-Bullet::~Bullet()
+BulletPool::~BulletPool()
 {
-	//bullet destructor code here
+	delete m_pSprite;
 }
 
-void Bullet::Move()
+void BulletPool::AddAssets(CAssetLoader& assets)
 {
-	// if the enemy shoots, the bullets will come from top -> bottom
-	if (owner == "enemy")
-	{
-		this->m_pSprite->mPosition.y += 3;
-	}
-
-	// if the player shoots, the bullets will come from bottom -> top
-	else
-	{
-		this->m_pSprite->mPosition.y -= 3;
-	}	
+	assets.Add(BULLET_IMAGE_FILE);
+	assets.Add(BULLET_MASK_FILE);
 }
 
-void Bullet::Stop()
+void BulletPool::Draw(float fAlpha)
 {
-	this->m_pSprite->mPosition.y -= .001;
+	const float *px = m_pStore->PosX();
+	const float *py = m_pStore->PosY();
+	const float *ox = m_pStore->PrevX();
+	const float *oy = m_pStore->PrevY();
+
+	for (int i = 0; i < m_pStore->Count(); i++)
+	{
+		m_pSprite->mPosition = Vec2((double)(ox[i] + (px[i] - ox[i]) * fAlpha), (double)(oy[i] + (py[i] - oy[i]) * fAlpha));
+		m_pSprite->draw();
+	}
 }
@@ -9,26 +9,44 @@
 #ifndef _BULLET_H_
 #define _BULLET_H_
 
-#include <string>
-
 #include "Main.h"
 #include "Sprite.h"
+#include "EntityStore.h"
 
-
-class Bullet
+//-----------------------------------------------------------------------------
+// Name : BulletPool (Class)
+// Desc : Draws all the bullets on screen. The bullets themselves live in a
+//		CEntityStore owned by the simulation (one contiguous array per
+//		attribute, fixed capacity), the bullet image is loaded only once and
+//		shared by all of them.
+//-----------------------------------------------------------------------------
+class BulletPool
 {
 public:
-	Bullet(const BackBuffer *pBackBuffer, std::string owner = "");
-	~Bullet();
+	BulletPool(const BackBuffer *pBackBuffer, CEntityStore *pStore, const CAssetLoader *pAssets = NULL);
+	~BulletPool();
 
-	Sprite*					m_pSprite;
+	// queues the bullet image for the startup loader
+	static void				AddAssets(CAssetLoader& assets);
 
-	std::string owner;
-	void Move();
-	void Stop();
-};
+	// draws every bullet fAlpha of the way from its previous to its current position
+	void					Draw(float fAlpha);
 
-#endif // !_BULLET_H_
+	// shared bullet image (used for drawing and for collision shapes)
+	Sprite*					GetSprite() const { return m_pSprite; }
+	CEntityStore&			Store() { return *m_pStore; }
 
+	int						Capacity() const { return m_pStore->Capacity(); }
+	int						ActiveCount() const { return m_pStore->Count(); }
+	int						HighWaterMark() const { return m_pStore->HighWaterMark(); }
 
+private:
+	// the pool is not designed to be copied
+	BulletPool(const BulletPool& rhs);
+	BulletPool& operator=(const BulletPool& rhs);
 
+	CEntityStore			*m_pStore;
+	Sprite*					m_pSprite;
+};
+
+#endif // !_BULLET_H_
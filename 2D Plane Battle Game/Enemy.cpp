@@ -1,55 +1,34 @@
 #include "Enemy.h"
-#include "CGameApp.h"
 
-// we need to use the instance of CGameApp that is defined in Main.cpp
-// g_App -> Core game application processing engine
-extern CGameApp g_App;
+static const char *ENEMY_IMAGE_FILE = "data/enemy_plane.bmp";
 
-Enemy::Enemy(const BackBuffer *pBackBuffer)
+EnemySquadron::EnemySquadron(const BackBuffer *pBackBuffer, CEntityStore *pStore, const CAssetLoader *pAssets) : m_pStore(pStore)
 {
-	m_pSprite = new Sprite("data/enemy_plane.bmp", RGB(0xff, 0x00, 0xff));
+	// the enemy image is loaded once and shared by all the enemy planes
+	m_pSprite = new Sprite(ENEMY_IMAGE_FILE, RGB(0xff, 0x00, 0xff), pAssets);
 	m_pSprite->setBackBuffer(pBackBuffer);
 }
 
-Enemy::~Enemy()
+EnemySquadron::~EnemySquadron()
 {
-	//enemy destructor code here
+	delete m_pSprite;
 }
 
-void Enemy::move()
-{	
-	if (this->m_pSprite->mPosition.x == 200)
-	{
-		left = false;
-	}
-
-	if (this->m_pSprite->mPosition.x == 1700)
-	{
-		left = true;
-	}
-	
-	if (this->m_pSprite->mPosition.x < 1700 && left == false)
-	{
-		this->m_pSprite->mPosition.x += 3;
-	}
-
-	if (this->m_pSprite->mPosition.x > 200 && left == true)
-	{
-		this->m_pSprite->mPosition.x -= 3;
-	}
+void EnemySquadron::AddAssets(CAssetLoader& assets)
+{
+	assets.Add(ENEMY_IMAGE_FILE);
 }
 
-void Enemy::Shoot()
+void EnemySquadron::Draw(float fAlpha)
 {
-	if (shootCooldown < 5) {
-		Bullet bullet(g_App.m_pBBuffer, "enemy");
-		
-		// enemy will shoot
-		bullet.m_pSprite->mPosition = this->m_pSprite->mPosition;
-		
-		// save all instances of bullets in the container in order to draw them
-		g_App.bulletsOnScreen.push_back(bullet);
-		
-		shootCooldown = 100;
+	const float *px = m_pStore->PosX();
+	const float *py = m_pStore->PosY();
+	const float *ox = m_pStore->PrevX();
+	const float *oy = m_pStore->PrevY();
+
+	for (int i = 0; i < m_pStore->Count(); i++)
+	{
+		m_pSprite->mPosition = Vec2((double)(ox[i] + (px[i] - ox[i]) * fAlpha), (double)(oy[i] + (py[i] - oy[i]) * fAlpha));
+		m_pSprite->draw();
 	}
 }
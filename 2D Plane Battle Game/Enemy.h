@@ -1,19 +1,31 @@
 #pragma once
 #include "Main.h"
 #include "Sprite.h"
-#include "../Bullet.h"
+#include "EntityStore.h"
 
-class Enemy
+// Draws all the enemy planes on screen. The planes are kept in a
+// CEntityStore owned by the simulation (position, direction flag and
+// shooting cooldown in separate arrays) and share a single sprite.
+class EnemySquadron
 {
 public:
-	Enemy(const BackBuffer *pBackBuffer);
-	~Enemy();
-	
-	bool hit =              false;
+	EnemySquadron(const BackBuffer *pBackBuffer, CEntityStore *pStore, const CAssetLoader *pAssets = NULL);
+	~EnemySquadron();
+
+	// queues the enemy image for the startup loader
+	static void AddAssets(CAssetLoader& assets);
+
+	// draws every plane fAlpha of the way from its previous to its current position
+	void Draw(float fAlpha);
+
+	Sprite*					GetSprite() const { return m_pSprite; }
+	CEntityStore&			Store() { return *m_pStore; }
+	int						Count() const { return m_pStore->Count(); }
+
+private:
+	EnemySquadron(const EnemySquadron& rhs);
+	EnemySquadron& operator=(const EnemySquadron& rhs);
+
+	CEntityStore			*m_pStore;
 	Sprite*					m_pSprite;
-	int shootCooldown =     150;
-	void move();
-	void Shoot();
-	bool left =             false;
 };
-
@@ -0,0 +1,111 @@
+//-----------------------------------------------------------------------------
+// File: AssetLoader.h
+//
+// Desc: Decodes the bitmaps the game needs at startup in the background, so
+//		the window can come up (and show a loading screen) while the files
+//		are read. The files are decoded with CBmpDecoder on the thread pool,
+//		or taken from an asset pack when one is set, and the objects that use
+//		them pick the pixels up once Start() has finished.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _ASSETLOADER_H_
+#define _ASSETLOADER_H_
+
+//-----------------------------------------------------------------------------
+// CAssetLoader Specific Includes
+//-----------------------------------------------------------------------------
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FrameBuffer.h"
+
+class CThreadPool;
+class CAssetPack;
+
+//-----------------------------------------------------------------------------
+// Name : CAssetLoader (Class)
+// Desc : Files are queued with Add(), decoded after Start() and read back
+//		once IsFinished() (or after Wait()). Nothing may be added or read
+//		while the loading runs.
+//-----------------------------------------------------------------------------
+class CAssetLoader
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CAssetLoader();
+	virtual ~CAssetLoader();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Queues a file and returns its index, a file queued twice is decoded once
+	int						Add(const char *szFileName);
+
+	// The images found in pPack are attached to it instead of being decoded,
+	// the pack must stay open as long as the pixels are used (NULL decodes
+	// every file)
+	void					SetPack(const CAssetPack *pPack) { m_pPack = pPack; }
+	const CAssetPack*		GetPack() const { return m_pPack; }
+
+	// Decodes the queued files on pPool (NULL runs them one after the other)
+	// and returns at once
+	void					Start(CThreadPool *pPool);
+	void					Wait();
+
+	bool					IsFinished() const { return m_bFinished; }
+	int						Count() const { return (int)m_Assets.size(); }
+	int						LoadedCount() const { return m_iLoaded; }
+
+	// Index of a queued file, -1 if it was never added
+	int						Find(const char *szFileName) const;
+
+	// The decoded pixels (top-down), empty if the file could not be decoded,
+	// in which case the caller can still try the system loader
+	const CFrameBuffer&		Pixels(int iIndex) const { return *m_Assets[iIndex].pPixels; }
+	bool					Succeeded(int iIndex) const { return !m_Assets[iIndex].pPixels->IsEmpty(); }
+	const char*				FileName(int iIndex) const { return m_Assets[iIndex].strFileName.c_str(); }
+
+	// Milliseconds spent decoding one file, and from Start() to the end of
+	// the last one
+	double					LoadTime(int iIndex) const { return m_Assets[iIndex].dLoadTime; }
+	double					TotalTime() const { return m_dTotalTime; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures
+	//-------------------------------------------------------------------------
+	struct Asset
+	{
+		std::string			strFileName;
+		CFrameBuffer		*pPixels;		// CFrameBuffer can't be copied
+		double				dLoadTime;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	// The loader owns a thread, it is not designed to be copied
+	CAssetLoader(const CAssetLoader& rhs);
+	CAssetLoader& operator=(const CAssetLoader& rhs);
+
+	void					LoadAll(CThreadPool *pPool);
+	void					LoadAsset(Asset& asset);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	std::vector<Asset>		m_Assets;
+	const CAssetPack		*m_pPack;
+	std::thread				m_Thread;
+	std::atomic<int>		m_iNext;			// next asset to claim
+	std::atomic<int>		m_iLoaded;
+	std::atomic<bool>		m_bFinished;
+	double					m_dTotalTime;
+};
+
+#endif // _ASSETLOADER_H_
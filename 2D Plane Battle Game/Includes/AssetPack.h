@@ -0,0 +1,102 @@
+//-----------------------------------------------------------------------------
+// File: AssetPack.h
+//
+// Desc: Single file holding the bitmaps of the game already converted to
+//		the 32 bit top-down pixels the game draws with (masks included), so
+//		loading one is a lookup in the mapped file instead of opening and
+//		decoding a bitmap. The pack is built from the loose files by
+//		tools/PackAssets, or by the game itself with "-buildpack" on the
+//		command line (CGameApp::BuildAssetPack).
+//
+//		Layout, little endian like the bitmaps:
+//			header		"PBAP", version, image count, 0			(16 bytes)
+//			index		name[64], width, height, 64 bit offset	(80 bytes each)
+//			pixels		width * height * 4 bytes per image, 64 byte aligned
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _ASSETPACK_H_
+#define _ASSETPACK_H_
+
+//-----------------------------------------------------------------------------
+// CAssetPack Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "FrameBuffer.h"
+#include "MappedFile.h"
+
+//-----------------------------------------------------------------------------
+// Name : CAssetPack (Class)
+// Desc : Read only view of a mapped pack. The images point into the
+//		mapping, they are valid until Close() or the destructor.
+//-----------------------------------------------------------------------------
+class CAssetPack
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CAssetPack();
+	virtual ~CAssetPack();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Maps the pack and checks the header and the index, false if the file
+	// is missing or isn't a valid pack
+	bool					Open(const char *szFileName);
+	void					Close();
+	bool					IsOpen() const { return m_File.IsOpen(); }
+
+	// Index of an image by the name of its bitmap (case and slashes don't
+	// matter), -1 if the pack doesn't have it
+	int						Find(const char *szName) const;
+
+	int						Count() const { return (int)m_Entries.size(); }
+	const char*				Name(int iIndex) const { return m_Entries[iIndex].strName.c_str(); }
+	int						Width(int iIndex) const { return m_Entries[iIndex].iWidth; }
+	int						Height(int iIndex) const { return m_Entries[iIndex].iHeight; }
+	const uint32_t*			Pixels(int iIndex) const { return m_Entries[iIndex].pPixels; }
+
+	// Attaches pixels to the image in place, no copy. The frame buffer must
+	// only be read, the mapping is read only.
+	bool					GetImage(const char *szName, CFrameBuffer& pixels) const;
+
+	// Decodes the bitmaps and writes them to a pack, returns how many were
+	// packed (the files that can't be read are left out) or -1 if the pack
+	// can't be written
+	static int				Build(const char *szPackFile, const std::vector<std::string>& files);
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures
+	//-------------------------------------------------------------------------
+	struct Entry
+	{
+		std::string			strName;
+		int					iWidth;
+		int					iHeight;
+		const uint32_t		*pPixels;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	// The mapping is owned, it is not designed to be copied
+	CAssetPack(const CAssetPack& rhs);
+	CAssetPack& operator=(const CAssetPack& rhs);
+
+	static bool				SameName(const char *a, const char *b);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	CMappedFile				m_File;
+	std::vector<Entry>		m_Entries;
+};
+
+#endif // _ASSETPACK_H_
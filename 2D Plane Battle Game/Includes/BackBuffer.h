@@ -4,7 +4,34 @@
 #ifndef BACKBUFFER_H
 #define BACKBUFFER_H
 #include "main.h"
+#include "FrameBuffer.h"
+#include "TiledCompositor.h"
+#include "DirtyRegion.h"
+#include <vector>
 
+// Uploads a finished frame to the client area of a window.
+class GdiPresenter : public CFramePresenter
+{
+public:
+	GdiPresenter(HWND hWnd) : mhWnd(hWnd) { }
+
+	virtual void Present(const CFrameBuffer& frame);
+	virtual void PresentRects(const CFrameBuffer& frame, const FrameRect *pRects, int nRects);
+
+private:
+	HWND mhWnd;
+};
+
+// The back buffer is a 32 bit top-down DIB section: the sprites are
+// composited straight into its pixels on the CPU (see Blitters.h), while
+// the DC is still there for the GDI drawing (backgrounds, text). The
+// finished frame is handed to the presenter.
+//
+// Frames started with beginFrame() only redraw what changed: the back
+// buffer keeps a copy of the background, erases the sprites of the last
+// frame by restoring their areas from it, and presents the areas of the
+// old and new sprites. When those cover too much of the frame it falls
+// back to a full copy and a full present.
 class BackBuffer
 {
 public:
@@ -14,9 +41,40 @@ public:
 	void present();
 	void reset();
 
+	// Starts a frame over the background iBackground (any number the
+	// caller tells its backgrounds apart with). Returns true when the
+	// caller has to paint the background now: first frame, another
+	// background, after invalidate(), or without a compositor (the sprites
+	// must be recorded to know where they are). A background whose pixels
+	// change needs a new number or an invalidate().
+	bool beginFrame(int iBackground);
+
+	// The next frame is painted and presented whole (the window contents
+	// were lost, the background changed...)
+	void invalidate() { mbHasBackground = false; }
+
+	// Pixels cleared or restored plus pixels uploaded to the window during
+	// the last presented frame
+	size_t getPixelsTouched() const { return mPixelsTouched; }
+
+	// Replaces the presenter (NULL restores the GDI one). The back
+	// buffer does not take ownership.
+	void setPresenter(CFramePresenter *pPresenter);
+
+	// With a compositor the sprites only record their blits in it, and
+	// present() draws them (tiles in parallel) before showing the frame.
+	// NULL makes the sprites draw straight away. The back buffer does not
+	// take ownership.
+	void setCompositor(CTiledCompositor *pCompositor) { mpCompositor = pCompositor; }
+	CTiledCompositor* getCompositor() const { return mpCompositor; }
+
 	HDC getDC() const { return mhDC; }
 	HWND getHWND() const { return mhWnd; }
 
+	// The pixels of the back buffer. Pending GDI drawing is flushed
+	// first, so CPU and GDI drawing can be mixed in any order.
+	CFrameBuffer& getFrame() const;
+
 	int width() const { return mWidth; }
 	int height() const { return mHeight; }
 
@@ -38,5 +96,28 @@ private:
 	HBITMAP mhOldObject;
 	int mWidth;
 	int mHeight;
+
+	mutable CFrameBuffer mFrame;
+	GdiPresenter mGdiPresenter;
+	CFramePresenter *mpPresenter;
+	CTiledCompositor *mpCompositor;
+
+	// How the frame being drawn was started
+	enum FrameMode
+	{
+		FRAME_WHOLE,		// not by beginFrame(), presented whole
+		FRAME_REPAINTED,	// the caller painted the background
+		FRAME_DIRTY			// the last frame's sprites were erased
+	};
+
+	FrameMode mFrameMode;
+	CFrameBuffer mBackground;		// the background as last painted
+	int miBackground;
+	bool mbHasBackground;
+	CDirtyRegion mDirty;			// covered by the sprites of this frame
+	CDirtyRegion mLastDirty;		// covered by the sprites of the last frame
+	std::vector<FrameRect> mRects;
+	size_t mFramePixels;			// touched so far in this frame
+	size_t mPixelsTouched;
 };
 #endif // BACKBUFFER_H
\ No newline at end of file
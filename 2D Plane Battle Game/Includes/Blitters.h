@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------
+// File: Blitters.h
+//
+// Desc: Sprite compositing on CFrameBuffer surfaces. Every operation clips
+//		the rectangle against both surfaces and then runs a row kernel. The
+//		kernels exist as a scalar reference and as SSE2 / AVX2 versions that
+//		produce exactly the same pixels; the widest one the processor
+//		supports is picked at run time.
+//
+//		The operations reproduce the results of the GDI raster operations
+//		the sprites used to be drawn with:
+//			Copy		SRCCOPY
+//			ColorKey	SRCINVERT, SRCAND (mono mask of the key), SRCINVERT
+//			Mask		SRCAND (mask), SRCPAINT (image)
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _BLITTERS_H_
+#define _BLITTERS_H_
+
+//-----------------------------------------------------------------------------
+// CBlitter Specific Includes
+//-----------------------------------------------------------------------------
+#include "FrameBuffer.h"
+
+//-----------------------------------------------------------------------------
+// Name : CBlitter (Class)
+// Desc : Static blit operations. (x, y) is the destination of the upper-left
+//		corner of the source rectangle (sx, sy, w, h), either may be partly
+//		outside its surface.
+//-----------------------------------------------------------------------------
+class CBlitter
+{
+public:
+	//-------------------------------------------------------------------------
+	// Enumerators
+	//-------------------------------------------------------------------------
+	enum EPath
+	{
+		PATH_SCALAR,
+		PATH_SSE2,
+		PATH_AVX2
+	};
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// dst = src
+	static void		Copy(CFrameBuffer& dst, int x, int y, const CFrameBuffer& src, int sx, int sy, int w, int h);
+
+	// dst = src, except where the color of src (the low 24 bits) is uKey
+	static void		ColorKey(CFrameBuffer& dst, int x, int y, const CFrameBuffer& src, int sx, int sy, int w, int h, uint32_t uKey);
+
+	// dst = (dst & mask) | src, mask and src share the same coordinates
+	static void		Mask(CFrameBuffer& dst, int x, int y, const CFrameBuffer& src, const CFrameBuffer& mask, int sx, int sy, int w, int h);
+
+	// The Mask row kernel on n pixels, for the blitters that walk their
+	// own rows (see CRleSprite)
+	static void		MaskRow(uint32_t *d, const uint32_t *s, const uint32_t *m, int n);
+
+	// Kernel selection, a path the processor lacks falls back to the best
+	// one available. The scalar path is the reference implementation.
+	static void		SetPath(EPath path);
+	static EPath	GetPath();
+	static EPath	GetBestPath();
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Shrinks the rectangle to the part inside both surfaces,
+	// returns false when nothing is left
+	static bool		Clip(const CFrameBuffer& dst, int& x, int& y, const CFrameBuffer& src, int& sx, int& sy, int& w, int& h);
+};
+
+#endif // _BLITTERS_H_
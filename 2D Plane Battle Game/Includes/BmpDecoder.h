@@ -0,0 +1,66 @@
+//-----------------------------------------------------------------------------
+// File: BmpDecoder.h
+//
+// Desc: Self contained reader for the .bmp files of the game. Uncompressed
+//		1, 4 and 8 bit palette images, 24 bit and 32 bit images (BI_RGB or
+//		BI_BITFIELDS with the standard masks), bottom-up or top-down, are
+//		converted straight from the file bytes into 32 bit pixels in the
+//		caller's buffer. Anything else (RLE, 16 bit, OS/2 headers) is
+//		reported as unsupported so the caller can fall back to the system
+//		loader.
+//
+//		Output pixels are 0x00RRGGBB like CFrameBuffer, the reserved byte is
+//		always 0.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _BMPDECODER_H_
+#define _BMPDECODER_H_
+
+//-----------------------------------------------------------------------------
+// CBmpDecoder Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include "FrameBuffer.h"
+
+//-----------------------------------------------------------------------------
+// Name : CBmpDecoder (Class)
+// Desc : Static decoding functions working on the bytes of a whole file,
+//		usually a CMappedFile view.
+//-----------------------------------------------------------------------------
+class CBmpDecoder
+{
+public:
+	//-------------------------------------------------------------------------
+	// Public Structures
+	//-------------------------------------------------------------------------
+	struct BmpInfo
+	{
+		int				iWidth;
+		int				iHeight;			// always positive
+		int				iBitCount;
+		bool			bTopDown;			// rows stored top to bottom in the file
+	};
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Reads and validates the headers, false if the file is not a bmp this
+	// decoder supports or if it is truncated
+	static bool			ReadInfo(const uint8_t *pData, size_t uSize, BmpInfo& info);
+
+	// Writes the iWidth x iHeight pixels to pDst (iDstPitch in pixels).
+	// bBottomUp stores the bottom row first, the order of a DIB with a
+	// positive height, otherwise the top row comes first.
+	static bool			Decode(const uint8_t *pData, size_t uSize, uint32_t *pDst, int iDstPitch, bool bBottomUp);
+
+	// Maps the file and decodes it into a top-down frame buffer
+	static bool			LoadFile(const char *szFileName, CFrameBuffer& pixels);
+
+	// 24 bit BGR to 32 bit pixels, n pixels (SIMD when the processor has it)
+	static void			Expand24To32(uint32_t *pDst, const uint8_t *pSrc, int n);
+};
+
+#endif // _BMPDECODER_H_
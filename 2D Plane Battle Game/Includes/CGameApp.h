@@ -17,6 +17,12 @@
 #include "CPlayer.h"
 #include "BackBuffer.h"
 #include "ImageFile.h"
+#include "Simulation.h"
+#include "GdiStats.h"
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "ThreadPool.h"
+#include "SpriteAtlas.h"
 #include "../Bullet.h"
 #include "../Enemy.h"
 #include <list>
@@ -27,6 +33,14 @@
 #include <windows.h>
 #include <MMSystem.h>
 
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const float DEFAULT_TICK_RATE		= 60.0f;	// Simulation ticks per second
+const float DEFAULT_FRAME_RATE_CAP	= 120.0f;	// Rendered frames per second (0 = no cap)
+const float MAX_FRAME_TIME			= 0.25f;	// Longest frame the simulation catches up on
+const char	ASSET_PACK_FILE[]		= "data/assets.pack";	// Baked bitmaps, used instead of the loose files when present
+
 //-----------------------------------------------------------------------------
 // Forward Declarations
 //-----------------------------------------------------------------------------
@@ -55,40 +69,48 @@ public:
 	bool		InitInstance( LPCTSTR lpCmdLine, int iCmdShow );
 	int		    BeginGame( );
 	bool		ShutDown( );
+
+	// The game logic runs in fixed ticks, the rendering runs as often as the
+	// cap allows and interpolates between the last two ticks
+	void		SetTickRate( float fTicksPerSecond );
+	void		SetFrameRateCap( float fFramesPerSecond );
+
+	// Bakes the startup bitmaps into ASSET_PACK_FILE ("-buildpack"), returns
+	// the exit code
+	int			BuildAssetPack( );
 	
 	//-------------------------------------------------------------------------
 	// Public Variables for This Class
 	//-------------------------------------------------------------------------
-	int         plane_lives = 2;
-	int			enemy_lives = 2;
-
 	USHORT					Width;
 	USHORT					Height;
 	BackBuffer*				m_pBBuffer;
-	// we have a STL list that saves all the bullet objects 
-	std::list<Bullet>	   bulletsOnScreen;
-	// we have a STL list that saves all the enemy objects 
-	std::list<Enemy>	   enemyOnScreen;
+	// draws the bullets of the simulation (fixed size pool, shared sprite)
+	BulletPool*				m_pBullets;
+	// draws the enemy planes of the simulation
+	EnemySquadron*			m_pEnemies;
 	HWND					m_hWnd;			 // Main window HWND
 private:
 	//-------------------------------------------------------------------------
 	// Private Functions for This Class
 	//-------------------------------------------------------------------------
 	bool		BuildObjects( );
+	bool		FinishLoading( );
+	static void	AddStartupAssets( CAssetLoader& assets );
+	void		DrawLoading( );
 	void		ReleaseObjects( );
 	void		FrameAdvance( );
 	bool		CreateDisplay( );
 	void		SetupGameState();
 	void		AnimateObjects( );
-	void		DrawObjects( );
+	void		DrawObjects( float fAlpha );
+	void		SimulationTick( );
+	void		HandleEvents( );
+	void		ParseCommandLine( LPCTSTR lpCmdLine );
 	void		ProcessInput( );
 	void        Save_game();
 	void        Load_game();
 
-	
-	// Collision detection method that tests if two sprites touch each other
-	// Used for bullet contact and for the case in which planes touch each other
-	bool Sprite_Collide(Sprite * entity1, Sprite * entity2);
 
 	
 	//-------------------------------------------------------------------------
@@ -101,6 +123,10 @@ private:
 	//-------------------------------------------------------------------------
 	CTimer				  m_Timer;			// Game timer
 	ULONG				   m_LastFrameRate;	// Used for making sure we update only when fps changes.
+
+	float					m_fTickTime;		// Length of a simulation tick (seconds)
+	float					m_fAccumulator;		// Real time not simulated yet
+	float					m_fFrameTime;		// Shortest time between two frames (0 = no cap)
 	
 	
 	HICON				   m_hIcon;			// Window Icon
@@ -126,6 +152,19 @@ private:
 	
 	CPlayer*				m_pPlayer;
 	CPlayer*				m_pPlayer1;
+
+	// Decodes the startup bitmaps while the loading screen is shown, NULL
+	// once the game objects are built
+	CAssetLoader*			m_pAssets;
+	CAssetPack				m_Pack;				// the sprite images point into it, open until ReleaseObjects
+	double					m_dStartTime;		// InitInstance time, for the time to first frame
+	bool					m_bFirstFrame;		// no game frame drawn yet
+
+	CSpriteAtlas			m_Atlas;			// every sprite image, the sprites draw from it
+	CTiledCompositor		m_Compositor;		// the sprites of a frame, drawn tile by tile at present
+
+	CSimulation				m_Sim;				// The game logic (players, enemies, bullets)
+	SimInput				m_Input;			// Input collected for the next tick
 };
 
 #endif // _CGAMEAPP_H_
\ No newline at end of file
@@ -47,22 +47,24 @@ public:
 	//-------------------------------------------------------------------------
 	// Constructors & Destructors for This Class.
 	//-------------------------------------------------------------------------
-			 CPlayer(const BackBuffer *pBackBuffer);
+			 CPlayer(const BackBuffer *pBackBuffer, const CAssetLoader *pAssets = NULL);
 	virtual ~CPlayer();
 
 	//-------------------------------------------------------------------------
 	// Public Functions for This Class.
 	//-------------------------------------------------------------------------
+	// queues the bitmaps of the player for the startup loader
+	static void				AddAssets(CAssetLoader& assets);
+
 	void					Update( float dt );
+	// draws the plane at Position() (the movement itself is simulated by CSimulation)
 	void					Draw();
-	void					Move(ULONG ulDirection);
 	Vec2&					Position();
-	Vec2&					Velocity();
 
-	void					Explode();
+	// starts the explosion animation at the given place
+	void					Explode(const Vec2& position);
 	bool					AdvanceExplosion();
-	void					Shoot();
-	int						fireCooldown = 100;
+	AnimatedSprite*			ExplosionSprite() const { return m_pExplosionSprite; }
 	Sprite*					m_pSprite;
 private:
 	//-------------------------------------------------------------------------
@@ -45,6 +45,8 @@ public:
 	void			Tick( float fLockFPS = 0.0f );
 	unsigned long	GetFrameRate( LPTSTR lpszString = NULL, size_t size = 0 ) const;
 	float			GetTimeElapsed() const;
+	float			GetFrameTime() const;
+	double			GetTime() const;
 
 private:
 	//------------------------------------------------------------
@@ -52,12 +54,13 @@ private:
 	//------------------------------------------------------------
 	bool			m_PerfHardware;			 // Has Performance Counter
 	float			m_TimeScale;				// Amount to scale counter
-	float			m_TimeElapsed;			  // Time elapsed since previous frame
+	float			m_TimeElapsed;			  // Time elapsed since previous frame (averaged)
+	float			m_FrameTime;				// Time elapsed since previous frame (unfiltered)
 	__int64			m_CurrentTime;			  // Current Performance Counter
 	__int64			m_LastTime;				 // Performance Counter last frame
 	__int64			m_PerfFreq;				 // Performance Frequency
 
-	float			m_FrameTime[MAX_SAMPLE_COUNT];
+	float			m_FrameTimes[MAX_SAMPLE_COUNT];
 	ULONG			m_SampleCount;
 
 	unsigned long	m_FrameRate;				// Stores current framerate
@@ -0,0 +1,76 @@
+//-----------------------------------------------------------------------------
+// File: CollisionMask.h
+//
+// Desc: 1 bit per pixel silhouette of a sprite, used for the pixel exact
+//		collision test. Every row is packed in 64 bit words (bit i of word k
+//		is pixel 64 * k + i), so two masks are tested against each other by
+//		ANDing whole words of the rows inside the bounding box intersection.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _COLLISIONMASK_H_
+#define _COLLISIONMASK_H_
+
+//-----------------------------------------------------------------------------
+// CCollisionMask Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Name : CCollisionMask (Class)
+// Desc : Packed collision bitmask, built once when the sprite is loaded.
+//-----------------------------------------------------------------------------
+class CCollisionMask
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CCollisionMask();
+	virtual ~CCollisionMask();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Pixels are 32 bit 0x00RRGGBB, top-down rows, iStride in pixels.
+	// Solid where the image pixel differs from the transparent color.
+	void					BuildFromColorKey(const uint32_t *pPixels, int iWidth, int iHeight, int iStride, uint32_t uColorKey);
+	// Solid where the mask pixel is dark (the SRCAND mask convention).
+	void					BuildFromMask(const uint32_t *pMask, int iWidth, int iHeight, int iStride);
+	// Every pixel solid (a plain box, when no image is available)
+	void					BuildSolid(int iWidth, int iHeight);
+
+	// Tests the masks for a common solid pixel. (dx, dy) is the upper-left
+	// corner of the other mask relative to the upper-left corner of this one.
+	bool					Overlaps(const CCollisionMask& other, int dx, int dy) const;
+
+	bool					IsEmpty() const { return m_Bits.empty(); }
+	bool					Test(int x, int y) const;
+	int						Width() const { return m_iWidth; }
+	int						Height() const { return m_iHeight; }
+	size_t					MemorySize() const { return m_Bits.size() * sizeof(uint64_t); }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					Allocate(int iWidth, int iHeight);
+	const uint64_t*			Row(int y) const { return &m_Bits[y * m_iWordsPerRow]; }
+
+	// 64 bits of a row starting at an arbitrary bit offset (may be negative
+	// down to -63), bits outside the row read as 0
+	uint64_t				Bits(const uint64_t *pRow, int iOffset) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	std::vector<uint64_t>	m_Bits;
+	int						m_iWidth;
+	int						m_iHeight;
+	int						m_iWordsPerRow;
+};
+
+#endif // _COLLISIONMASK_H_
@@ -0,0 +1,76 @@
+//-----------------------------------------------------------------------------
+// File: ColorSpace.h
+//
+// Desc: Conversions between the 0x00RRGGBB pixels and single channels (red,
+//		green, blue, hue, saturation, luminosity) stored as bytes, a row at a
+//		time. The red / green / blue channels are plain byte copies. The
+//		hue / saturation / luminosity kernels exist as a scalar
+//		reference and as SSE2 (4 pixels per step) / AVX2 (8 pixels per step)
+//		versions doing the same float operations in the same order, so they
+//		produce exactly the same bytes; the widest one the processor supports
+//		is picked at run time.
+//
+//		The channels are stored as bytes:
+//			hue				degrees * 255 / 360, 0 for the grays
+//			saturation		0 .. 1 scaled to 0 .. 255, 0 for the grays
+//			luminosity		(max + min) / 2 scaled to 0 .. 255
+//		The values are truncated, as CImageFile::CopyMonoImage always did.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _COLORSPACE_H_
+#define _COLORSPACE_H_
+
+//-----------------------------------------------------------------------------
+// CColorSpace Specific Includes
+//-----------------------------------------------------------------------------
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Name : CColorSpace (Class)
+// Desc : Static row conversions. The pixels are read and written in place,
+//		their top byte is left alone.
+//-----------------------------------------------------------------------------
+class CColorSpace
+{
+public:
+	//-------------------------------------------------------------------------
+	// Enumerators
+	//-------------------------------------------------------------------------
+	enum EChannel
+	{
+		CHANNEL_RED,
+		CHANNEL_GREEN,
+		CHANNEL_BLUE,
+		CHANNEL_HUE,
+		CHANNEL_SATURATION,
+		CHANNEL_LUMINOSITY
+	};
+
+	enum EPath
+	{
+		PATH_SCALAR,
+		PATH_SSE2,
+		PATH_AVX2
+	};
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// pDst[i] = channel of pSrc[i]
+	static void		ExtractRow(EChannel chn, uint8_t *pDst, const uint32_t *pSrc, int n);
+
+	// Replaces the channel of pPixels[i] with pSrc[i], keeping the others
+	// (for hue / saturation / luminosity HSL back to RGB, rounded to the
+	// nearest byte)
+	static void		PasteRow(EChannel chn, uint32_t *pPixels, const uint8_t *pSrc, int n);
+
+	// Kernel selection, a path the processor lacks falls back to the best
+	// one available. The scalar path is the reference implementation.
+	static void		SetPath(EPath path);
+	static EPath	GetPath();
+	static EPath	GetBestPath();
+};
+
+#endif // _COLORSPACE_H_
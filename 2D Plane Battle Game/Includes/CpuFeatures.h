@@ -0,0 +1,60 @@
+//-----------------------------------------------------------------------------
+// File: CpuFeatures.h
+//
+// Desc: Run time detection of the SIMD instruction sets, so the pixel
+//		kernels can pick the widest path the machine supports while the
+//		executable still runs on older processors.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _CPUFEATURES_H_
+#define _CPUFEATURES_H_
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define CPU_X86 1
+#else
+	#define CPU_X86 0
+#endif
+
+// Functions using SSSE3 / AVX2 intrinsics are marked with these, GCC and
+// Clang only emit them for functions compiled for that target (MSVC always
+// does)
+#if CPU_X86 && (defined(__GNUC__) || defined(__clang__))
+	#define CPU_TARGET_SSSE3 __attribute__((target("ssse3")))
+	#define CPU_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define CPU_TARGET_SSSE3
+	#define CPU_TARGET_AVX2
+#endif
+
+//-----------------------------------------------------------------------------
+// Name : CCpuFeatures (Class)
+// Desc : Static queries, the processor is inspected once on first use.
+//		Any thread may ask (the loader threads and the main thread do).
+//-----------------------------------------------------------------------------
+class CCpuFeatures
+{
+public:
+	static bool		HasSSE2();
+	static bool		HasSSSE3();
+	static bool		HasAVX2();
+
+private:
+	struct Features
+	{
+		bool		bSSE2;
+		bool		bSSSE3;
+		bool		bAVX2;
+	};
+
+	// The features, detected by the first caller (a function-local static,
+	// so concurrent first calls wait for it)
+	static const Features&	Get();
+	static Features	Detect();
+};
+
+#endif // _CPUFEATURES_H_
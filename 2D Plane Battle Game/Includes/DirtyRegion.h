@@ -0,0 +1,78 @@
+//-----------------------------------------------------------------------------
+// File: DirtyRegion.h
+//
+// Desc: The parts of a frame that changed, kept as a grid of small cells so
+//		marking thousands of sprite rectangles costs a few writes each and
+//		the result can be turned into a short list of rectangles to restore
+//		or to present. The rectangles cover whole cells, clipped to the
+//		frame, so they cover a little more than what was marked.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _DIRTYREGION_H_
+#define _DIRTYREGION_H_
+
+//-----------------------------------------------------------------------------
+// CDirtyRegion Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "FrameBuffer.h"
+
+//-----------------------------------------------------------------------------
+// Name : CDirtyRegion (Class)
+// Desc : Sized for a frame with Resize(), then marked and read back. Two
+//		regions of the same size can be combined.
+//-----------------------------------------------------------------------------
+class CDirtyRegion
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CDirtyRegion(int iCellSize = DEFAULT_CELL_SIZE);
+	virtual ~CDirtyRegion();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Covers a iWidth x iHeight frame, nothing marked
+	void					Resize(int iWidth, int iHeight);
+	void					Clear();
+
+	// Marks a rectangle, the part outside the frame is ignored
+	void					Mark(int x, int y, int w, int h);
+	void					MarkAll();
+
+	// Adds the cells marked in another region of the same size
+	void					Add(const CDirtyRegion& other);
+	void					Swap(CDirtyRegion& other);
+
+	bool					IsEmpty() const { return m_nMarked == 0; }
+
+	// Pixels of the frame covered by the marked cells
+	size_t					Area() const;
+
+	// Rectangles covering exactly the marked cells: the runs of marked cells
+	// of every row of cells, the same run on consecutive rows joined
+	void					GetRects(std::vector<FrameRect>& rects) const;
+
+	int						Width() const { return m_iWidth; }
+	int						Height() const { return m_iHeight; }
+
+	enum { DEFAULT_CELL_SIZE = 32 };
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	int						m_iCellSize;
+	int						m_iWidth, m_iHeight;
+	int						m_nColumns, m_nRows;
+	std::vector<uint8_t>	m_Cells;		// row by row, 1 when marked
+	int						m_nMarked;
+};
+
+#endif // _DIRTYREGION_H_
@@ -0,0 +1,139 @@
+//-----------------------------------------------------------------------------
+// File: EntityStore.h
+//
+// Desc: Structure of arrays storage for the entities that exist in large
+//		numbers (bullets, enemies). Every attribute lives in its own
+//		contiguous array so movement and collision passes stream linearly
+//		through memory. Entities are kept densely packed (swap remove) and
+//		are referred to from outside through stable, generation checked
+//		handles.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _ENTITYSTORE_H_
+#define _ENTITYSTORE_H_
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// Side an entity fights for
+enum EFaction
+{
+	FACTION_PLAYER,
+	FACTION_ENEMY
+};
+
+// Stable reference to an entity, stays valid while the slots move around
+struct EntityHandle
+{
+	int				id;
+	unsigned int	generation;
+};
+
+//-----------------------------------------------------------------------------
+// Name : CEntityStore (Class)
+// Desc : Fixed capacity SoA entity storage with stable handles.
+//-----------------------------------------------------------------------------
+class CEntityStore
+{
+public:
+	//-------------------------------------------------------------------------
+	// Enumerators
+	//-------------------------------------------------------------------------
+	enum EFlags
+	{
+		FLAG_HIT		= 1,
+		FLAG_LEFT		= 2
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CEntityStore(int iCapacity);
+	virtual ~CEntityStore();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Adds an entity, returns an invalid handle (id == -1) if the store is full
+	EntityHandle			Create(float x, float y, float vx, float vy, unsigned char faction);
+	void					Destroy(EntityHandle h);
+	void					DestroyAt(int iSlot);
+	void					Clear();
+
+	// Slot of a live entity, -1 if the handle is stale
+	int						SlotOf(EntityHandle h) const;
+	bool					IsAlive(EntityHandle h) const { return SlotOf(h) != -1; }
+	EntityHandle			HandleAt(int iSlot) const;
+
+	// Moves every entity by its velocity (one linear pass)
+	void					Integrate(float dt);
+
+	// Copies the positions into PrevX / PrevY, called at the start of every
+	// simulation tick so drawing can interpolate between two ticks
+	void					SavePositions();
+
+	int						Count() const { return m_iCount; }
+	int						Capacity() const { return m_iCapacity; }
+	int						HighWaterMark() const { return m_iHighWaterMark; }
+
+	// Attribute arrays, valid for slots [0, Count())
+	float*					PosX() { return m_pPosX; }
+	float*					PosY() { return m_pPosY; }
+	float*					VelX() { return m_pVelX; }
+	float*					VelY() { return m_pVelY; }
+	float*					PrevX() { return m_pPrevX; }
+	float*					PrevY() { return m_pPrevY; }
+	unsigned char*			Faction() { return m_pFaction; }
+	unsigned char*			Flags() { return m_pFlags; }
+	float*					Cooldown() { return m_pCooldown; }
+
+	// Destroys every entity whose slot satisfies pred(slot). The scan goes
+	// backwards so the swap remove never skips an entity.
+	template <typename Pred>
+	void RemoveIf(Pred pred)
+	{
+		for (int i = m_iCount - 1; i >= 0; i--)
+		{
+			if (pred(i))
+			{
+				DestroyAt(i);
+			}
+		}
+	}
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	// The store is not designed to be copied
+	CEntityStore(const CEntityStore& rhs);
+	CEntityStore& operator=(const CEntityStore& rhs);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	int						m_iCapacity;
+	int						m_iCount;
+	int						m_iHighWaterMark;		// highest number of entities alive at once
+
+	float					*m_pPosX;
+	float					*m_pPosY;
+	float					*m_pVelX;
+	float					*m_pVelY;
+	float					*m_pPrevX;				// position at the start of the tick
+	float					*m_pPrevY;
+	unsigned char			*m_pFaction;
+	unsigned char			*m_pFlags;
+	float					*m_pCooldown;			// seconds
+
+	// handle bookkeeping
+	int						*m_pIdOfSlot;			// slot -> handle id
+	int						*m_pSlotOfId;			// handle id -> slot (-1 if free)
+	unsigned int			*m_pGeneration;			// bumped every time an id is freed
+	int						*m_pFreeIds;			// stack of free handle ids
+	int						m_iFreeCount;
+};
+
+#endif // _ENTITYSTORE_H_
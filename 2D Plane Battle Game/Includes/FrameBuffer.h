@@ -0,0 +1,106 @@
+//-----------------------------------------------------------------------------
+// File: FrameBuffer.h
+//
+// Desc: CPU side 32 bit pixel surface. The back buffer and the sprite images
+//		are kept in this format so every sprite is composited by the blitters
+//		(see Blitters.h) and the finished frame is handed to a presenter,
+//		which is the only part that talks to the platform.
+//
+//		Pixels are 0x00RRGGBB (the byte order of a 32 bit BI_RGB DIB), rows
+//		are top-down and the pitch is counted in pixels.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _FRAMEBUFFER_H_
+#define _FRAMEBUFFER_H_
+
+//-----------------------------------------------------------------------------
+// CFrameBuffer Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Name : FrameRect (Struct)
+// Desc : Area of a frame, (x, y) is the upper-left corner.
+//-----------------------------------------------------------------------------
+struct FrameRect
+{
+	int						x, y;
+	int						w, h;
+};
+
+//-----------------------------------------------------------------------------
+// Name : CFrameBuffer (Class)
+// Desc : Either owns its pixels (Create) or wraps memory that belongs to
+//		someone else, for example a DIB section (Attach).
+//-----------------------------------------------------------------------------
+class CFrameBuffer
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CFrameBuffer();
+	virtual ~CFrameBuffer();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					Create(int iWidth, int iHeight);
+	void					Attach(uint32_t *pPixels, int iWidth, int iHeight, int iPitch);
+	void					Release();
+
+	void					Fill(uint32_t uColor);
+
+	bool					IsEmpty() const { return m_pPixels == 0; }
+	int						Width() const { return m_iWidth; }
+	int						Height() const { return m_iHeight; }
+	int						Pitch() const { return m_iPitch; }
+
+	// Bytes of pixels the buffer owns, 0 when they are attached
+	size_t					MemorySize() const { return m_Storage.size() * sizeof(uint32_t); }
+
+	uint32_t*				Pixels() { return m_pPixels; }
+	const uint32_t*			Pixels() const { return m_pPixels; }
+	uint32_t*				Row(int y) { return m_pPixels + y * m_iPitch; }
+	const uint32_t*			Row(int y) const { return m_pPixels + y * m_iPitch; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	// The pixels are not designed to be copied around
+	CFrameBuffer(const CFrameBuffer& rhs);
+	CFrameBuffer& operator=(const CFrameBuffer& rhs);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	uint32_t				*m_pPixels;
+	int						m_iWidth;
+	int						m_iHeight;
+	int						m_iPitch;
+	std::vector<uint32_t>	m_Storage;		// empty when the pixels are attached
+};
+
+//-----------------------------------------------------------------------------
+// Name : CFramePresenter (Class)
+// Desc : Shows a finished frame. The Win32 build uploads it to the window,
+//		a headless build can keep it, compare it or simply drop it.
+//-----------------------------------------------------------------------------
+class CFramePresenter
+{
+public:
+	virtual ~CFramePresenter() {}
+
+	virtual void			Present(const CFrameBuffer& frame) = 0;
+
+	// Shows only the given areas of the frame, the rest of the shown frame
+	// is still up to date. Presenters that can't do better show it whole.
+	virtual void			PresentRects(const CFrameBuffer& frame, const FrameRect * /*pRects*/, int /*nRects*/) { Present(frame); }
+};
+
+#endif // _FRAMEBUFFER_H_
@@ -0,0 +1,38 @@
+//-----------------------------------------------------------------------------
+// File: GdiStats.h
+//
+// Desc: Counts the GDI objects (DCs, bitmaps) the game creates, so we can
+//	check that nothing is created per frame once the game is running.
+//-----------------------------------------------------------------------------
+
+#ifndef _GDISTATS_H_
+#define _GDISTATS_H_
+
+//-----------------------------------------------------------------------------
+// CGdiStats Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+
+//-----------------------------------------------------------------------------
+// Name : CGdiStats (Class)
+// Desc : Static counters, call OnCreate() next to every GDI object creation
+//		and EndFrame() once per rendered frame.
+//-----------------------------------------------------------------------------
+class CGdiStats
+{
+public:
+	static void		OnCreate( ULONG ulCount = 1 ) { s_ulTotal += ulCount; }
+	static void		EndFrame();
+
+	// GDI objects created during the last complete frame
+	static ULONG	GetLastFrameCount() { return s_ulLastFrame; }
+	// GDI objects created since the application started
+	static ULONG	GetTotalCount() { return s_ulTotal; }
+
+private:
+	static ULONG	s_ulTotal;
+	static ULONG	s_ulFrameStart;
+	static ULONG	s_ulLastFrame;
+};
+
+#endif // _GDISTATS_H_
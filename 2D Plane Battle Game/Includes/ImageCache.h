@@ -0,0 +1,129 @@
+//-----------------------------------------------------------------------------
+// File: ImageCache.h
+//
+// Desc: Process wide cache of the sprite images. Sprites made from the same
+//		image file with the same transparency (the same mask file, or the
+//		same color key) share one read only copy of the pixels and of the
+//		collision mask, however many of them exist. The cache only keeps
+//		weak references, an image is freed with the last sprite using it.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _IMAGECACHE_H_
+#define _IMAGECACHE_H_
+
+//-----------------------------------------------------------------------------
+// CImageCache Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "FrameBuffer.h"
+#include "CollisionMask.h"
+#include "RleSprite.h"
+
+//-----------------------------------------------------------------------------
+// Name : SpriteImage (Struct)
+// Desc : Everything a sprite draws and collides with. Never modified once
+//		the cache has handed it out.
+//-----------------------------------------------------------------------------
+struct SpriteImage
+{
+	CFrameBuffer			image;
+	CFrameBuffer			mask;			// empty for a color keyed image
+	uint32_t				uColorKey;		// 0x00RRGGBB, unused with a mask
+	CCollisionMask			collision;
+	CRleSprite				rle;			// the opaque spans of image
+
+	SpriteImage() : uColorKey(0) {}
+};
+
+//-----------------------------------------------------------------------------
+// Name : CImageCache (Class)
+// Desc : Safe to use from several threads. The files are read through the
+//		caller's load function, so the cache does not care where the pixels
+//		come from.
+//-----------------------------------------------------------------------------
+class CImageCache
+{
+public:
+	//-------------------------------------------------------------------------
+	// Public Structures
+	//-------------------------------------------------------------------------
+	// Reads a file as top-down 32 bit pixels, false if it can't
+	typedef std::function<bool(const char *szFileName, CFrameBuffer& pixels)> LoadFn;
+
+	struct Stats
+	{
+		int					iEntries;		// images alive
+		size_t				uBytes;			// memory held by them
+		unsigned long		ulHits;			// requests served by an image alive
+		unsigned long		ulMisses;		// requests that loaded the files
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CImageCache();
+	virtual ~CImageCache();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Image drawn through a mask (dark mask pixels are the sprite), NULL if
+	// a file can't be loaded or the sizes differ
+	std::shared_ptr<const SpriteImage>	GetMasked(const char *szImageFile, const char *szMaskFile, const LoadFn& load);
+
+	// Image whose pixels of the color key are transparent, NULL if the file
+	// can't be loaded
+	std::shared_ptr<const SpriteImage>	GetColorKeyed(const char *szImageFile, uint32_t uColorKey, const LoadFn& load);
+
+	Stats					GetStats() const;
+
+	// Cache shared by the whole program
+	static CImageCache&		Shared();
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures
+	//-------------------------------------------------------------------------
+	struct Entry
+	{
+		std::weak_ptr<const SpriteImage>	pImage;
+		size_t								uBytes;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	// The cache is not designed to be copied
+	CImageCache(const CImageCache& rhs);
+	CImageCache& operator=(const CImageCache& rhs);
+
+	// Looks the key up, loads the image on a miss
+	std::shared_ptr<const SpriteImage>	Get(const std::string& strKey, const char *szImageFile, const char *szMaskFile,
+											uint32_t uColorKey, const LoadFn& load);
+
+	// The image alive under strKey, the mutex must be held
+	std::shared_ptr<const SpriteImage>	Find(const std::string& strKey) const;
+
+	// Forgets the images freed since the last call, the mutex must be held
+	void					Prune() const;
+
+	static size_t			MemorySize(const SpriteImage& image);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	mutable std::map<std::string, Entry>	m_Entries;
+	mutable std::mutex						m_Mutex;
+	unsigned long							m_ulHits;
+	unsigned long							m_ulMisses;
+};
+
+#endif // _IMAGECACHE_H_
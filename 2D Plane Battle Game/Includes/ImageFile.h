@@ -3,6 +3,7 @@
 // by Mihai Popescu
 // March 2009
 #include "main.h"
+#include "AssetLoader.h"
 
 
 typedef BYTE (*RGBQUAD_TO_BYTE)(const RGBQUAD &q);
@@ -20,6 +21,14 @@ enum EColorChannel
 	ECC_EXCLUSIVEBLUE
 };
 
+// one channel of an image region as bytes, row i at pBits + i * iPitch
+struct MonoView
+{
+	EColorChannel chn;
+	BYTE *pBits;
+	int iPitch;
+};
+
 
 class CImageFile
 {
@@ -28,23 +37,61 @@ protected:
 	RGBQUAD *m_pRGB;
 	HBITMAP m_hBMP;
 
+	// m_hBMP is a device bitmap kept selected in m_hMemDC between paints,
+	// the pixels are uploaded again only for the rows marked dirty
+	HDC m_hMemDC;
+	HGDIOBJ m_hOldBMP;
+	LONG m_lDirtyBegin;		// first dirty row of m_pRGB
+	LONG m_lDirtyEnd;		// one past the last dirty row
+
 	LONG &height;
 	LONG &width;
 	char m_szFileName[MAX_PATH];
 
+	// frees the device bitmap, it is created again by the next Paint
+	void ReleaseDeviceBitmap();
+
+	// loads m_szFileName through LoadImage / GetDIBits, for the bitmaps
+	// CBmpDecoder does not support
+	bool LoadBitmapWithGdi(HDC hdc);
+
+	// fills m_biInfo for w x h bottom-up 32 bit pixels just stored in m_pRGB
+	void SetPixelsInfo(int w, int h);
+
+	// corner and size of rc (inclusive), the whole image without one
+	void GetRegion(const RECT* rc, int& x, int& y, int& w, int& h) const;
+
 public:
 	CImageFile(void);
 	virtual ~CImageFile(void);
 
-	bool LoadBitmapFromFile(const char* szFileName, HDC hdc);
+	// takes the pixels pAssets has decoded for the file, if any
+	bool LoadBitmapFromFile(const char* szFileName, HDC hdc, const CAssetLoader *pAssets = NULL);
 	virtual void Paint(HDC hdc, int x, int y);
 
 	LONG Height() const { return height; }
 	LONG Width() const { return width; }
 
-	void Clear() { ZeroMemory(m_pRGB, sizeof(RGBQUAD) * width * height); }
+	void Clear() { ZeroMemory(m_pRGB, sizeof(RGBQUAD) * width * height); MarkDirty(); }
+
+	// Marks the rows of rc (inclusive, same convention as CopyMonoImage) to be
+	// uploaded by the next Paint. NULL marks the whole image.
+	void MarkDirty(const RECT* rc = NULL);
+	bool IsDirty() const { return m_lDirtyBegin < m_lDirtyEnd; }
 	void Reload(HDC hdc);
 
+	// One channel as bytes, hue / saturation / luminosity as CColorSpace
+	// stores them. Pasting one of those keeps the other two of every pixel.
+	// Only rc (inclusive, inside the image) is read or written, the
+	// exclusive channels clear the other channels of rc.
 	BYTE* CopyMonoImage(EColorChannel chn, const RECT* rc = NULL);
 	void PasteMonoImage(const BYTE *img, EColorChannel chn, const RECT* rc = NULL);
+
+	// Same without allocating, to / from the caller's buffer whose row i is
+	// at img + i * pitch
+	void CopyMonoImage(EColorChannel chn, BYTE *img, int pitch, const RECT* rc = NULL);
+	void PasteMonoImage(const BYTE *img, int pitch, EColorChannel chn, const RECT* rc = NULL);
+
+	// Several channels in one pass over the pixels
+	void CopyMonoImages(const MonoView *views, int count, const RECT* rc = NULL);
 };
\ No newline at end of file
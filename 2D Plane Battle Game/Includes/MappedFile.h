@@ -0,0 +1,62 @@
+//-----------------------------------------------------------------------------
+// File: MappedFile.h
+//
+// Desc: Read only view of a whole file mapped into memory, so a loader can
+//		decode straight from the page cache without reading the file into a
+//		buffer first. Uses a file mapping on Windows and mmap elsewhere.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _MAPPEDFILE_H_
+#define _MAPPEDFILE_H_
+
+//-----------------------------------------------------------------------------
+// CMappedFile Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Name : CMappedFile (Class)
+// Desc : The view stays valid until Close() or the destructor.
+//-----------------------------------------------------------------------------
+class CMappedFile
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CMappedFile();
+	virtual ~CMappedFile();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Maps the file, false if it can't be opened (an empty file can't be
+	// mapped either)
+	bool					Open(const char *szFileName);
+	void					Close();
+
+	bool					IsOpen() const { return m_pData != 0; }
+	const uint8_t*			Data() const { return m_pData; }
+	size_t					Size() const { return m_uSize; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	// The mapping is owned, it is not designed to be copied
+	CMappedFile(const CMappedFile& rhs);
+	CMappedFile& operator=(const CMappedFile& rhs);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	const uint8_t			*m_pData;
+	size_t					m_uSize;
+	void					*m_hFile;			// Windows only
+	void					*m_hMapping;		// Windows only
+};
+
+#endif // _MAPPEDFILE_H_
@@ -1,18 +1,35 @@
 #pragma once
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 #include "Filters.h"
 #include "ImageFile.h"
+#include "ThreadPool.h"
+
+// Fixed point weights: 1.0 is 1 << RESIZE_FIXED_BITS. 14 bits leave room in
+// a signed 16 bit lane for the negative lobes and the overshoot of the
+// sharper filters.
+#define RESIZE_FIXED_BITS	14
+#define RESIZE_FIXED_ONE	(1 << RESIZE_FIXED_BITS)
 
 class CWeightsTable
 {
 	typedef struct 
 	{
-		double *Weights;			// Normalized weights of neighboring pixels
 		int Left, Right;			// Bounds of source pixels window
 	} sContribution;
 
 private:
-	// Row (or column) of contribution weights
+	// Row (or column) of contribution windows
 	sContribution *m_WeightTable;
+	// Normalized weights of neighboring pixels, m_WindowSize per destination
+	// pixel in one block
+	double *m_Weights;
+	// The same weights in fixed point, m_WindowSize per destination pixel
+	short *m_FixedWeights;
 	// Filter window size (of affecting source pixels)
 	DWORD m_WindowSize;
 	// Length of line (no. of rows / cols)
@@ -24,45 +41,176 @@ public:
 	~CWeightsTable();
 
 	// Retrieve a filter weight, given source and destination positions
-	double getWeight(int dst_pos, int src_pos) {
-			return m_WeightTable[dst_pos].Weights[src_pos];
+	double getWeight(int dst_pos, int src_pos) const {
+			return m_Weights[dst_pos * m_WindowSize + src_pos];
+	}
+
+	// Retrieve the fixed point weights of a destination position, they add
+	// up to exactly RESIZE_FIXED_ONE
+	const short *getFixedWeights(int dst_pos) const {
+			return &m_FixedWeights[dst_pos * m_WindowSize];
 	}
 
 	// Retrieve left boundary of source line buffer
-	int getLeftBoundary(int dst_pos) {
+	int getLeftBoundary(int dst_pos) const {
 			return m_WeightTable[dst_pos].Left;
 	}
 
 	// Retrieve right boundary of source line buffer
-	int getRightBoundary(int dst_pos) {
+	int getRightBoundary(int dst_pos) const {
 			return m_WeightTable[dst_pos].Right;
 	}
+
+	// Most source pixels a destination pixel is computed from
+	int getWindowSize() const { return (int)m_WindowSize; }
+
+	// Bytes allocated by the table
+	size_t getMemorySize() const;
+
+private:
+	// Fills the weights, TKernel is called as kernel(x) for every tap. The
+	// filters of Filters.h are passed with their exact class so the call is
+	// resolved (and inlined) at compile time instead of going through the
+	// virtual CGenericFilter::Filter.
+	template <class TKernel>
+	void BuildWeights(TKernel kernel, double dScale, double dFScale, double dWidth, DWORD uSrcSize);
+
+	// Converts the normalized weights to fixed point
+	void BuildFixedWeights();
+};
+
+
+// Weights tables shared between the resamples mapping the same sizes with
+// the same filter. The least recently used tables are dropped once the
+// tables kept take more than the memory budget. Safe to use from several
+// threads.
+class CWeightsCache
+{
+	typedef struct
+	{
+		std::string Filter;			// Class of the filter
+		double Width;
+		double Params[4];
+		int ParamCount;
+		DWORD DstSize, SrcSize;
+	} sKey;
+
+	typedef struct
+	{
+		sKey Key;
+		std::shared_ptr<const CWeightsTable> Table;
+	} sEntry;
+
+private:
+	// Most recently used first
+	std::list<sEntry> m_Entries;
+	mutable std::mutex m_Mutex;
+	size_t m_uBudget;
+	size_t m_uMemory;
+	unsigned long m_ulHits;
+	unsigned long m_ulMisses;
+
+	static sKey MakeKey(CGenericFilter *pFilter, DWORD uDstSize, DWORD uSrcSize);
+	static bool SameKey(const sKey &a, const sKey &b);
+
+	// Finds a table and moves it to the front, the mutex must be held
+	std::shared_ptr<const CWeightsTable> Find(const sKey &key);
+	// Drops tables from the back until the budget is met, the mutex must be held
+	void Trim();
+
+public:
+	enum { DEFAULT_BUDGET = 4 * 1024 * 1024 };
+
+	CWeightsCache(size_t uBudget = DEFAULT_BUDGET);
+	~CWeightsCache() {}
+
+	// Table for a mapping, built on a miss. A table dropped from the cache
+	// stays valid as long as the returned pointer holds it.
+	std::shared_ptr<const CWeightsTable> Get(CGenericFilter *pFilter, DWORD uDstSize, DWORD uSrcSize);
+
+	void SetBudget(size_t uBudget);
+	void Clear();
+
+	size_t GetBudget() const { std::lock_guard<std::mutex> lock(m_Mutex); return m_uBudget; }
+	size_t GetMemoryUsed() const { std::lock_guard<std::mutex> lock(m_Mutex); return m_uMemory; }
+	unsigned long GetHits() const { std::lock_guard<std::mutex> lock(m_Mutex); return m_ulHits; }
+	unsigned long GetMisses() const { std::lock_guard<std::mutex> lock(m_Mutex); return m_ulMisses; }
+
+	// Cache shared by the whole program
+	static CWeightsCache &Shared();
 };
 
 
 class CResizableImage : public CImageFile
 {
 	CGenericFilter *m_pFilter;
-	RGBQUAD *m_pResImg;
-	CWeightsTable *m_pWeights;
+	const CWeightsTable *m_pWeights;
+	CWeightsCache *m_pCache;
+	CThreadPool *m_pPool;
 
 public:
-	CResizableImage() { m_pFilter = NULL; }
+	// Pixel kernels, the scalar one is the reference the others must match
+	enum EKernel
+	{
+		KERNEL_SCALAR,
+		KERNEL_SSE2,
+		KERNEL_AVX2
+	};
+
+	CResizableImage() { m_pFilter = NULL; m_pWeights = NULL; m_pCache = &CWeightsCache::Shared(); m_pPool = &CThreadPool::Shared(); }
 	virtual ~CResizableImage() {}
 
 	void SetFilter(CGenericFilter *pFilter) { m_pFilter = pFilter; }
 
+	// Pool the two filter passes are split across, by destination rows.
+	// Every output pixel is computed the same way whatever thread runs it,
+	// so the result does not depend on the pool size. NULL runs both passes
+	// on the calling thread.
+	void SetThreadPool(CThreadPool *pPool) { m_pPool = pPool; }
+
+	// Cache the weights tables come from, NULL builds them for every pass
+	void SetWeightsCache(CWeightsCache *pCache) { m_pCache = pCache; }
+
+	// Kernel used by both passes, the widest one the processor supports is
+	// picked on first use. A kernel the processor lacks falls back to the
+	// best one available.
+	static void SetKernel(EKernel kernel);
+	static EKernel GetKernel();
+	static EKernel GetBestKernel();
+
 	// Scale an image to the desired dimensions
 	void Resample(unsigned dst_width, unsigned dst_height);
 
-private:
-	void ScaleRow(unsigned int dst_width, unsigned int /*dst_height*/, unsigned int row);
-	void ScaleCol(unsigned int dst_width, unsigned int dst_height, unsigned int col);
+	// Receives the destination rows of ResampleRows, top to bottom. pRow
+	// holds dst_width pixels and is only valid during the call.
+	typedef std::function<void(unsigned int row, const RGBQUAD *pRow)> RowSink;
+
+	// Streaming resample, the image itself is left unchanged. Source rows
+	// are scaled horizontally into a ring buffer as the vertical window
+	// reaches them and every destination row goes to the sink as soon as it
+	// is done, so the memory needed is a few rows of dst_width instead of
+	// the intermediate and destination images. The rows always go through
+	// the horizontal pass first: where Resample picks the vertical-first
+	// order (dst_width * height > dst_height * width) the output differs
+	// from Resample's by the rounding of its intermediate image. Runs on
+	// the calling thread.
+	void ResampleRows(unsigned dst_width, unsigned dst_height, const RowSink &sink);
+
+protected:
+	// Destination of the pass being run, the passes read m_pRGB
+	RGBQUAD *m_pResImg;
 
 	// Performs horizontal image filtering
 	void HorizontalFilter(unsigned int dst_width, unsigned int dst_height);
 
 	// Performs vertical image filtering
 	void VerticalFilter(unsigned int dst_width, unsigned int dst_height);
+
+private:
+	// Weights table of a pass, from the cache when there is one
+	std::shared_ptr<const CWeightsTable> GetWeights(DWORD uDstSize, DWORD uSrcSize);
+
+	void ScaleRow(unsigned int dst_width, unsigned int /*dst_height*/, unsigned int row);
+	void ScaleCols(unsigned int dst_width, unsigned int row);
 };
 
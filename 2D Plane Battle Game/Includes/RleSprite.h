@@ -0,0 +1,109 @@
+//-----------------------------------------------------------------------------
+// File: RleSprite.h
+//
+// Desc: Run length encoded sprites. Most of the bounding box of a sprite is
+//		transparent, yet CBlitter::Mask reads the image, the mask and the
+//		destination of every pixel of it. The image is compiled once into
+//		the runs of every row that draw something, so a blit skips the
+//		transparent pixels without reading them and copies the opaque ones
+//		with memcpy. Pixels under a white mask with a black image, and the
+//		pixels of the color key, are skipped; the runs of the others are
+//			copy spans	when the mask is black all along (or the image is
+//						color keyed), dst = src
+//			mask spans	otherwise (gray mask, or an image ORed over the
+//						destination under a white mask, like the glow of
+//						the explosions), dst = (dst & mask) | src with the
+//						CBlitter::Mask row kernel; they run on through
+//						short gaps of skipped pixels
+//		The results are those of CBlitter::Mask and CBlitter::ColorKey,
+//		except for the unused top byte: the mask doesn't clear it under the
+//		skipped pixels, and the copy spans take it from the image whatever
+//		the top byte of the mask.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _RLESPRITE_H_
+#define _RLESPRITE_H_
+
+//-----------------------------------------------------------------------------
+// CRleSprite Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "FrameBuffer.h"
+
+//-----------------------------------------------------------------------------
+// Name : CRleSprite (Class)
+// Desc : The spans point into the surfaces the sprite was built from, they
+//		must stay alive and unchanged while it is drawn.
+//-----------------------------------------------------------------------------
+class CRleSprite
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CRleSprite();
+	virtual ~CRleSprite();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Compiles the rectangle (sx, sy, w, h) of image, drawn through the mask
+	// at the same coordinates (the SRCAND mask convention)
+	void					BuildFromMask(const CFrameBuffer& image, const CFrameBuffer& mask, int sx, int sy, int w, int h);
+
+	// Compiles the rectangle (sx, sy, w, h) of image, transparent where its
+	// color (the low 24 bits) is uColorKey
+	void					BuildFromColorKey(const CFrameBuffer& image, int sx, int sy, int w, int h, uint32_t uColorKey);
+	void					Release();
+
+	// Draws the part (sx, sy, w, h) of the sprite with its upper-left corner
+	// at (x, y), clipped like the CBlitter operations
+	void					Draw(CFrameBuffer& dst, int x, int y, int sx, int sy, int w, int h) const;
+
+	bool					IsEmpty() const { return m_iWidth == 0 || m_iHeight == 0; }
+	int						Width() const { return m_iWidth; }
+	int						Height() const { return m_iHeight; }
+	int						SpanCount() const { return (int)m_Spans.size(); }
+
+	// Pixels a full draw writes
+	size_t					OpaqueCount() const { return m_uOpaque; }
+	size_t					MemorySize() const;
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures
+	//-------------------------------------------------------------------------
+	struct Span
+	{
+		int					x, n;			// columns [x, x + n) of the sprite
+		const uint32_t		*pPixels;		// image pixel of column x
+		const uint32_t		*pMask;			// mask pixel of column x, NULL for a copy span
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	// The spans point into the source surfaces, they are not designed to be copied
+	CRleSprite(const CRleSprite& rhs);
+	CRleSprite& operator=(const CRleSprite& rhs);
+
+	// Adds the span of the columns [x0, x) of a row
+	void					AddSpan(int x0, int x, const uint32_t *pPixels, const uint32_t *pMask);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	int						m_iWidth, m_iHeight;
+
+	// The spans of row y are m_Spans[m_RowStart[y] .. m_RowStart[y + 1]),
+	// left to right
+	std::vector<Span>		m_Spans;
+	std::vector<int>		m_RowStart;
+	size_t					m_uOpaque;
+};
+
+#endif // _RLESPRITE_H_
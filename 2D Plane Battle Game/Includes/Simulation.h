@@ -0,0 +1,174 @@
+//-----------------------------------------------------------------------------
+// File: Simulation.h
+//
+// Desc: The rules of a match (plane movement, enemy waves, shooting,
+//		collisions, lives) without any drawing, sound or window. The game
+//		feeds it one input snapshot per tick and draws what it holds; a
+//		batch tool can run it on its own, as fast as the processor allows.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _SIMULATION_H_
+#define _SIMULATION_H_
+
+//-----------------------------------------------------------------------------
+// CSimulation Specific Includes
+//-----------------------------------------------------------------------------
+#include "EntityStore.h"
+#include "SpatialGrid.h"
+#include "CollisionMask.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const int SIM_PLAYER_COUNT = 2;
+
+// Direction bits of the input (the same values as CPlayer::DIRECTION)
+enum ESimDirection
+{
+	SIM_DIR_FORWARD		= 1,
+	SIM_DIR_BACKWARD	= 2,
+	SIM_DIR_LEFT		= 4,
+	SIM_DIR_RIGHT		= 8
+};
+
+// Collision shapes the simulation needs
+enum ESimShape
+{
+	SIM_SHAPE_PLAYER,
+	SIM_SHAPE_ENEMY,
+	SIM_SHAPE_BULLET,
+	SIM_SHAPE_COUNT
+};
+
+// What happened during a tick, for sounds, animations and statistics
+enum ESimEventType
+{
+	SIM_EVENT_PLAYER_EXPLODED,		// a plane crashed or lost its last life
+	SIM_EVENT_PLAYER_HIT,			// an enemy bullet hit a plane
+	SIM_EVENT_ENEMY_HIT,			// a player bullet hit an enemy
+	SIM_EVENT_MATCH_WON,			// the enemies lost their last life
+	SIM_EVENT_MATCH_LOST			// the planes lost their last life
+};
+
+struct SimEvent
+{
+	ESimEventType	type;
+	int				iPlayer;		// plane involved (-1 if none)
+	float			x, y;			// where it happened
+};
+
+// Player input for one tick
+struct SimInput
+{
+	unsigned int	uDirection[SIM_PLAYER_COUNT];	// ESimDirection bits
+	bool			bShoot[SIM_PLAYER_COUNT];
+};
+
+// A friendly plane
+struct SimPlayer
+{
+	float			x, y;
+	float			vx, vy;			// pixels per second
+	float			prevX, prevY;	// position at the start of the tick
+	float			fFireCooldown;	// seconds until the plane can shoot again
+};
+
+//-----------------------------------------------------------------------------
+// Name : CSimulation (Class)
+// Desc : One match. Set the shapes, Reset(), then Tick() with the input.
+//-----------------------------------------------------------------------------
+class CSimulation
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CSimulation(int iBulletCapacity = 16384, int iEnemyCapacity = 512);
+	virtual ~CSimulation();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Collision mask of an entity type (its size is also the entity size)
+	void					SetShape(ESimShape shape, const CCollisionMask& mask);
+	const CCollisionMask&	GetShape(ESimShape shape) const { return m_Shapes[shape]; }
+
+	// Length of a tick. Speeds and cooldowns are in seconds, so the tick
+	// rate changes the precision of the match, not its speed
+	void					SetTickTime(float fSeconds) { m_fTickTime = fSeconds; }
+	float					GetTickTime() const { return m_fTickTime; }
+
+	// Starts a new match
+	void					Reset();
+
+	// Advances the match by one tick
+	void					Tick(const SimInput& input);
+
+	// Events of the last tick
+	const std::vector<SimEvent>& Events() const { return m_Events; }
+
+	// Direct changes (debug keys, loading a saved game)
+	void					RespawnPlayer(int iPlayer);
+	void					PlacePlayer(int iPlayer, float x, float y);
+	void					SetLives(int iPlayerLives, int iEnemyLives);
+	void					SpawnWave();
+	EntityHandle			SpawnEnemy(float x, float y);
+	EntityHandle			SpawnBullet(float x, float y, EFaction owner);
+
+	// State
+	const SimPlayer&		Player(int iPlayer) const { return m_Players[iPlayer]; }
+	CEntityStore&			Bullets() { return m_Bullets; }
+	CEntityStore&			Enemies() { return m_Enemies; }
+	int						PlayerLives() const { return m_iPlayerLives; }
+	int						EnemyLives() const { return m_iEnemyLives; }
+	bool					IsOver() const { return m_iPlayerLives == -1 || m_iEnemyLives == -1; }
+	unsigned long			TickCount() const { return m_ulTickCount; }
+
+	//-------------------------------------------------------------------------
+	// Public Constants
+	//-------------------------------------------------------------------------
+	static const int		FieldWidth		= 1920;
+	static const int		FieldHeight		= 1080;
+	static const int		BulletSpeed		= 180;		// pixels per second
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	// The simulation is not designed to be copied
+	CSimulation(const CSimulation& rhs);
+	CSimulation& operator=(const CSimulation& rhs);
+
+	void					MovePlayers(const SimInput& input);
+	void					MoveEnemies();
+	void					EnemiesShoot();
+	void					CollidePlayers();
+	void					CollideBullets();
+	void					RemoveDead();
+
+	// Bounding box, then collision mask test of two entities (centers given)
+	bool					Collide(float x1, float y1, ESimShape shape1, float x2, float y2, ESimShape shape2) const;
+
+	void					AddEvent(ESimEventType type, int iPlayer, float x, float y);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	SimPlayer				m_Players[SIM_PLAYER_COUNT];
+	CEntityStore			m_Bullets;
+	CEntityStore			m_Enemies;
+	CSpatialGrid			m_Grid;				// broadphase over the enemies
+	CCollisionMask			m_Shapes[SIM_SHAPE_COUNT];
+
+	int						m_iPlayerLives;		// -1 once the planes lost
+	int						m_iEnemyLives;		// -1 once the enemies lost
+	float					m_fTickTime;
+	unsigned long			m_ulTickCount;
+
+	std::vector<SimEvent>	m_Events;
+};
+
+#endif // _SIMULATION_H_
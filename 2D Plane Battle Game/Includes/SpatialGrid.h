@@ -0,0 +1,129 @@
+//-----------------------------------------------------------------------------
+// File: SpatialGrid.h
+//
+// Desc: Uniform grid broadphase for the collision tests. The playfield is
+//		split in square cells and every target is registered in the cells
+//		its bounding box covers. A query only looks at the cells around the
+//		queried box and reports every target found there exactly once, so
+//		the exact (narrow phase) test only runs for nearby pairs.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _SPATIALGRID_H_
+#define _SPATIALGRID_H_
+
+//-----------------------------------------------------------------------------
+// CSpatialGrid Specific Includes
+//-----------------------------------------------------------------------------
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Name : CSpatialGrid (Class)
+// Desc : Uniform grid rebuilt every frame. Usage: Clear(), Insert() every
+//		target, Build(), then Query() as many times as needed.
+//-----------------------------------------------------------------------------
+class CSpatialGrid
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CSpatialGrid(int iWorldWidth, int iWorldHeight, int iCellSize);
+	virtual ~CSpatialGrid();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					Clear();
+
+	// Registers a target (ids should be small, they index a lookup table)
+	void					Insert(int id, float left, float top, float right, float bottom);
+	void					InsertCentered(int id, float cx, float cy, float w, float h);
+
+	// Sorts the registered targets by cell, must be called before querying
+	void					Build();
+
+	// Calls fn(id) once for every target sharing a cell with the box.
+	// fn returns true to stop the query early.
+	template <typename Fn>
+	void Query(float left, float top, float right, float bottom, Fn fn)
+	{
+		int cx0, cy0, cx1, cy1;
+		CellRange(left, top, right, bottom, cx0, cy0, cx1, cy1);
+
+		// a new stamp marks the targets already reported by this query
+		if (++m_uStamp == 0)
+		{
+			m_Stamp.assign(m_Stamp.size(), 0);
+			m_uStamp = 1;
+		}
+
+		for (int cy = cy0; cy <= cy1; cy++)
+		{
+			for (int cx = cx0; cx <= cx1; cx++)
+			{
+				int cell = cy * m_iCellsX + cx;
+
+				for (int i = m_CellStart[cell]; i < m_CellStart[cell + 1]; i++)
+				{
+					int id = m_CellItems[i];
+
+					if (m_Stamp[id] == m_uStamp)
+					{
+						continue;
+					}
+
+					m_Stamp[id] = m_uStamp;
+
+					if (fn(id))
+					{
+						return;
+					}
+				}
+			}
+		}
+	}
+
+	template <typename Fn>
+	void QueryCentered(float cx, float cy, float w, float h, Fn fn)
+	{
+		Query(cx - w / 2, cy - h / 2, cx + w / 2, cy + h / 2, fn);
+	}
+
+	int						CellsX() const { return m_iCellsX; }
+	int						CellsY() const { return m_iCellsY; }
+	int						TargetCount() const { return (int)m_Targets.size(); }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures
+	//-------------------------------------------------------------------------
+	struct Target
+	{
+		int id;
+		int cx0, cy0, cx1, cy1;		// covered cells (inclusive)
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Cells covered by a box, clamped to the grid
+	void					CellRange(float left, float top, float right, float bottom,
+									  int& cx0, int& cy0, int& cx1, int& cy1) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	int						m_iCellSize;
+	int						m_iCellsX;
+	int						m_iCellsY;
+
+	std::vector<Target>		m_Targets;
+	std::vector<int>		m_CellStart;		// first item of every cell (+1 sentinel)
+	std::vector<int>		m_CellItems;		// target ids sorted by cell
+	std::vector<unsigned>	m_Stamp;			// last query that reported an id
+	unsigned				m_uStamp;
+};
+
+#endif // _SPATIALGRID_H_
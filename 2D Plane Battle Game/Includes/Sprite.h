@@ -7,31 +7,43 @@
 #include "main.h"
 #include "Vec2.h"
 #include "BackBuffer.h"
+#include "CollisionMask.h"
+#include "GdiStats.h"
+#include "FrameBuffer.h"
+#include "Blitters.h"
+#include "AssetLoader.h"
+#include "ImageCache.h"
+#include "SpriteAtlas.h"
 
 class Sprite
 {
 public:
 	Sprite(int imageID, int maskID);
-	Sprite(const char *szImageFile, const char *szMaskFile);
-	Sprite(const char *szImageFile, COLORREF crTransparentColor);
+	// The file constructors take the pixels pAssets has decoded for the
+	// files, if any, and load the files themselves otherwise.
+	Sprite(const char *szImageFile, const char *szMaskFile, const CAssetLoader *pAssets = NULL);
+	Sprite(const char *szImageFile, COLORREF crTransparentColor, const CAssetLoader *pAssets = NULL);
 
 	virtual ~Sprite();
 
-	int width(){ return mImageBM.bmWidth; }
-	int height(){ return mImageBM.bmHeight; }
+	int width(){ return mpImage->image.Width(); }
+	int height(){ return mpImage->image.Height(); }
+	const CCollisionMask& collisionMask() const { return mpImage->collision; }
 	void update(float dt);
 
 	void setBackBuffer(const BackBuffer *pBackBuffer);
 	virtual void draw();
 
+	// Draws from the atlas when it holds the image of the sprite (NULL goes
+	// back to the image itself). The sprite does not take ownership.
+	void setAtlas(const CSpriteAtlas *pAtlas);
+
 
 public:
 	// Keep these public because they need to be
 	// modified externally frequently.
 	Vec2 mPosition;
 	Vec2 mVelocity;
-	void drawTransparent();
-	void drawMask();
 
 public:
 	// Make copy constructor and assignment operator private
@@ -42,19 +54,24 @@ public:
 	Sprite& operator=(const Sprite& rhs);
 	const char *szImageFile;
 	const BackBuffer *mpBackBuffer;
-	HDC mhSpriteDC;
 public:
-	HBITMAP mhImage;
-	HBITMAP mhMask;
+	// The pixels the blitters draw from (and the mask or color key), and
+	// the silhouette used for the pixel exact collision test. Shared by
+	// every sprite made from the same files (see ImageCache.h), so it is
+	// never modified.
+	std::shared_ptr<const SpriteImage> mpImage;
 
-	BITMAP mImageBM;
-	BITMAP mMaskBM;
+	const CSpriteAtlas *mpAtlas;
+	int miAtlasIndex;
 
-	
-	
-
-	COLORREF mcTransparentColor;
+protected:
+	// Gives a sprite whose files could not be loaded an empty image
+	void setImage();
 
+	// Draws (sx, sy, w, h) of the image with its upper-left corner at
+	// (x, y), from the atlas when it has the image. When the back buffer
+	// has a compositor the blit is recorded in it and drawn by present().
+	void blit(int x, int y, int sx, int sy, int w, int h);
 };
 
 // AnimatedSprite
@@ -64,7 +81,7 @@ class AnimatedSprite : public Sprite
 {
 public:
 	//NOTE: The animation is on a single row.
-	AnimatedSprite(const char *szImageFile, const char *szMaskFile, const RECT& rcFirstFrame, int iFrameCount);
+	AnimatedSprite(const char *szImageFile, const char *szMaskFile, const RECT& rcFirstFrame, int iFrameCount, const CAssetLoader *pAssets = NULL);
 	virtual ~AnimatedSprite() { }
 
 public:
@@ -0,0 +1,135 @@
+//-----------------------------------------------------------------------------
+// File: SpriteAtlas.h
+//
+// Desc: Packs the sprite images into a few large surfaces, so every sprite
+//		of a frame is drawn from the same image / mask pair instead of from
+//		one pair per sprite kind. The rectangles are placed with a skyline
+//		packer (bottom-left rule) at startup.
+//
+//		Every image is compiled into a CRleSprite over the pages when they
+//		are built: masked images draw from the image and mask pages, color
+//		keyed ones keep their key and draw from the image page only (a mask
+//		would double the memory they read).
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _SPRITEATLAS_H_
+#define _SPRITEATLAS_H_
+
+//-----------------------------------------------------------------------------
+// CSpriteAtlas Specific Includes
+//-----------------------------------------------------------------------------
+#include <memory>
+#include <vector>
+#include "FrameBuffer.h"
+#include "ImageCache.h"
+#include "RleSprite.h"
+
+class CTiledCompositor;
+
+//-----------------------------------------------------------------------------
+// Name : CSpriteAtlas (Class)
+// Desc : Images are added, then Build() packs them and copies their pixels
+//		into the pages. The atlas keeps a reference to every image until
+//		Release(), so Build() can run again.
+//-----------------------------------------------------------------------------
+class CSpriteAtlas
+{
+public:
+	//-------------------------------------------------------------------------
+	// Public Structures
+	//-------------------------------------------------------------------------
+	struct AtlasRect
+	{
+		int					iPage;
+		int					x, y;			// upper-left corner in the page
+		int					w, h;
+		bool				bMasked;
+		uint32_t			uColorKey;		// when the image has no mask
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CSpriteAtlas();
+	virtual ~CSpriteAtlas();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Queues an image and returns its index, an image added twice is stored
+	// once
+	int						Add(const std::shared_ptr<const SpriteImage>& pImage);
+
+	// Packs the queued images in pages of at most iPageSize x iPageSize (an
+	// image larger than that gets a page of its own) and copies them in
+	void					Build(int iPageSize = DEFAULT_PAGE_SIZE);
+	void					Release();
+
+	// Index of an image, -1 if it is not in the atlas
+	int						Find(const std::shared_ptr<const SpriteImage>& pImage) const;
+
+	int						Count() const { return (int)m_Rects.size(); }
+	int						PageCount() const { return (int)m_Pages.size(); }
+	const AtlasRect&		Rect(int iIndex) const { return m_Rects[iIndex]; }
+	const CFrameBuffer&		PageImage(int iPage) const { return m_Pages[iPage]->image; }
+	const CFrameBuffer&		PageMask(int iPage) const { return m_Pages[iPage]->mask; }
+
+	// Draws the part (sx, sy, w, h) of an image with its upper-left corner
+	// at (x, y), clipped like the CBlitter operations. Nothing outside the
+	// image is drawn, whatever the rectangle.
+	void					Draw(CFrameBuffer& dst, int x, int y, int iIndex, int sx, int sy, int w, int h) const;
+
+	// Same, recorded in a compositor
+	void					Draw(CTiledCompositor& dst, int x, int y, int iIndex, int sx, int sy, int w, int h) const;
+
+	enum { DEFAULT_PAGE_SIZE = 1024 };
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures
+	//-------------------------------------------------------------------------
+	struct Page
+	{
+		CFrameBuffer		image;
+		CFrameBuffer		mask;
+	};
+
+	// Top edge of the packed area over [x, x + w)
+	struct SkylineSegment
+	{
+		int					x, y, w;
+	};
+
+	struct Skyline
+	{
+		std::vector<SkylineSegment>	segments;
+		int							iWidth, iHeight;
+		int							iUsedWidth, iUsedHeight;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	// The pages are not designed to be copied
+	CSpriteAtlas(const CSpriteAtlas& rhs);
+	CSpriteAtlas& operator=(const CSpriteAtlas& rhs);
+
+	// Bottom-left placement on a skyline, false if the rectangle doesn't fit
+	static bool				Place(Skyline& sky, int w, int h, int& x, int& y);
+
+	// Copies an image (and its mask)
+	void					CopyImage(const SpriteImage& image, const AtlasRect& rc);
+	void					ReleaseSprites();
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	std::vector<std::shared_ptr<const SpriteImage>>	m_Images;	// kept alive until Release()
+	std::vector<AtlasRect>			m_Rects;
+	std::vector<Page*>				m_Pages;		// CFrameBuffer can't be copied
+	std::vector<CRleSprite*>		m_Sprites;		// one per rect, over its page
+};
+
+#endif // _SPRITEATLAS_H_
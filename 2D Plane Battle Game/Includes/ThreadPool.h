@@ -0,0 +1,93 @@
+//-----------------------------------------------------------------------------
+// File: ThreadPool.h
+//
+// Desc: Small pool of worker threads for splitting data parallel loops
+//		(image rows, column blocks, screen tiles). The threads are created
+//		once and sleep between jobs, the thread calling ParallelFor works on
+//		the first range itself and helps with queued ranges while it waits,
+//		so a ParallelFor issued from inside a job cannot dead lock.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+//-----------------------------------------------------------------------------
+// CThreadPool Specific Includes
+//-----------------------------------------------------------------------------
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Name : CThreadPool (Class)
+// Desc : Fixed size worker pool with a blocking parallel for.
+//-----------------------------------------------------------------------------
+class CThreadPool
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	// iThreads counts the calling thread too, 0 uses one per hardware thread
+	// and 1 runs everything on the caller
+			 CThreadPool(int iThreads = 0);
+	virtual ~CThreadPool();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Calls fn(begin, end) over [0, iCount) split in contiguous ranges of at
+	// least iGrain items, one range per thread, and returns when every range
+	// is done. Which thread runs a range never changes what it computes, so
+	// the result is the same for any thread count.
+	template <typename Fn>
+	void ParallelFor(int iCount, int iGrain, Fn fn)
+	{
+		int nRanges = RangeCount(iCount, iGrain);
+
+		if (nRanges <= 1)
+		{
+			if (iCount > 0) fn(0, iCount);
+			return;
+		}
+
+		Run(iCount, nRanges, std::function<void(int, int)>(fn));
+	}
+
+	int						ThreadCount() const { return (int)m_Workers.size() + 1; }
+
+	// Pool shared by the whole program, sized to the hardware
+	static CThreadPool&		Shared();
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	// The pool owns threads, it is not designed to be copied
+	CThreadPool(const CThreadPool& rhs);
+	CThreadPool& operator=(const CThreadPool& rhs);
+
+	int						RangeCount(int iCount, int iGrain) const;
+	void					Run(int iCount, int nRanges, const std::function<void(int, int)>& fn);
+	void					WorkerLoop();
+
+	// Runs one queued job if there is any, returns false when the queue is empty
+	bool					RunPending(std::unique_lock<std::mutex>& lock);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	std::vector<std::thread>			m_Workers;
+	std::deque<std::function<void()> >	m_Jobs;
+	std::mutex							m_Mutex;
+	std::condition_variable				m_JobReady;			// signaled when a job is queued
+	std::condition_variable				m_JobDone;			// signaled when a job finishes
+	bool								m_bQuit;
+};
+
+#endif // _THREADPOOL_H_
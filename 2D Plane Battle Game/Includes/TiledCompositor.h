@@ -0,0 +1,126 @@
+//-----------------------------------------------------------------------------
+// File: TiledCompositor.h
+//
+// Desc: Deferred sprite compositing split in screen tiles. The blits of a
+//		frame are recorded instead of drawn, then Flush() bins every blit to
+//		the tiles its destination rectangle touches and draws the tiles on
+//		the thread pool. Each tile replays its blits in the order they were
+//		recorded, clipped to the tile, with the CBlitter kernels (or the
+//		spans of a CRleSprite), so the
+//		frame comes out exactly as if the blits had been drawn one after the
+//		other on a single thread.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _TILEDCOMPOSITOR_H_
+#define _TILEDCOMPOSITOR_H_
+
+//-----------------------------------------------------------------------------
+// CTiledCompositor Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include "FrameBuffer.h"
+
+class CThreadPool;
+class CDirtyRegion;
+class CRleSprite;
+
+//-----------------------------------------------------------------------------
+// Name : CTiledCompositor (Class)
+// Desc : The operations take the same arguments as the CBlitter ones minus
+//		the destination. The source (and mask) surfaces and the sprites are
+//		only referenced, they must stay alive and unchanged until Flush().
+//-----------------------------------------------------------------------------
+class CTiledCompositor
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CTiledCompositor(int iTileSize = DEFAULT_TILE_SIZE);
+	virtual ~CTiledCompositor();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Recorded blits, see CBlitter
+	void					Copy(int x, int y, const CFrameBuffer& src, int sx, int sy, int w, int h);
+	void					ColorKey(int x, int y, const CFrameBuffer& src, int sx, int sy, int w, int h, uint32_t uKey);
+	void					Mask(int x, int y, const CFrameBuffer& src, const CFrameBuffer& mask, int sx, int sy, int w, int h);
+
+	// Recorded CRleSprite::Draw
+	void					Rle(int x, int y, const CRleSprite& sprite, int sx, int sy, int w, int h);
+
+	// Draws the recorded blits into dst, the tiles in parallel on pPool
+	// (NULL draws them on the calling thread), and forgets them. The area
+	// of every blit is marked in pDirty when there is one.
+	void					Flush(CFrameBuffer& dst, CThreadPool *pPool, CDirtyRegion *pDirty = NULL);
+	void					Clear();
+
+	int						CommandCount() const { return (int)m_Commands.size(); }
+	int						TileSize() const { return m_iTileSize; }
+
+	enum { DEFAULT_TILE_SIZE = 128 };
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Enumerators
+	//-------------------------------------------------------------------------
+	enum EOp
+	{
+		OP_COPY,
+		OP_COLORKEY,
+		OP_MASK,
+		OP_RLE
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Structures
+	//-------------------------------------------------------------------------
+	struct Command
+	{
+		const CFrameBuffer	*pSource;		// NULL for OP_RLE
+		const CFrameBuffer	*pMask;			// OP_MASK only
+		const CRleSprite	*pSprite;		// OP_RLE only
+		int					iSourceWidth;
+		int					iSourceHeight;
+		uint32_t			uColorKey;		// OP_COLORKEY only
+		EOp					eOp;
+		int					x, y;
+		int					sx, sy, w, h;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	// The bins are not designed to be copied
+	CTiledCompositor(const CTiledCompositor& rhs);
+	CTiledCompositor& operator=(const CTiledCompositor& rhs);
+
+	void					Record(Command& cmd, EOp eOp, int x, int y, int sx, int sy, int w, int h);
+
+	// Fills the bins for a dst of nColumns x nRows tiles
+	void					Bin(const CFrameBuffer& dst, int nColumns, int nRows, CDirtyRegion *pDirty);
+
+	// Replays the blits of one tile
+	void					DrawTile(CFrameBuffer& dst, int iTile, int nColumns) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	int						m_iTileSize;
+	std::vector<Command>	m_Commands;
+
+	// The commands of tile t are m_BinCommands[m_BinStart[t] .. m_BinStart[t + 1]),
+	// in the order they were recorded. Kept between frames for their memory.
+	std::vector<int>		m_BinStart;
+	std::vector<int>		m_BinCommands;
+	std::vector<int>		m_Spans;		// tile rectangle of every command, 4 ints each
+	std::atomic<int>		m_iNextTile;	// next tile to claim during Flush()
+};
+
+#endif // _TILEDCOMPOSITOR_H_
@@ -0,0 +1,162 @@
+//-----------------------------------------------------------------------------
+// File: AssetLoader.cpp
+//
+// Desc: Background decoding of the startup bitmaps.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CAssetLoader Specific Includes
+//-----------------------------------------------------------------------------
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "BmpDecoder.h"
+#include "ThreadPool.h"
+#include <chrono>
+
+// Milliseconds since t0
+static double ElapsedMs(std::chrono::steady_clock::time_point t0)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+//-----------------------------------------------------------------------------
+// Name : CAssetLoader () (Constructor)
+// Desc : CAssetLoader Class Constructor
+//-----------------------------------------------------------------------------
+CAssetLoader::CAssetLoader()
+{
+	m_pPack			= NULL;
+	m_iNext			= 0;
+	m_iLoaded		= 0;
+	m_bFinished		= false;
+	m_dTotalTime	= 0.0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CAssetLoader () (Destructor)
+// Desc : CAssetLoader Class Destructor
+//-----------------------------------------------------------------------------
+CAssetLoader::~CAssetLoader()
+{
+	// the background thread still writes to the assets
+	Wait();
+
+	for (std::size_t i = 0; i < m_Assets.size(); i++)
+	{
+		delete m_Assets[i].pPixels;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Add ()
+// Desc : Queues a file (once).
+//-----------------------------------------------------------------------------
+int CAssetLoader::Add(const char *szFileName)
+{
+	int iIndex = Find(szFileName);
+
+	if (iIndex >= 0)
+		return iIndex;
+
+	Asset asset;
+	asset.strFileName	= szFileName;
+	asset.pPixels		= new CFrameBuffer;
+	asset.dLoadTime		= 0.0;
+
+	m_Assets.push_back(asset);
+
+	return (int)m_Assets.size() - 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Find ()
+// Desc : Looks a file up by the name it was queued with.
+//-----------------------------------------------------------------------------
+int CAssetLoader::Find(const char *szFileName) const
+{
+	for (std::size_t i = 0; i < m_Assets.size(); i++)
+	{
+		if (m_Assets[i].strFileName == szFileName)
+			return (int)i;
+	}
+
+	return -1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Start ()
+// Desc : The loading runs on its own thread, which drives the pool, so the
+//		caller is free to keep its message loop going.
+//-----------------------------------------------------------------------------
+void CAssetLoader::Start(CThreadPool *pPool)
+{
+	Wait();
+
+	m_iNext		= 0;
+	m_iLoaded	= 0;
+	m_bFinished	= false;
+
+	m_Thread = std::thread(&CAssetLoader::LoadAll, this, pPool);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Wait ()
+// Desc : Blocks until the loading started by Start() is over.
+//-----------------------------------------------------------------------------
+void CAssetLoader::Wait()
+{
+	if (m_Thread.joinable())
+	{
+		m_Thread.join();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadAll () (Private)
+// Desc : Every thread claims the next asset until none is left, so a thread
+//		that drew the small files goes on with the big ones instead of
+//		waiting for a fixed share.
+//-----------------------------------------------------------------------------
+void CAssetLoader::LoadAll(CThreadPool *pPool)
+{
+	std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+	int nAssets = (int)m_Assets.size();
+
+	auto claim = [this, nAssets](int, int)
+	{
+		for (int i = m_iNext++; i < nAssets; i = m_iNext++)
+		{
+			LoadAsset(m_Assets[i]);
+			m_iLoaded++;
+		}
+	};
+
+	if (pPool != NULL)
+	{
+		// one range per thread, each one claims assets until they run out
+		pPool->ParallelFor(pPool->ThreadCount(), 1, claim);
+	}
+	else
+	{
+		claim(0, 1);
+	}
+
+	m_dTotalTime = ElapsedMs(tStart);
+	m_bFinished = true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadAsset () (Private)
+// Desc : Takes one file from the pack or decodes it, and times it.
+//-----------------------------------------------------------------------------
+void CAssetLoader::LoadAsset(Asset& asset)
+{
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+	if (m_pPack == NULL || !m_pPack->GetImage(asset.strFileName.c_str(), *asset.pPixels))
+	{
+		CBmpDecoder::LoadFile(asset.strFileName.c_str(), *asset.pPixels);
+	}
+
+	asset.dLoadTime = ElapsedMs(t0);
+}
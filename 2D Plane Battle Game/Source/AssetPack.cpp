@@ -0,0 +1,260 @@
+//-----------------------------------------------------------------------------
+// File: AssetPack.cpp
+//
+// Desc: Single file holding the bitmaps of the game, already converted.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CAssetPack Specific Includes
+//-----------------------------------------------------------------------------
+#include "AssetPack.h"
+#include "BmpDecoder.h"
+#include <ctype.h>
+#include <string.h>
+#include <fstream>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const uint8_t	PACK_MAGIC[4]		= { 'P', 'B', 'A', 'P' };
+static const uint32_t	PACK_VERSION		= 1;
+static const size_t		HEADER_SIZE			= 16;
+static const size_t		ENTRY_SIZE			= 80;
+static const size_t		NAME_SIZE			= 64;		// including the terminating 0
+static const size_t		PIXEL_ALIGNMENT		= 64;
+
+// Little endian reads and writes, the index isn't aligned for 64 bit values
+static uint32_t ReadU32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t ReadU64(const uint8_t *p)
+{
+	return (uint64_t)ReadU32(p) | ((uint64_t)ReadU32(p + 4) << 32);
+}
+
+static void WriteU32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+static void WriteU64(uint8_t *p, uint64_t v)
+{
+	WriteU32(p, (uint32_t)v);
+	WriteU32(p + 4, (uint32_t)(v >> 32));
+}
+
+static size_t AlignUp(size_t u)
+{
+	return (u + PIXEL_ALIGNMENT - 1) & ~(PIXEL_ALIGNMENT - 1);
+}
+
+//-----------------------------------------------------------------------------
+// Name : CAssetPack () (Constructor)
+// Desc : CAssetPack Class Constructor
+//-----------------------------------------------------------------------------
+CAssetPack::CAssetPack()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CAssetPack () (Destructor)
+// Desc : CAssetPack Class Destructor
+//-----------------------------------------------------------------------------
+CAssetPack::~CAssetPack()
+{
+	Close();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Open ()
+// Desc : Every image of the index must be inside the file, the pixels are
+//		then used straight from the mapping.
+//-----------------------------------------------------------------------------
+bool CAssetPack::Open(const char *szFileName)
+{
+	Close();
+
+	if (!m_File.Open(szFileName))
+		return false;
+
+	const uint8_t *pData = m_File.Data();
+	size_t uSize = m_File.Size();
+
+	if (uSize < HEADER_SIZE || memcmp(pData, PACK_MAGIC, 4) != 0 || ReadU32(pData + 4) != PACK_VERSION)
+	{
+		Close();
+		return false;
+	}
+
+	uint32_t uCount = ReadU32(pData + 8);
+
+	if (uCount > (uSize - HEADER_SIZE) / ENTRY_SIZE)
+	{
+		Close();
+		return false;
+	}
+
+	for (uint32_t i = 0; i < uCount; i++)
+	{
+		const uint8_t *p = pData + HEADER_SIZE + i * ENTRY_SIZE;
+		uint32_t uWidth = ReadU32(p + NAME_SIZE);
+		uint32_t uHeight = ReadU32(p + NAME_SIZE + 4);
+		uint64_t uOffset = ReadU64(p + NAME_SIZE + 8);
+		uint64_t uBytes = (uint64_t)uWidth * uHeight * sizeof(uint32_t);
+
+		if (p[NAME_SIZE - 1] != 0 || uWidth == 0 || uWidth > 32768 || uHeight == 0 || uHeight > 32768 ||
+			uOffset % PIXEL_ALIGNMENT != 0 || uOffset > uSize || uBytes > uSize - uOffset)
+		{
+			Close();
+			return false;
+		}
+
+		Entry entry;
+		entry.strName	= (const char*)p;
+		entry.iWidth	= (int)uWidth;
+		entry.iHeight	= (int)uHeight;
+		entry.pPixels	= (const uint32_t*)(pData + uOffset);
+
+		m_Entries.push_back(entry);
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Close ()
+// Desc : Unmaps the pack, the images attached to it become invalid.
+//-----------------------------------------------------------------------------
+void CAssetPack::Close()
+{
+	m_Entries.clear();
+	m_File.Close();
+}
+
+//-----------------------------------------------------------------------------
+// Name : SameName () (Private, Static)
+// Desc : File names as Windows compares them.
+//-----------------------------------------------------------------------------
+bool CAssetPack::SameName(const char *a, const char *b)
+{
+	for (; *a && *b; a++, b++)
+	{
+		char ca = (*a == '\\') ? '/' : (char)tolower((unsigned char)*a);
+		char cb = (*b == '\\') ? '/' : (char)tolower((unsigned char)*b);
+
+		if (ca != cb)
+			return false;
+	}
+
+	return *a == *b;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Find ()
+// Desc : Linear search, a pack holds a few dozen images.
+//-----------------------------------------------------------------------------
+int CAssetPack::Find(const char *szName) const
+{
+	for (std::size_t i = 0; i < m_Entries.size(); i++)
+	{
+		if (SameName(m_Entries[i].strName.c_str(), szName))
+			return (int)i;
+	}
+
+	return -1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetImage ()
+// Desc : The blitters only read their sources, so the read only pixels can
+//		be attached as they are.
+//-----------------------------------------------------------------------------
+bool CAssetPack::GetImage(const char *szName, CFrameBuffer& pixels) const
+{
+	int i = Find(szName);
+
+	if (i < 0)
+		return false;
+
+	const Entry &entry = m_Entries[i];
+	pixels.Attach(const_cast<uint32_t*>(entry.pPixels), entry.iWidth, entry.iHeight, entry.iWidth);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build () (Static)
+// Desc : Decodes every file first, so the index can be written before the
+//		pixels in a single pass.
+//-----------------------------------------------------------------------------
+int CAssetPack::Build(const char *szPackFile, const std::vector<std::string>& files)
+{
+	std::vector<CFrameBuffer*> images;
+	std::vector<std::string> names;
+
+	for (std::size_t i = 0; i < files.size(); i++)
+	{
+		CFrameBuffer *pImage = new CFrameBuffer;
+
+		if (files[i].size() < NAME_SIZE && CBmpDecoder::LoadFile(files[i].c_str(), *pImage))
+		{
+			images.push_back(pImage);
+			names.push_back(files[i]);
+		}
+		else
+		{
+			delete pImage;
+		}
+	}
+
+	// header and index
+	std::vector<uint8_t> index(HEADER_SIZE + images.size() * ENTRY_SIZE, 0);
+	size_t uOffset = AlignUp(index.size());
+
+	memcpy(&index[0], PACK_MAGIC, 4);
+	WriteU32(&index[4], PACK_VERSION);
+	WriteU32(&index[8], (uint32_t)images.size());
+
+	for (std::size_t i = 0; i < images.size(); i++)
+	{
+		uint8_t *p = &index[HEADER_SIZE + i * ENTRY_SIZE];
+
+		memcpy(p, names[i].c_str(), names[i].size());
+		WriteU32(p + NAME_SIZE, (uint32_t)images[i]->Width());
+		WriteU32(p + NAME_SIZE + 4, (uint32_t)images[i]->Height());
+		WriteU64(p + NAME_SIZE + 8, (uint64_t)uOffset);
+
+		uOffset = AlignUp(uOffset + (size_t)images[i]->Width() * images[i]->Height() * sizeof(uint32_t));
+	}
+
+	// the pixels, stored as the game uses them (the game only runs on
+	// little endian processors)
+	std::ofstream fout(szPackFile, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+	static const char padding[PIXEL_ALIGNMENT] = { 0 };
+	size_t uWritten = index.size();
+
+	fout.write((const char*)&index[0], index.size());
+
+	for (std::size_t i = 0; i < images.size(); i++)
+	{
+		fout.write(padding, AlignUp(uWritten) - uWritten);
+		uWritten = AlignUp(uWritten);
+
+		for (int y = 0; y < images[i]->Height(); y++)
+		{
+			fout.write((const char*)images[i]->Row(y), images[i]->Width() * sizeof(uint32_t));
+		}
+
+		uWritten += (size_t)images[i]->Width() * images[i]->Height() * sizeof(uint32_t);
+		delete images[i];
+	}
+
+	fout.close();
+
+	return fout.fail() ? -1 : (int)images.size();
+}
@@ -2,9 +2,17 @@
 // By Frank Luna
 // August 24, 2004.
 #include "BackBuffer.h"
+#include "GdiStats.h"
+#include "ThreadPool.h"
+#include "Blitters.h"
+
+// When the changed areas cover more than this share of the frame, one
+// copy of the whole frame is cheaper than the many small ones.
+static const double FULL_REDRAW_RATIO = 0.5;
 
 
 BackBuffer::BackBuffer(HWND hWnd, int width, int height)
+	: mGdiPresenter(hWnd)
 {
 	// Save a copy of the main window handle.
 	mhWnd = hWnd;
@@ -21,10 +29,36 @@ BackBuffer::BackBuffer(HWND hWnd, int width, int height)
 	// with the window one.
 	mhDC = CreateCompatibleDC(hWndDC);
 
-	// Create the backbuffer surface bitmap that is compatible
-	// with the window device context bitmap format. That is
-	// the surface we will render onto.
-	mhSurface = CreateCompatibleBitmap(hWndDC, width, height);
+	// Create the backbuffer surface as a 32 bit top-down DIB
+	// section, so we can render onto it both with GDI and
+	// directly through its pixels.
+	BITMAPINFO bmi;
+	ZeroMemory(&bmi, sizeof(BITMAPINFO));
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = width;
+	bmi.bmiHeader.biHeight = -height;
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	void *pBits = NULL;
+	mhSurface = CreateDIBSection(hWndDC, &bmi, DIB_RGB_COLORS, &pBits, NULL, 0);
+	CGdiStats::OnCreate(2);
+
+	mFrame.Attach((uint32_t*)pBits, width, height, width);
+	mpPresenter = &mGdiPresenter;
+	mpCompositor = NULL;
+
+	mFrameMode = FRAME_WHOLE;
+	miBackground = 0;
+	mbHasBackground = false;
+	mDirty.Resize(width, height);
+	mLastDirty.Resize(width, height);
+	mFramePixels = 0;
+	mPixelsTouched = 0;
+
+	// Select the backbuffer bitmap into the DC.
+	mhOldObject = (HBITMAP)SelectObject(mhDC, mhSurface);
 
 	// Done with window DC.
 	ReleaseDC(hWnd, hWndDC);
@@ -38,37 +72,175 @@ BackBuffer::BackBuffer(HWND hWnd, int width, int height)
 
 void BackBuffer::reset()
 {
-	// Select the backbuffer bitmap into the DC.
-	mhOldObject = (HBITMAP)SelectObject(mhDC, mhSurface);
+	// Clear the backbuffer to white.
+	getFrame().Fill(0x00FFFFFF);
+}
 
-	// Select a white brush.
-	HBRUSH white = (HBRUSH)GetStockObject(WHITE_BRUSH);
-	HBRUSH oldBrush = (HBRUSH)SelectObject(mhDC, white);
+CFrameBuffer& BackBuffer::getFrame() const
+{
+	// GDI batches its drawing, make sure it reached the pixels.
+	GdiFlush();
 
-	// Clear the backbuffer rectangle.
-	Rectangle(mhDC, 0, 0, mWidth, mHeight);
+	return mFrame;
+}
 
-	// Restore the original brush.
-	SelectObject(mhDC, oldBrush);
+void BackBuffer::setPresenter(CFramePresenter *pPresenter)
+{
+	mpPresenter = pPresenter ? pPresenter : &mGdiPresenter;
 }
 
 BackBuffer::~BackBuffer()
 {
+	mFrame.Release();
+
 	SelectObject(mhDC, mhOldObject);
 	DeleteObject(mhSurface);
 	DeleteDC(mhDC);
 }
 
+bool BackBuffer::beginFrame(int iBackground)
+{
+	CFrameBuffer &frame = getFrame();
+	size_t frameArea = (size_t)mWidth * mHeight;
+
+	if(mpCompositor == NULL || !mbHasBackground || iBackground != miBackground)
+	{
+		// The caller paints the whole background, present() keeps a
+		// copy of it before the sprites are drawn.
+		reset();
+		mFrameMode = (mpCompositor != NULL) ? FRAME_REPAINTED : FRAME_WHOLE;
+		miBackground = iBackground;
+		mFramePixels += frameArea;
+		return true;
+	}
+
+	// Erase the sprites of the last frame.
+	size_t lastArea = mLastDirty.Area();
+
+	if(lastArea > frameArea * FULL_REDRAW_RATIO)
+	{
+		CBlitter::Copy(frame, 0, 0, mBackground, 0, 0, mWidth, mHeight);
+		mFramePixels += frameArea;
+	}
+	else
+	{
+		mLastDirty.GetRects(mRects);
+
+		for(size_t i = 0; i < mRects.size(); i++)
+		{
+			const FrameRect &rc = mRects[i];
+			CBlitter::Copy(frame, rc.x, rc.y, mBackground, rc.x, rc.y, rc.w, rc.h);
+		}
+
+		mFramePixels += lastArea;
+	}
+
+	mFrameMode = FRAME_DIRTY;
+	return false;
+}
+
 void BackBuffer::present()
 {
+	CFrameBuffer &frame = getFrame();
+	size_t frameArea = (size_t)mWidth * mHeight;
+
+	// The background is complete until the recorded sprites are drawn,
+	// keep it to erase them in the next frames.
+	if(mFrameMode == FRAME_REPAINTED)
+	{
+		if(mBackground.Width() != mWidth || mBackground.Height() != mHeight)
+			mBackground.Create(mWidth, mHeight);
+
+		CBlitter::Copy(mBackground, 0, 0, frame, 0, 0, mWidth, mHeight);
+		mbHasBackground = true;
+	}
+	else if(mFrameMode == FRAME_WHOLE)
+	{
+		// Whatever was drawn is not the background.
+		mbHasBackground = false;
+	}
+
+	// Draw the sprites recorded since the last frame.
+	mDirty.Clear();
+
+	if(mpCompositor)
+		mpCompositor->Flush(frame, &CThreadPool::Shared(), &mDirty);
+
+	// The window already shows the rest of a frame started dirty: only
+	// where the sprites were and where they are now changed.
+	size_t changedArea = frameArea;
+
+	if(mFrameMode == FRAME_DIRTY)
+	{
+		mLastDirty.Add(mDirty);
+		changedArea = mLastDirty.Area();
+	}
+
+	if(changedArea > frameArea * FULL_REDRAW_RATIO)
+	{
+		mpPresenter->Present(frame);
+		mFramePixels += frameArea;
+	}
+	else if(changedArea > 0)
+	{
+		mLastDirty.GetRects(mRects);
+		mpPresenter->PresentRects(frame, &mRects[0], (int)mRects.size());
+		mFramePixels += changedArea;
+	}
+
+	mLastDirty.Swap(mDirty);
+	mFrameMode = FRAME_WHOLE;
+
+	mPixelsTouched = mFramePixels;
+	mFramePixels = 0;
+}
+
+void GdiPresenter::Present(const CFrameBuffer& frame)
+{
+	// Describe the frame pixels (top-down, 32 bit).
+	BITMAPINFO bmi;
+	ZeroMemory(&bmi, sizeof(BITMAPINFO));
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = frame.Pitch();
+	bmi.bmiHeader.biHeight = -frame.Height();
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
 	// Get a handle to the device context associated with
 	// the window.
 	HDC hWndDC = GetDC(mhWnd);
 
-	// Copy the backbuffer contents over to the
-	// window client area.
-	BitBlt(hWndDC, 0, 0, mWidth, mHeight, mhDC, 0, 0, SRCCOPY);
+	// Upload the frame to the window client area.
+	SetDIBitsToDevice(hWndDC, 0, 0, frame.Width(), frame.Height(), 0, 0, 0, frame.Height(),
+		frame.Pixels(), &bmi, DIB_RGB_COLORS);
 
 	// Always free window DC when done.
+	ReleaseDC(mhWnd, hWndDC);
+}
+
+void GdiPresenter::PresentRects(const CFrameBuffer& frame, const FrameRect *pRects, int nRects)
+{
+	BITMAPINFO bmi;
+	ZeroMemory(&bmi, sizeof(BITMAPINFO));
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = frame.Pitch();
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	HDC hWndDC = GetDC(mhWnd);
+
+	// Each rectangle is uploaded from a top-down DIB made of its rows
+	// only, so the source origin is the first of them.
+	for(int i = 0; i < nRects; i++)
+	{
+		const FrameRect &rc = pRects[i];
+		bmi.bmiHeader.biHeight = -rc.h;
+
+		SetDIBitsToDevice(hWndDC, rc.x, rc.y, rc.w, rc.h, rc.x, 0, 0, rc.h,
+			frame.Row(rc.y), &bmi, DIB_RGB_COLORS);
+	}
+
 	ReleaseDC(mhWnd, hWndDC);
 }
\ No newline at end of file
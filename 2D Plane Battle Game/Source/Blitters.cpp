@@ -0,0 +1,319 @@
+//-----------------------------------------------------------------------------
+// File: Blitters.cpp
+//
+// Desc: Sprite compositing on CFrameBuffer surfaces.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CBlitter Specific Includes
+//-----------------------------------------------------------------------------
+#include "Blitters.h"
+#include "CpuFeatures.h"
+
+#if CPU_X86
+	#include <emmintrin.h>
+	#include <immintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Row kernels
+//-----------------------------------------------------------------------------
+typedef void (*CopyRowFn)(uint32_t *d, const uint32_t *s, int n);
+typedef void (*KeyRowFn)(uint32_t *d, const uint32_t *s, int n, uint32_t key);
+typedef void (*MaskRowFn)(uint32_t *d, const uint32_t *s, const uint32_t *m, int n);
+
+static const uint32_t RGB_BITS = 0x00FFFFFF;
+
+//-----------------------------------------------------------------------------
+// Scalar reference
+//-----------------------------------------------------------------------------
+static void CopyRow_Scalar(uint32_t *d, const uint32_t *s, int n)
+{
+	for (int i = 0; i < n; i++)
+		d[i] = s[i];
+}
+
+static void KeyRow_Scalar(uint32_t *d, const uint32_t *s, int n, uint32_t key)
+{
+	for (int i = 0; i < n; i++)
+	{
+		if ((s[i] & RGB_BITS) != key)
+			d[i] = s[i];
+	}
+}
+
+static void MaskRow_Scalar(uint32_t *d, const uint32_t *s, const uint32_t *m, int n)
+{
+	for (int i = 0; i < n; i++)
+		d[i] = (d[i] & m[i]) | s[i];
+}
+
+#if CPU_X86
+//-----------------------------------------------------------------------------
+// SSE2, 4 pixels per step
+//-----------------------------------------------------------------------------
+static void CopyRow_SSE2(uint32_t *d, const uint32_t *s, int n)
+{
+	int i = 0;
+
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_si128((__m128i*)(d + i), _mm_loadu_si128((const __m128i*)(s + i)));
+
+	CopyRow_Scalar(d + i, s + i, n - i);
+}
+
+static void KeyRow_SSE2(uint32_t *d, const uint32_t *s, int n, uint32_t key)
+{
+	const __m128i vKey = _mm_set1_epi32((int)key);
+	const __m128i vRGB = _mm_set1_epi32((int)RGB_BITS);
+	int i = 0;
+
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128i vs = _mm_loadu_si128((const __m128i*)(s + i));
+		__m128i vd = _mm_loadu_si128((const __m128i*)(d + i));
+
+		// all ones where the source is transparent
+		__m128i vt = _mm_cmpeq_epi32(_mm_and_si128(vs, vRGB), vKey);
+
+		vd = _mm_or_si128(_mm_and_si128(vt, vd), _mm_andnot_si128(vt, vs));
+		_mm_storeu_si128((__m128i*)(d + i), vd);
+	}
+
+	KeyRow_Scalar(d + i, s + i, n - i, key);
+}
+
+static void MaskRow_SSE2(uint32_t *d, const uint32_t *s, const uint32_t *m, int n)
+{
+	int i = 0;
+
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128i vs = _mm_loadu_si128((const __m128i*)(s + i));
+		__m128i vm = _mm_loadu_si128((const __m128i*)(m + i));
+		__m128i vd = _mm_loadu_si128((const __m128i*)(d + i));
+
+		_mm_storeu_si128((__m128i*)(d + i), _mm_or_si128(_mm_and_si128(vd, vm), vs));
+	}
+
+	MaskRow_Scalar(d + i, s + i, m + i, n - i);
+}
+
+//-----------------------------------------------------------------------------
+// AVX2, 8 pixels per step
+//-----------------------------------------------------------------------------
+CPU_TARGET_AVX2 static void CopyRow_AVX2(uint32_t *d, const uint32_t *s, int n)
+{
+	int i = 0;
+
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_si256((__m256i*)(d + i), _mm256_loadu_si256((const __m256i*)(s + i)));
+
+	CopyRow_Scalar(d + i, s + i, n - i);
+}
+
+CPU_TARGET_AVX2 static void KeyRow_AVX2(uint32_t *d, const uint32_t *s, int n, uint32_t key)
+{
+	const __m256i vKey = _mm256_set1_epi32((int)key);
+	const __m256i vRGB = _mm256_set1_epi32((int)RGB_BITS);
+	int i = 0;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256i vs = _mm256_loadu_si256((const __m256i*)(s + i));
+		__m256i vd = _mm256_loadu_si256((const __m256i*)(d + i));
+
+		// all ones where the source is transparent
+		__m256i vt = _mm256_cmpeq_epi32(_mm256_and_si256(vs, vRGB), vKey);
+
+		_mm256_storeu_si256((__m256i*)(d + i), _mm256_blendv_epi8(vs, vd, vt));
+	}
+
+	KeyRow_Scalar(d + i, s + i, n - i, key);
+}
+
+CPU_TARGET_AVX2 static void MaskRow_AVX2(uint32_t *d, const uint32_t *s, const uint32_t *m, int n)
+{
+	int i = 0;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256i vs = _mm256_loadu_si256((const __m256i*)(s + i));
+		__m256i vm = _mm256_loadu_si256((const __m256i*)(m + i));
+		__m256i vd = _mm256_loadu_si256((const __m256i*)(d + i));
+
+		_mm256_storeu_si256((__m256i*)(d + i), _mm256_or_si256(_mm256_and_si256(vd, vm), vs));
+	}
+
+	MaskRow_Scalar(d + i, s + i, m + i, n - i);
+}
+#endif // CPU_X86
+
+//-----------------------------------------------------------------------------
+// Kernels of the selected path (chosen on first use)
+//-----------------------------------------------------------------------------
+static CBlitter::EPath	s_ePath		= CBlitter::PATH_SCALAR;
+static CopyRowFn		s_pCopyRow	= CopyRow_Scalar;
+static KeyRowFn			s_pKeyRow	= KeyRow_Scalar;
+static MaskRowFn		s_pMaskRow	= MaskRow_Scalar;
+
+//-----------------------------------------------------------------------------
+// Name : SelectPath () / EnsurePath () (Static, Local)
+// Desc : Points the kernels at a path / at the best one, once, on first use.
+//		The blits can start on several threads at once (the loader threads
+//		and the main thread): the local static makes the other first
+//		callers wait until the kernels are set.
+//-----------------------------------------------------------------------------
+static void SelectPath(CBlitter::EPath path)
+{
+	s_pCopyRow	= CopyRow_Scalar;
+	s_pKeyRow	= KeyRow_Scalar;
+	s_pMaskRow	= MaskRow_Scalar;
+
+#if CPU_X86
+	if (path == CBlitter::PATH_SSE2)
+	{
+		s_pCopyRow	= CopyRow_SSE2;
+		s_pKeyRow	= KeyRow_SSE2;
+		s_pMaskRow	= MaskRow_SSE2;
+	}
+	else if (path == CBlitter::PATH_AVX2)
+	{
+		s_pCopyRow	= CopyRow_AVX2;
+		s_pKeyRow	= KeyRow_AVX2;
+		s_pMaskRow	= MaskRow_AVX2;
+	}
+#endif
+
+	s_ePath		= path;
+}
+
+static void EnsurePath()
+{
+	static const bool s_bSelected = (SelectPath(CBlitter::GetBestPath()), true);
+	(void)s_bSelected;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetBestPath () / GetPath ()
+// Desc : Widest kernel set the processor supports / the one in use.
+//-----------------------------------------------------------------------------
+CBlitter::EPath CBlitter::GetBestPath()
+{
+	if (CCpuFeatures::HasAVX2())
+		return PATH_AVX2;
+
+	if (CCpuFeatures::HasSSE2())
+		return PATH_SSE2;
+
+	return PATH_SCALAR;
+}
+
+CBlitter::EPath CBlitter::GetPath()
+{
+	EnsurePath();
+
+	return s_ePath;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetPath ()
+// Desc : Selects the kernels, never a path the processor can't run. Not
+//		meant to be called while other threads blit (tests and benchmarks).
+//-----------------------------------------------------------------------------
+void CBlitter::SetPath(EPath path)
+{
+	EPath best = GetBestPath();
+
+	if (path > best)
+		path = best;
+
+	EnsurePath();
+	SelectPath(path);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clip () (Private)
+// Desc : Clips the source rectangle to the source surface, then the
+//		destination rectangle to the destination surface, moving the other
+//		corner along.
+//-----------------------------------------------------------------------------
+bool CBlitter::Clip(const CFrameBuffer& dst, int& x, int& y, const CFrameBuffer& src, int& sx, int& sy, int& w, int& h)
+{
+	if (dst.IsEmpty() || src.IsEmpty())
+		return false;
+
+	if (sx < 0) { x -= sx; w += sx; sx = 0; }
+	if (sy < 0) { y -= sy; h += sy; sy = 0; }
+	if (sx + w > src.Width())  w = src.Width() - sx;
+	if (sy + h > src.Height()) h = src.Height() - sy;
+
+	if (x < 0) { sx -= x; w += x; x = 0; }
+	if (y < 0) { sy -= y; h += y; y = 0; }
+	if (x + w > dst.Width())  w = dst.Width() - x;
+	if (y + h > dst.Height()) h = dst.Height() - y;
+
+	return w > 0 && h > 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Copy ()
+// Desc : Opaque copy.
+//-----------------------------------------------------------------------------
+void CBlitter::Copy(CFrameBuffer& dst, int x, int y, const CFrameBuffer& src, int sx, int sy, int w, int h)
+{
+	if (!Clip(dst, x, y, src, sx, sy, w, h))
+		return;
+
+	EnsurePath();
+
+	for (int row = 0; row < h; row++)
+		s_pCopyRow(dst.Row(y + row) + x, src.Row(sy + row) + sx, w);
+}
+
+//-----------------------------------------------------------------------------
+// Name : ColorKey ()
+// Desc : Copy that skips the pixels of the transparent color.
+//-----------------------------------------------------------------------------
+void CBlitter::ColorKey(CFrameBuffer& dst, int x, int y, const CFrameBuffer& src, int sx, int sy, int w, int h, uint32_t uKey)
+{
+	if (!Clip(dst, x, y, src, sx, sy, w, h))
+		return;
+
+	EnsurePath();
+
+	uKey &= RGB_BITS;
+
+	for (int row = 0; row < h; row++)
+		s_pKeyRow(dst.Row(y + row) + x, src.Row(sy + row) + sx, w, uKey);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Mask ()
+// Desc : The mask clears the pixels the image is drawn onto, then the image
+//		(black outside the sprite) is ORed in.
+//-----------------------------------------------------------------------------
+void CBlitter::Mask(CFrameBuffer& dst, int x, int y, const CFrameBuffer& src, const CFrameBuffer& mask, int sx, int sy, int w, int h)
+{
+	if (mask.Width() < src.Width() || mask.Height() < src.Height())
+		return;
+
+	if (!Clip(dst, x, y, src, sx, sy, w, h))
+		return;
+
+	EnsurePath();
+
+	for (int row = 0; row < h; row++)
+		s_pMaskRow(dst.Row(y + row) + x, src.Row(sy + row) + sx, mask.Row(sy + row) + sx, w);
+}
+
+//-----------------------------------------------------------------------------
+// Name : MaskRow ()
+// Desc : No clipping, the caller owns the pointers.
+//-----------------------------------------------------------------------------
+void CBlitter::MaskRow(uint32_t *d, const uint32_t *s, const uint32_t *m, int n)
+{
+	EnsurePath();
+
+	s_pMaskRow(d, s, m, n);
+}
@@ -0,0 +1,282 @@
+//-----------------------------------------------------------------------------
+// File: BmpDecoder.cpp
+//
+// Desc: Self contained reader for the .bmp files of the game.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CBmpDecoder Specific Includes
+//-----------------------------------------------------------------------------
+#include "BmpDecoder.h"
+#include "CpuFeatures.h"
+#include "MappedFile.h"
+
+#if CPU_X86
+	#include <emmintrin.h>
+	#include <tmmintrin.h>
+	#include <immintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// BITMAPFILEHEADER is 14 bytes, the info header follows
+static const size_t	FILE_HEADER_SIZE	= 14;
+static const size_t	INFO_HEADER_SIZE	= 40;
+
+static const uint32_t BMP_BI_RGB		= 0;
+static const uint32_t BMP_BI_BITFIELDS	= 3;
+
+// Little endian reads, the headers are not aligned
+static uint32_t ReadU16(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t ReadU32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+//-----------------------------------------------------------------------------
+// Name : RowBytes () (Static, Local)
+// Desc : Rows are padded to a multiple of 4 bytes.
+//-----------------------------------------------------------------------------
+static size_t RowBytes(int iWidth, int iBitCount)
+{
+	return (((size_t)iWidth * iBitCount + 31) / 32) * 4;
+}
+
+//-----------------------------------------------------------------------------
+// 24 to 32 bit row kernels
+//-----------------------------------------------------------------------------
+typedef void (*ExpandRowFn)(uint32_t *d, const uint8_t *s, int n);
+
+static void ExpandRow_Scalar(uint32_t *d, const uint8_t *s, int n)
+{
+	for (int i = 0; i < n; i++, s += 3)
+		d[i] = (uint32_t)s[0] | ((uint32_t)s[1] << 8) | ((uint32_t)s[2] << 16);
+}
+
+#if CPU_X86
+// b g r b g r ... -> b g r 0 b g r 0 ..., 4 pixels per 16 byte load
+CPU_TARGET_SSSE3 static void ExpandRow_SSSE3(uint32_t *d, const uint8_t *s, int n)
+{
+	const __m128i vSpread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	int i = 0;
+
+	// a step uses 12 of the 16 bytes it loads, so it must not run into the
+	// last 4 bytes of the row
+	for (; i + 6 <= n; i += 4)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)(s + 3 * i));
+		_mm_storeu_si128((__m128i*)(d + i), _mm_shuffle_epi8(v, vSpread));
+	}
+
+	ExpandRow_Scalar(d + i, s + 3 * i, n - i);
+}
+
+// 8 pixels per 32 byte load, the dword permute gives every lane 12 bytes
+CPU_TARGET_AVX2 static void ExpandRow_AVX2(uint32_t *d, const uint8_t *s, int n)
+{
+	const __m256i vLanes = _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0);
+	const __m256i vSpread = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+											 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	int i = 0;
+
+	// uses 24 of the 32 bytes loaded
+	for (; i + 11 <= n; i += 8)
+	{
+		__m256i v = _mm256_loadu_si256((const __m256i*)(s + 3 * i));
+		v = _mm256_permutevar8x32_epi32(v, vLanes);
+		_mm256_storeu_si256((__m256i*)(d + i), _mm256_shuffle_epi8(v, vSpread));
+	}
+
+	ExpandRow_SSSE3(d + i, s + 3 * i, n - i);
+}
+#endif // CPU_X86
+
+static ExpandRowFn SelectExpandRow()
+{
+#if CPU_X86
+	if (CCpuFeatures::HasAVX2())
+		return ExpandRow_AVX2;
+
+	if (CCpuFeatures::HasSSSE3())
+		return ExpandRow_SSSE3;
+#endif
+
+	return ExpandRow_Scalar;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Expand24To32 () (Static)
+// Desc : The kernel is chosen on first use.
+//-----------------------------------------------------------------------------
+void CBmpDecoder::Expand24To32(uint32_t *pDst, const uint8_t *pSrc, int n)
+{
+	static const ExpandRowFn pExpandRow = SelectExpandRow();
+
+	pExpandRow(pDst, pSrc, n);
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReadInfo () (Static)
+// Desc : Checks every field the decoder relies on, including that the
+//		pixel rows are inside the file.
+//-----------------------------------------------------------------------------
+bool CBmpDecoder::ReadInfo(const uint8_t *pData, size_t uSize, BmpInfo& info)
+{
+	if (pData == 0 || uSize < FILE_HEADER_SIZE + INFO_HEADER_SIZE)
+		return false;
+
+	if (pData[0] != 'B' || pData[1] != 'M')
+		return false;
+
+	const uint8_t *pInfo = pData + FILE_HEADER_SIZE;
+	uint32_t uOffBits		= ReadU32(pData + 10);
+	uint32_t uHeaderSize	= ReadU32(pInfo);
+	int32_t iWidth			= (int32_t)ReadU32(pInfo + 4);
+	int32_t iHeight			= (int32_t)ReadU32(pInfo + 8);
+	uint32_t uBitCount		= ReadU16(pInfo + 14);
+	uint32_t uCompression	= ReadU32(pInfo + 16);
+
+	// OS/2 core headers are smaller, the V4 / V5 headers only add fields
+	if (uHeaderSize < INFO_HEADER_SIZE || FILE_HEADER_SIZE + uHeaderSize > uSize)
+		return false;
+
+	if (iWidth <= 0 || iWidth > 32768 || iHeight == 0 || iHeight > 32768 || iHeight < -32768)
+		return false;
+
+	if (uBitCount != 1 && uBitCount != 4 && uBitCount != 8 && uBitCount != 24 && uBitCount != 32)
+		return false;
+
+	if (uCompression == BMP_BI_BITFIELDS && uBitCount == 32)
+	{
+		// the masks follow a 40 byte header and are part of the V4 / V5 ones
+		if (FILE_HEADER_SIZE + INFO_HEADER_SIZE + 12 > uSize)
+			return false;
+
+		const uint8_t *pMasks = pInfo + INFO_HEADER_SIZE;
+		if (ReadU32(pMasks) != 0x00FF0000 || ReadU32(pMasks + 4) != 0x0000FF00 || ReadU32(pMasks + 8) != 0x000000FF)
+			return false;
+	}
+	else if (uCompression != BMP_BI_RGB)
+	{
+		return false;
+	}
+
+	info.iWidth		= iWidth;
+	info.iHeight	= (iHeight < 0) ? -iHeight : iHeight;
+	info.iBitCount	= (int)uBitCount;
+	info.bTopDown	= (iHeight < 0);
+
+	if (uBitCount <= 8)
+	{
+		uint32_t uColors = ReadU32(pInfo + 32);
+		if (uColors == 0 || uColors > (1u << uBitCount))
+			uColors = 1u << uBitCount;
+
+		if (FILE_HEADER_SIZE + uHeaderSize + (size_t)uColors * 4 > uSize)
+			return false;
+	}
+
+	size_t uPixelBytes = RowBytes(info.iWidth, info.iBitCount) * info.iHeight;
+
+	return uOffBits <= uSize && uPixelBytes <= uSize - uOffBits;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Decode () (Static)
+// Desc : Converts every file row straight into its destination row.
+//-----------------------------------------------------------------------------
+bool CBmpDecoder::Decode(const uint8_t *pData, size_t uSize, uint32_t *pDst, int iDstPitch, bool bBottomUp)
+{
+	BmpInfo info;
+
+	if (!ReadInfo(pData, uSize, info))
+		return false;
+
+	const uint8_t *pInfo	= pData + FILE_HEADER_SIZE;
+	const uint8_t *pBits	= pData + ReadU32(pData + 10);
+	size_t uRowBytes		= RowBytes(info.iWidth, info.iBitCount);
+	int w					= info.iWidth;
+	int h					= info.iHeight;
+
+	// palette as ready to store pixels
+	uint32_t palette[256];
+
+	if (info.iBitCount <= 8)
+	{
+		const uint8_t *pColors = pInfo + ReadU32(pInfo);
+		uint32_t uColors = ReadU32(pInfo + 32);
+		if (uColors == 0 || uColors > (1u << info.iBitCount))
+			uColors = 1u << info.iBitCount;
+
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			palette[i] = (i < uColors) ? (ReadU32(pColors + 4 * i) & 0x00FFFFFF) : 0;
+		}
+	}
+
+	for (int r = 0; r < h; r++)
+	{
+		const uint8_t *s = pBits + r * uRowBytes;
+
+		// file row r is image row y (counted from the top)
+		int y = info.bTopDown ? r : h - 1 - r;
+		uint32_t *d = pDst + (size_t)(bBottomUp ? h - 1 - y : y) * iDstPitch;
+
+		switch (info.iBitCount)
+		{
+		case 32:
+			for (int x = 0; x < w; x++)
+				d[x] = ReadU32(s + 4 * x) & 0x00FFFFFF;
+			break;
+
+		case 24:
+			Expand24To32(d, s, w);
+			break;
+
+		case 8:
+			for (int x = 0; x < w; x++)
+				d[x] = palette[s[x]];
+			break;
+
+		case 4:
+			for (int x = 0; x < w; x++)
+				d[x] = palette[(s[x >> 1] >> ((x & 1) ? 0 : 4)) & 0x0F];
+			break;
+
+		case 1:
+			for (int x = 0; x < w; x++)
+				d[x] = palette[(s[x >> 3] >> (7 - (x & 7))) & 1];
+			break;
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadFile () (Static)
+// Desc : Decodes from the mapped file, no intermediate copy.
+//-----------------------------------------------------------------------------
+bool CBmpDecoder::LoadFile(const char *szFileName, CFrameBuffer& pixels)
+{
+	CMappedFile file;
+	BmpInfo info;
+
+	if (!file.Open(szFileName) || !ReadInfo(file.Data(), file.Size(), info))
+		return false;
+
+	pixels.Create(info.iWidth, info.iHeight);
+
+	if (!Decode(file.Data(), file.Size(), pixels.Pixels(), pixels.Pitch(), false))
+	{
+		pixels.Release();
+		return false;
+	}
+
+	return true;
+}
@@ -31,7 +31,17 @@ CGameApp::CGameApp()
 	m_pBBuffer		= NULL;
 	m_pPlayer		= NULL;
 	m_pPlayer1		= NULL;
+	m_pBullets		= NULL;
+	m_pEnemies		= NULL;
+	m_pAssets		= NULL;
+	m_dStartTime	= 0.0;
+	m_bFirstFrame	= true;
 	m_LastFrameRate = 0;
+	m_fAccumulator	= 0.0f;
+	ZeroMemory( &m_Input, sizeof(SimInput) );
+
+	SetTickRate( DEFAULT_TICK_RATE );
+	SetFrameRateCap( DEFAULT_FRAME_RATE_CAP );
 }
 
 //-----------------------------------------------------------------------------
@@ -50,6 +60,12 @@ CGameApp::~CGameApp()
 //-----------------------------------------------------------------------------
 bool CGameApp::InitInstance( LPCTSTR lpCmdLine, int iCmdShow )
 {
+	// The time to first frame is counted from here
+	m_dStartTime = m_Timer.GetTime();
+
+	// Read the optional settings
+	ParseCommandLine( lpCmdLine );
+
 	// Create the primary display device
 	if (!CreateDisplay()) { ShutDown(); return false; }
 
@@ -129,33 +145,100 @@ bool CGameApp::CreateDisplay()
 int CGameApp::BeginGame()
 {
 	MSG		msg;
+	bool	bQuit = false;
+	double	dNextFrame = m_Timer.GetTime();
+
+	// Ask for 1ms timer resolution, so the waits below end on time
+	timeBeginPeriod( 1 );
 
 	// Start main loop
-	while(true) 
+	while(!bQuit) 
 	{
-		// Did we recieve a message, or are we idling ?
-		if ( PeekMessage(&msg, NULL, 0, 0, PM_REMOVE) ) 
+		// Handle every message waiting
+		while ( PeekMessage(&msg, NULL, 0, 0, PM_REMOVE) ) 
 		{
 			if (msg.message == WM_QUIT)
 			{
+				bQuit = true;
 				break;
 			}
 
 			TranslateMessage( &msg );
 			DispatchMessage ( &msg );
-		} 
-		else 
+
+		} // End while messages waiting
+
+		if ( bQuit ) break;
+
+		double dNow = m_Timer.GetTime();
+
+		// Is the next frame due ?
+		if ( m_fFrameTime <= 0.0f || dNow >= dNextFrame )
 		{
 			// Advance Game Frame.
 			FrameAdvance();
 
-		} // End If messages waiting
+			// Schedule the next one, without trying to catch up on frames
+			// we were too slow to render
+			dNextFrame += m_fFrameTime;
+			if ( dNextFrame < dNow ) dNextFrame = dNow;
+
+		} 
+		else 
+		{
+			// Sleep until the next frame, or until a message arrives
+			DWORD dwWait = (DWORD)((dNextFrame - dNow) * 1000.0);
+			MsgWaitForMultipleObjects( 0, NULL, FALSE, dwWait, QS_ALLINPUT );
+
+		} // End If frame due
 	
 	} // Until quit message is receieved
 
+	timeEndPeriod( 1 );
+
 	return 0;
 }
 
+//-----------------------------------------------------------------------------
+// Name : SetTickRate ()
+// Desc : Sets the number of simulation ticks per second. Movement, cooldowns
+//		and spawning are counted in seconds, so this changes how finely the
+//		match is stepped, not the game speed.
+//-----------------------------------------------------------------------------
+void CGameApp::SetTickRate( float fTicksPerSecond )
+{
+	if ( fTicksPerSecond <= 0.0f ) fTicksPerSecond = DEFAULT_TICK_RATE;
+
+	m_fTickTime = 1.0f / fTicksPerSecond;
+	m_Sim.SetTickTime( m_fTickTime );
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetFrameRateCap ()
+// Desc : Limits the number of frames drawn per second (0 = no limit).
+//-----------------------------------------------------------------------------
+void CGameApp::SetFrameRateCap( float fFramesPerSecond )
+{
+	m_fFrameTime = ( fFramesPerSecond > 0.0f ) ? 1.0f / fFramesPerSecond : 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ParseCommandLine () (Private)
+// Desc : Reads the optional settings "-tickrate <Hz>" and "-fpscap <Hz>".
+//-----------------------------------------------------------------------------
+void CGameApp::ParseCommandLine( LPCTSTR lpCmdLine )
+{
+	LPCTSTR lpArg;
+
+	if ( !lpCmdLine ) return;
+
+	if ( (lpArg = _tcsstr( lpCmdLine, _T("-tickrate") )) != NULL )
+		SetTickRate( (float)_tstof( lpArg + 9 ) );
+
+	if ( (lpArg = _tcsstr( lpCmdLine, _T("-fpscap") )) != NULL )
+		SetFrameRateCap( (float)_tstof( lpArg + 7 ) );
+}
+
 //-----------------------------------------------------------------------------
 // Name : ShutDown ()
 // Desc : Shuts down the game engine, and frees up all resources.
@@ -249,12 +332,22 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 				// Store new viewport sizes
 				m_nViewWidth  = LOWORD( lParam );
 				m_nViewHeight = HIWORD( lParam );
+
+				// Show the next frame whole
+				if ( m_pBBuffer ) m_pBBuffer->invalidate();
 		
 			
 			} // End if !Minimized
 
 			break;
 
+		case WM_PAINT:
+			// The frames are drawn by FrameAdvance, the window contents
+			// that were lost come back with the next one, shown whole
+			ValidateRect( hWnd, NULL );
+			if ( m_pBBuffer ) m_pBBuffer->invalidate();
+			break;
+
 		case WM_LBUTTONDOWN:
 			// Capture the mouse
 			SetCapture( m_hWnd );
@@ -267,6 +360,9 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 			break;
 
 		case WM_KEYDOWN:
+			// Only escape works until the game objects are built
+			if ( m_pPlayer == NULL && wParam != VK_ESCAPE ) break;
+
 			switch(wParam)
 			{
 			case VK_ESCAPE:
@@ -274,21 +370,19 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 				break;
 			case VK_RETURN:
 				fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-				m_pPlayer->Explode();
-				m_pPlayer->m_pSprite->mVelocity = Vec2(0, 0);
-				m_pPlayer->Position() = Vec2(100, 900);
+				m_pPlayer->Explode(m_pPlayer->Position());
+				m_Sim.RespawnPlayer(0);
 				break;
 			case 'Q':
 				fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-				m_pPlayer1->Explode();
-				m_pPlayer1->m_pSprite->mVelocity = Vec2(0, 0);
-				m_pPlayer1->Position() = Vec2(1800, 900);
+				m_pPlayer1->Explode(m_pPlayer1->Position());
+				m_Sim.RespawnPlayer(1);
 				break;
 			case VK_SPACE:
-				m_pPlayer->Shoot();
+				m_Input.bShoot[0] = true;
 				break;
 			case VK_CONTROL:
-				m_pPlayer1->Shoot();
+				m_Input.bShoot[1] = true;
 				break;
 			case VK_F1:
 				Save_game();
@@ -326,49 +420,168 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 
 //-----------------------------------------------------------------------------
 // Name : BuildObjects ()
-// Desc : Build our demonstration meshes, and the objects that instance them
+// Desc : Creates the back buffer and starts decoding the bitmaps of the game
+//		in the background, the game objects are built by FinishLoading once
+//		they are ready.
 //-----------------------------------------------------------------------------
 bool CGameApp::BuildObjects()
 {
 	m_pBBuffer = new BackBuffer(m_hWnd, m_nViewWidth, m_nViewHeight);
-	m_pPlayer = new CPlayer(m_pBBuffer);
-	m_pPlayer1 = new CPlayer(m_pBBuffer);
+	m_pBBuffer->setCompositor(&m_Compositor);
 
-	Enemy enemy_plane(m_pBBuffer);
-	Enemy enemy_plane1(m_pBBuffer);
-	Enemy enemy_plane2(m_pBBuffer);
+	m_pAssets = new CAssetLoader;
+	AddStartupAssets(*m_pAssets);
 
-	enemyOnScreen.push_back(enemy_plane);
-	enemyOnScreen.push_back(enemy_plane1);
-	enemyOnScreen.push_back(enemy_plane2);
-	
-	if (!m_imgBackground_2.LoadBitmapFromFile("data/background-2.bmp", GetDC(m_hWnd)))
-	{
-		return false;
-	}
+	// The baked pack spares decoding the files it holds
+	if (m_Pack.Open(ASSET_PACK_FILE))
+		m_pAssets->SetPack(&m_Pack);
+
+	m_pAssets->Start(&CThreadPool::Shared());
+
+	// Success!
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddStartupAssets () (Private, Static)
+// Desc : Queues every bitmap the game objects are built from.
+//-----------------------------------------------------------------------------
+void CGameApp::AddStartupAssets( CAssetLoader& assets )
+{
+	assets.Add("data/background-2.bmp");
+	assets.Add("data/background-1.bmp");
+	assets.Add("data/background0.bmp");
+	assets.Add("data/background1.bmp");
+	assets.Add("data/background2.bmp");
+
+	CPlayer::AddAssets(assets);
+	BulletPool::AddAssets(assets);
+	EnemySquadron::AddAssets(assets);
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildAssetPack ()
+// Desc : Writes the startup bitmaps, decoded, to ASSET_PACK_FILE. Run it
+//		again whenever a bitmap changes, the pack wins over the loose files.
+//-----------------------------------------------------------------------------
+int CGameApp::BuildAssetPack()
+{
+	CAssetLoader assets;
+	std::vector<std::string> files;
+	TCHAR szMessage[ 255 ];
+
+	AddStartupAssets( assets );
+
+	for ( int i = 0; i < assets.Count(); i++ )
+		files.push_back( assets.FileName(i) );
+
+	int nPacked = CAssetPack::Build( ASSET_PACK_FILE, files );
 
-	if (!m_imgBackground_1.LoadBitmapFromFile("data/background-1.bmp", GetDC(m_hWnd)))
+	if ( nPacked < 0 )
 	{
-		return false;
+		sprintf_s( szMessage, _T("Failed to write %s."), ASSET_PACK_FILE );
+		MessageBox( 0, szMessage, _T("Asset Pack"), MB_OK | MB_ICONSTOP );
+		return 1;
 	}
-		
-	if (!m_imgBackground0.LoadBitmapFromFile("data/background0.bmp", GetDC(m_hWnd)))
+
+	sprintf_s( szMessage, _T("Packed %d of %d bitmaps into %s."), nPacked, (int)files.size(), ASSET_PACK_FILE );
+	MessageBox( 0, szMessage, _T("Asset Pack"), MB_OK | MB_ICONINFORMATION );
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : FinishLoading () (Private)
+// Desc : Builds the game objects from the decoded bitmaps. A file the loader
+//		could not decode is loaded again the slow way by its object.
+//-----------------------------------------------------------------------------
+bool CGameApp::FinishLoading()
+{
+	HDC hDC = m_pBBuffer->getDC();
+
+	for ( int i = 0; i < m_pAssets->Count(); i++ )
 	{
-		return false;
+		DBOUT( "Loaded " << m_pAssets->FileName(i) << " in " << m_pAssets->LoadTime(i) << " ms" << (m_pAssets->Succeeded(i) ? "" : " (failed)") << "\n" );
 	}
-	
-	if (!m_imgBackground1.LoadBitmapFromFile("data/background1.bmp", GetDC(m_hWnd)))
+
+	DBOUT( "Decoded " << m_pAssets->Count() << " files in " << m_pAssets->TotalTime() << " ms on " << CThreadPool::Shared().ThreadCount() << " threads\n" );
+
+	m_pPlayer = new CPlayer(m_pBBuffer, m_pAssets);
+	m_pPlayer1 = new CPlayer(m_pBBuffer, m_pAssets);
+	m_pBullets = new BulletPool(m_pBBuffer, &m_Sim.Bullets(), m_pAssets);
+	m_pEnemies = new EnemySquadron(m_pBBuffer, &m_Sim.Enemies(), m_pAssets);
+
+	// the simulation collides the entities with the masks of their sprites
+	m_Sim.SetShape(SIM_SHAPE_PLAYER, m_pPlayer->m_pSprite->collisionMask());
+	m_Sim.SetShape(SIM_SHAPE_ENEMY, m_pEnemies->GetSprite()->collisionMask());
+	m_Sim.SetShape(SIM_SHAPE_BULLET, m_pBullets->GetSprite()->collisionMask());
+
+	// Pack the sprite images in one atlas, the players share theirs
+	Sprite *pSprites[] = { m_pPlayer->m_pSprite, m_pPlayer->ExplosionSprite(), m_pPlayer1->m_pSprite, m_pPlayer1->ExplosionSprite(),
+						   m_pBullets->GetSprite(), m_pEnemies->GetSprite() };
+	const int nSprites = sizeof(pSprites) / sizeof(pSprites[0]);
+
+	m_Atlas.Release();
+
+	for ( int i = 0; i < nSprites; i++ )
+		m_Atlas.Add( pSprites[i]->mpImage );
+
+	m_Atlas.Build();
+
+	for ( int i = 0; i < nSprites; i++ )
+		pSprites[i]->setAtlas( &m_Atlas );
+
+	DBOUT( "Packed " << m_Atlas.Count() << " sprite images in " << m_Atlas.PageCount() << " atlas page(s)\n" );
+
+	bool bLoaded = m_imgBackground_2.LoadBitmapFromFile("data/background-2.bmp", hDC, m_pAssets) &&
+				   m_imgBackground_1.LoadBitmapFromFile("data/background-1.bmp", hDC, m_pAssets) &&
+				   m_imgBackground0.LoadBitmapFromFile("data/background0.bmp", hDC, m_pAssets) &&
+				   m_imgBackground1.LoadBitmapFromFile("data/background1.bmp", hDC, m_pAssets) &&
+				   m_imgBackground2.LoadBitmapFromFile("data/background2.bmp", hDC, m_pAssets);
+
+	// The sprite images read the pack in place (it stays open until
+	// ReleaseObjects), everything else keeps its own copy of the pixels
+	delete m_pAssets;
+	m_pAssets = NULL;
+
+	return bLoaded;
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawLoading () (Private)
+// Desc : Loading screen, a progress bar of the decoded files.
+//-----------------------------------------------------------------------------
+void CGameApp::DrawLoading()
+{
+	static int	iLastLoaded = -1;
+	CFrameBuffer &frame = m_pBBuffer->getFrame();
+	int			iLoaded = m_pAssets->LoadedCount();
+	int			nAssets = m_pAssets->Count();
+
+	if ( iLoaded != iLastLoaded )
 	{
-		return false;
+		TCHAR TitleBuffer[ 255 ];
+		sprintf_s( TitleBuffer, _T("2D Plane Battle Game : Loading %d / %d"), iLoaded, nAssets );
+		SetWindowText( m_hWnd, TitleBuffer );
+		iLastLoaded = iLoaded;
 	}
-	
-	if (!m_imgBackground2.LoadBitmapFromFile("data/background2.bmp", GetDC(m_hWnd)))
+
+	frame.Fill( 0x00000000 );
+
+	int x0		= frame.Width() / 4;
+	int x1		= frame.Width() - x0;
+	int xDone	= ( nAssets > 0 ) ? x0 + ( x1 - x0 ) * iLoaded / nAssets : x1;
+	int y0		= max( frame.Height() / 2 - 8, 0 );
+	int y1		= min( frame.Height() / 2 + 8, frame.Height() );
+
+	for ( int y = y0; y < y1; y++ )
 	{
-		return false;
+		uint32_t *pRow = frame.Row( y );
+
+		for ( int x = x0; x < x1; x++ )
+			pRow[x] = ( x < xDone ) ? 0x00FFFFFF : 0x00404040;
 	}
-		
-	// Success!
-	return true;
+
+	m_pBBuffer->present();
 }
 
 //-----------------------------------------------------------------------------
@@ -377,8 +590,7 @@ bool CGameApp::BuildObjects()
 //-----------------------------------------------------------------------------
 void CGameApp::SetupGameState()
 {
-	m_pPlayer->Position() = Vec2(100, 900);
-	m_pPlayer1->Position() = Vec2(1800, 900);
+	m_Sim.Reset();
 }
 
 //-----------------------------------------------------------------------------
@@ -394,11 +606,41 @@ void CGameApp::ReleaseObjects( )
 		m_pPlayer = NULL;
 	}
 
+	if(m_pPlayer1 != NULL)
+	{
+		delete m_pPlayer1;
+		m_pPlayer1 = NULL;
+	}
+
+	// Stops the loading if the game quits before it is over
+	if(m_pAssets != NULL)
+	{
+		delete m_pAssets;
+		m_pAssets = NULL;
+	}
+
+	if(m_pBullets != NULL)
+	{
+		delete m_pBullets;
+		m_pBullets = NULL;
+	}
+
+	if(m_pEnemies != NULL)
+	{
+		delete m_pEnemies;
+		m_pEnemies = NULL;
+	}
+
 	if(m_pBBuffer != NULL)
 	{
 		delete m_pBBuffer;
 		m_pBBuffer = NULL;
 	}
+
+	// The sprite images are gone with their sprites, nothing points into
+	// the pack any more
+	m_Atlas.Release();
+	m_Pack.Close();
 }
 
 //-----------------------------------------------------------------------------
@@ -415,24 +657,124 @@ void CGameApp::FrameAdvance()
 
 	// Skip if app is inactive
 	if ( !m_bActive ) return;
+
+	// Show the loading screen until the bitmaps are decoded
+	if ( m_pAssets != NULL )
+	{
+		if ( !m_pAssets->IsFinished() )
+		{
+			DrawLoading();
+			return;
+		}
+
+		if ( !FinishLoading() )
+		{
+			MessageBox( 0, _T("Failed to initialize properly. Reinstalling the application may solve this problem.\nIf the problem persists, please contact technical support."), 
+				_T("Fatal Error"), MB_OK | MB_ICONSTOP);
+
+			PostQuitMessage( 0 );
+			return;
+		}
+
+		// The game starts now, not when the loading started
+		m_fAccumulator = 0.0f;
+		m_LastFrameRate = 0;
+	}
 	
 	// Get / Display the framerate
 	if ( m_LastFrameRate != m_Timer.GetFrameRate() )
 	{
+		CImageCache::Stats images = CImageCache::Shared().GetStats();
+
 		m_LastFrameRate = m_Timer.GetFrameRate( FrameRate, 50 );
-		sprintf_s( TitleBuffer, _T("2D Plane Battle Game : %s"), FrameRate );
+		sprintf_s( TitleBuffer, _T("2D Plane Battle Game : %s | Bullets : %d / %d (peak %d) | GDI objects / frame : %lu | Images : %d (%lu KB, %lu hits) | Pixels / frame : %lu K"), FrameRate,
+			m_pBullets->ActiveCount(), m_pBullets->Capacity(), m_pBullets->HighWaterMark(), CGdiStats::GetLastFrameCount(),
+			images.iEntries, (ULONG)(images.uBytes / 1024), images.ulHits, (ULONG)(m_pBBuffer->getPixelsTouched() / 1000) );
 		SetWindowText( m_hWnd, TitleBuffer );
 
 	} // End if Frame Rate Altered
 
+	// Run as many fixed ticks as the real time elapsed covers. After a
+	// long stall the game slows down instead of running a huge catch up.
+	float fFrameTime = m_Timer.GetFrameTime();
+	if ( fFrameTime > MAX_FRAME_TIME ) fFrameTime = MAX_FRAME_TIME;
+
+	m_fAccumulator += fFrameTime;
+
+	while ( m_fAccumulator >= m_fTickTime )
+	{
+		SimulationTick();
+		m_fAccumulator -= m_fTickTime;
+
+	} // Next Tick
+
+	// Drawing the game objects, the time left over is how far we are
+	// between the last tick and the next one
+	DrawObjects( m_fAccumulator / m_fTickTime );
+
+	if ( m_bFirstFrame )
+	{
+		DBOUT( "Time to first frame: " << ( m_Timer.GetTime() - m_dStartTime ) * 1000.0 << " ms\n" );
+		m_bFirstFrame = false;
+	}
+
+	// Close the GDI object count of this frame
+	CGdiStats::EndFrame();
+}
+
+//-----------------------------------------------------------------------------
+// Name : SimulationTick () (Private)
+// Desc : Advances the game by one fixed tick.
+//-----------------------------------------------------------------------------
+void CGameApp::SimulationTick()
+{
 	// Poll & Process input devices
 	ProcessInput();
 
 	// Animate the game objects
 	AnimateObjects();
 
-	// Drawing the game objects
-	DrawObjects();
+	// Move, shoot, collide
+	m_Sim.Tick( m_Input );
+
+	// The shots have been fired
+	m_Input.bShoot[0] = false;
+	m_Input.bShoot[1] = false;
+
+	// Explosions, sounds
+	HandleEvents();
+}
+
+//-----------------------------------------------------------------------------
+// Name : HandleEvents () (Private)
+// Desc : Reacts to what happened during the last simulation tick.
+//-----------------------------------------------------------------------------
+void CGameApp::HandleEvents()
+{
+	static UINT			fTimer;
+	CPlayer				*pPlayers[SIM_PLAYER_COUNT] = { m_pPlayer, m_pPlayer1 };
+	const std::vector<SimEvent> &events = m_Sim.Events();
+
+	for ( size_t i = 0; i < events.size(); i++ )
+	{
+		const SimEvent &ev = events[i];
+
+		switch ( ev.type )
+		{
+		case SIM_EVENT_PLAYER_EXPLODED:
+			// the explosion animation runs on the timer
+			fTimer = SetTimer(m_hWnd, 1, 70, NULL);
+			pPlayers[ev.iPlayer]->Explode(Vec2((double)ev.x, (double)ev.y));
+			break;
+
+		case SIM_EVENT_MATCH_WON:
+			fTimer = SetTimer(m_hWnd, 1, 70, NULL);
+			break;
+
+		default:
+			break;
+		}
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -462,10 +804,10 @@ void CGameApp::ProcessInput( )
 	if (pKeyBuffer[ 'D' ] & 0xF0) Direction1 |= CPlayer::DIR_RIGHT;
 
 	
-	// Move the player
+	// Move the players on the next tick
 	
-	m_pPlayer->Move(Direction);
-	m_pPlayer1->Move(Direction1);
+	m_Input.uDirection[0] = Direction;
+	m_Input.uDirection[1] = Direction1;
 
 	// Now process the mouse (if the button is pressed)
 	if ( GetCapture() == m_hWnd )
@@ -483,280 +825,84 @@ void CGameApp::ProcessInput( )
 }
 
 
-// Method that tests if two entities collide
-// We calculate a frame for our two objects by adding their 
-bool CGameApp :: Sprite_Collide(Sprite *entity1, Sprite *entity2) 
-{
-
-	double left1, left2;
-	double right1, right2;
-	double top1, top2;
-	double bottom1, bottom2;
-
-
-	left1 = entity1->mPosition.x - (entity1->width() / 2);
-	left2 = entity2->mPosition.x - (entity2->width() / 2);
-
-	right1 = left1 + entity1->width();
-	right2 = left2 + entity2->width();
-
-	top1 = entity1->mPosition.y - (entity1->height() / 2);
-	top2 = entity2->mPosition.y - (entity2->height() / 2);
-
-	bottom1 = top1 + entity1->height();
-	bottom2 = top2 + entity2->height();
-
-	if (bottom1 < top2)
-	{
-		return false;
-	}
-
-	else if (top1 > bottom2)
-	{
-		return false;
-	}
-
-	else if (right1 < left2) 
-	{
-		return false;
-	}
-	
-	else if (left1 > right2) 
-	{
-		return false;
-	}
-
-	else
-	{
-		return true;
-	}
-};
-
 //-----------------------------------------------------------------------------
 // Name : AnimateObjects () (Private)
 // Desc : Animates the objects we currently have loaded.
 //-----------------------------------------------------------------------------
 void CGameApp::AnimateObjects()
 {
-	m_pPlayer->Update(m_Timer.GetTimeElapsed());
-	m_pPlayer1->Update(m_Timer.GetTimeElapsed());
+	m_pPlayer->Update(m_fTickTime);
+	m_pPlayer1->Update(m_fTickTime);
 }
 
 
 //-----------------------------------------------------------------------------
 // Name : DrawObjects () (Private)
-// Desc : Draws the game objects
+// Desc : Draws the game objects, fAlpha of the way between the last two
+//		simulation ticks.
 //-----------------------------------------------------------------------------
-void CGameApp::DrawObjects()
+void CGameApp::DrawObjects(float fAlpha)
 {
-	static UINT			fTimer;
-	m_pBBuffer->reset();
+	int plane_lives = m_Sim.PlayerLives();
+	int enemy_lives = m_Sim.EnemyLives();
+
+	// The background only changes with the lives: the back buffer keeps a
+	// copy of it and asks for it again only when another one is needed.
+	CImageFile *pBackground = NULL;
 
-	if (this->plane_lives == 2 && this->enemy_lives != -1)
+	if (plane_lives == 2 && enemy_lives != -1)
 	{
-		m_imgBackground2.Paint(m_pBBuffer->getDC(), 0, 0);
+		pBackground = &m_imgBackground2;
 	}
 
-	else if (this->plane_lives == 1 && this->enemy_lives != -1)
+	else if (plane_lives == 1 && enemy_lives != -1)
 	{
-		m_imgBackground1.Paint(m_pBBuffer->getDC(), 0, 0);
+		pBackground = &m_imgBackground1;
 	}
 
-	else if (this->plane_lives == 0 && this->enemy_lives != -1)
+	else if (plane_lives == 0 && enemy_lives != -1)
 	{
-		m_imgBackground0.Paint(m_pBBuffer->getDC(), 0, 0);
+		pBackground = &m_imgBackground0;
 	}
 
-	else if(this->plane_lives == -1 && this->enemy_lives != -1)
+	else if(plane_lives == -1 && enemy_lives != -1)
 	{
-		m_imgBackground_1.Paint(m_pBBuffer->getDC(), 0, 0);
+		pBackground = &m_imgBackground_1;
 	}
 
 	else if (enemy_lives == -1)
 	{
-		m_imgBackground_2.Paint(m_pBBuffer->getDC(), 0, 0);
+		pBackground = &m_imgBackground_2;
 	}
 
-	// Draw the players if no one has won yet
-	if (plane_lives != -1 && enemy_lives != -1)
+	// The backgrounds are told apart by the lives that pick them
+	int iBackground = (enemy_lives == -1) ? -2 : plane_lives;
+
+	if (m_pBBuffer->beginFrame(iBackground) && pBackground != NULL)
 	{
-		m_pPlayer->Draw();
-		m_pPlayer1->Draw();
+		pBackground->Paint(m_pBBuffer->getDC(), 0, 0);
 	}
-	
-	//If there is no enemy, we create an enemy and save it
-	if (enemyOnScreen.size() == 0 && enemy_lives != -1)
-	{
-		if (enemy_lives != -1)
-		{
-			Enemy enemy_plane(m_pBBuffer);
-			Enemy enemy_plane1(m_pBBuffer);
-			Enemy enemy_plane2(m_pBBuffer);
 
-			enemy_plane.m_pSprite->mPosition = Vec2(950, 70);
-			enemy_plane1.m_pSprite->mPosition = Vec2(350, 70);
-			enemy_plane2.m_pSprite->mPosition = Vec2(1550, 70);
-
-
-			enemyOnScreen.push_back(enemy_plane);
-			enemyOnScreen.push_back(enemy_plane1);
-			enemyOnScreen.push_back(enemy_plane2);
-		}
-	}
+	// The planes are drawn between their positions of the last two ticks
+	CPlayer *pPlayers[SIM_PLAYER_COUNT] = { m_pPlayer, m_pPlayer1 };
 
-	// we update the enemy position by searching for them in the container
-	for(auto &it : enemyOnScreen) 
+	for (int p = 0; p < SIM_PLAYER_COUNT; p++)
 	{
-		// turn on the enemy plane if he has lives left and the player is still alive
-		if (enemy_lives != -1 && plane_lives != -1)
-		{
-			it.shootCooldown--;
-			it.move();
-			it.m_pSprite->draw();
-			it.Shoot();
-		}
+		const SimPlayer &pl = m_Sim.Player(p);
 
-		// if planes get too close, our plane will explode (the enemy wins)
-		if (Sprite_Collide(it.m_pSprite, m_pPlayer->m_pSprite))
-		{
-			fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-			m_pPlayer->Explode();
-			m_pPlayer->m_pSprite->mVelocity = Vec2(0, 0);
-			m_pPlayer->Position() = Vec2(100, 900);
-		}
-
-		if (Sprite_Collide(it.m_pSprite, m_pPlayer1->m_pSprite))
-		{
-			fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-			m_pPlayer1->Explode();
-			m_pPlayer1->m_pSprite->mVelocity = Vec2(0, 0);
-			m_pPlayer1->Position() = Vec2(1800, 900);
-		}
+		pPlayers[p]->Position() = Vec2((double)(pl.prevX + (pl.x - pl.prevX) * fAlpha), (double)(pl.prevY + (pl.y - pl.prevY) * fAlpha));
 	}
 
-	// we do things like above for the bullets in the container
-	for (auto &it : bulletsOnScreen)
+	// Draw the players if no one has won yet
+	if (plane_lives != -1 && enemy_lives != -1)
 	{
-		it.Move();
-		it.m_pSprite->draw();
-		
-		// we get an iterator to the first and currently only enemy plane
-		// we also get iterators to the second and third enemy planes
-		auto enemy_it = enemyOnScreen.begin();
-		auto enemy_it1 = std::next(enemy_it);
-		auto enemy_it2 = std::next(enemy_it1);
-
-		// like for the planes, the enemies have 3 lives
-		if (Sprite_Collide(it.m_pSprite, enemy_it->m_pSprite) && this->enemy_lives > 0 && it.owner == "player")
-		{
-			it.m_pSprite->mPosition = Vec2(1070, 0);
-			it.m_pSprite->mVelocity = Vec2(0, 0);
-			
-			enemy_it->hit = true;
-			
-			this->enemy_lives--;
-		}
-
-		if (Sprite_Collide(it.m_pSprite, enemy_it1->m_pSprite) && this->enemy_lives > 0 && it.owner == "player")
-		{
-			it.m_pSprite->mPosition = Vec2(1070, 0);
-			it.m_pSprite->mVelocity = Vec2(0, 0);
-			
-			enemy_it1->hit = true;
-			
-			this->enemy_lives--;
-		}
-
-		if (Sprite_Collide(it.m_pSprite, enemy_it2->m_pSprite) && this->enemy_lives > 0 && it.owner == "player")
-		{
-			it.m_pSprite->mPosition = Vec2(1070, 0);
-			it.m_pSprite->mVelocity = Vec2(0, 0);
-			
-			enemy_it2->hit = true;
-			
-			this->enemy_lives--;
-		}
-
-		// if enemies dont have lives left and one of them gets hit, we win the game
-		else if ( (Sprite_Collide(it.m_pSprite, enemy_it->m_pSprite) || Sprite_Collide(it.m_pSprite, enemy_it1->m_pSprite) || 
-			Sprite_Collide(it.m_pSprite, enemy_it2->m_pSprite)) && this->enemy_lives == 0 && it.owner == "player")
-		{
-			fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-
-			enemy_it->m_pSprite->mPosition = Vec2(950, 70);
-			enemy_it->m_pSprite->mVelocity = Vec2(0, 0);
-
-			it.m_pSprite->mVelocity = Vec2(0, 0);
-			it.m_pSprite->mPosition = Vec2(1070, 0);
-
-			this->enemy_lives = -1;
-		}
-		
-		// if the bullets hit the players for 3 times, they will lose
-		if (Sprite_Collide(it.m_pSprite, m_pPlayer->m_pSprite) && this->plane_lives > 0 && it.owner == "enemy")
-		{
-			it.m_pSprite->mPosition = Vec2(1070, 0);
-			it.m_pSprite->mVelocity = Vec2(0, 0);
-			this->plane_lives--;
-		}
-
-		else if (Sprite_Collide(it.m_pSprite, m_pPlayer->m_pSprite) && this->plane_lives == 0  && it.owner == "enemy")
-		{
-			fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-			
-			m_pPlayer->Explode();
-			
-			m_pPlayer->m_pSprite->mVelocity = Vec2(0, 0);
-			m_pPlayer->m_pSprite->mPosition = Vec2(100, 900);
-			
-			it.m_pSprite->mVelocity = Vec2(0, 0);
-			it.m_pSprite->mPosition = Vec2(1070, 0);
-			
-			this->plane_lives = -1;
-		}
-
-		if (Sprite_Collide(it.m_pSprite, m_pPlayer1->m_pSprite) && this->plane_lives > 0 && it.owner == "enemy")
-		{
-			it.m_pSprite->mPosition = Vec2(1070, 0);
-			it.m_pSprite->mVelocity = Vec2(0, 0);
-			this->plane_lives--;
-		}
-
-		else if (Sprite_Collide(it.m_pSprite, m_pPlayer1->m_pSprite) && this->plane_lives == 0 && it.owner == "enemy") 
-		{
-			fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-			
-			m_pPlayer1->Explode();
-			
-			m_pPlayer1->m_pSprite->mVelocity = Vec2(0, 0);
-			m_pPlayer1->m_pSprite->mPosition = Vec2(1800, 900);
-			
-			it.m_pSprite->mPosition = Vec2(1070, 0);
-			it.m_pSprite->mVelocity = Vec2(0, 0);
-			
-			this->plane_lives = -1;
-		}
+		m_pPlayer->Draw();
+		m_pPlayer1->Draw();
+		m_pEnemies->Draw(fAlpha);
 	}
 
-	// Remove a bullet if it gets close to the margin of the screen
-	// A lambda function from STL that checks if the bullet is close to the limit of the screen
-	// If true, the bullet from the container will be removed by the remove_if algorithm
-
-	bulletsOnScreen.remove_if([=](Bullet bullet) 
-	{ return (bullet.m_pSprite->mPosition.y < 35 || bullet.m_pSprite->mPosition.y > 960
-		|| plane_lives == -1 || enemy_lives == -1) ? true : false;
-	});
-
-	// Remove an enemy if it gets close to the margin of the screen
-	// A lambda function from STL that checks if the enemy is close to the limit of the screen
-	// If true, the enemy from the container will be removed by the remove_if algorithm
-	// In the main case we will have just an enemy object, so the container will contain
-	// At most one element in the base case
-	
-	enemyOnScreen.remove_if([=](Enemy enemy_plane){
-		return (enemy_plane.m_pSprite->mPosition.y < 35 || 
-			enemy_plane.m_pSprite->mPosition.y > 960) ? true : false;
-	});
+	// Draw all the bullets at once
+	m_pBullets->Draw(fAlpha);
 
 	m_pBBuffer->present();
 }
@@ -769,22 +915,24 @@ void CGameApp::Save_game()
 	ofstream fout;
 	fout.open("game_data.txt", ofstream::out | ofstream::trunc);
 
-	// we get an iterator to the first and currently only enemy plane
-	// we also get iterators to the second and third enemy planes
-	auto enemy_it = enemyOnScreen.begin();
-	auto enemy_it1 = std::next(enemy_it);
-	auto enemy_it2 = std::next(enemy_it1);
+	CEntityStore &enemies = m_Sim.Enemies();
 	
 	// we save in the file the positions of the two players and the positions of the three enemy planes
-	fout << "Plane1:" << " " <<  m_pPlayer->m_pSprite->mPosition.x << " " <<  m_pPlayer->m_pSprite->mPosition.y << endl;
-	fout << "Plane2:" << " " << m_pPlayer1->m_pSprite->mPosition.x << " " << m_pPlayer1->m_pSprite->mPosition.y << endl;
-	fout << "Enemy1:" << " " << enemy_it->m_pSprite->mPosition.x << " " << enemy_it->m_pSprite->mPosition.y << endl;
-	fout << "Enemy2:" << " " << enemy_it1->m_pSprite->mPosition.x << " " << enemy_it1->m_pSprite->mPosition.y << endl;
-	fout << "Enemy3:" << " " << enemy_it2->m_pSprite->mPosition.x << " " << enemy_it2->m_pSprite->mPosition.y << endl;
+	fout << "Plane1:" << " " <<  m_Sim.Player(0).x << " " <<  m_Sim.Player(0).y << endl;
+	fout << "Plane2:" << " " << m_Sim.Player(1).x << " " << m_Sim.Player(1).y << endl;
+
+	for (int e = 0; e < 3; e++)
+	{
+		// a missing enemy is saved at the position where the wave spawns
+		double x = (e < enemies.Count()) ? enemies.PosX()[e] : 950;
+		double y = (e < enemies.Count()) ? enemies.PosY()[e] : 70;
+
+		fout << "Enemy" << e + 1 << ":" << " " << x << " " << y << endl;
+	}
 
 	// we also save the number of lives of friendly and enemy planes
-	fout << "FriendlyLives:" << " " << plane_lives << endl;
-	fout << "EnemyLives:" << " " << enemy_lives;
+	fout << "FriendlyLives:" << " " << m_Sim.PlayerLives() << endl;
+	fout << "EnemyLives:" << " " << m_Sim.EnemyLives();
 
 	// close the file
 	fout.close();
@@ -803,12 +951,6 @@ void CGameApp::Load_game()
 	double p1y, p2y, e1y, e2y, e3y;
 	double pLives, eLives;
 
-	// we get an iterator to the first and currently only enemy plane
-	// we also get iterators to the second and third enemy planes
-	auto enemy_it = enemyOnScreen.begin();
-	auto enemy_it1 = std::next(enemy_it);
-	auto enemy_it2 = std::next(enemy_it1);
-
 	// we want to get rid of the non useful text between the plane positions ("Plane x position =" and " ")
 	string garbage;
 
@@ -819,28 +961,21 @@ void CGameApp::Load_game()
 	fin >> garbage >> e2x >> e2y;
 	fin >> garbage >> e3x >> e3y;
 
-	m_pPlayer->m_pSprite->mVelocity = Vec2(0, 0);
-	m_pPlayer->Position() = Vec2(p1x, p1y);
-	
-	m_pPlayer1->m_pSprite->mVelocity = Vec2(0, 0);
-	m_pPlayer1->Position() = Vec2(p2x, p2y);
-	
-	enemy_it->m_pSprite->mVelocity = Vec2(0, 0);
-	enemy_it->m_pSprite->mPosition = Vec2(e1x, e1y);
-	
-	enemy_it1->m_pSprite->mVelocity = Vec2(0, 0);
-	enemy_it1->m_pSprite->mPosition = Vec2(e2x, e2y);
+	m_Sim.PlacePlayer(0, (float)p1x, (float)p1y);
+	m_Sim.PlacePlayer(1, (float)p2x, (float)p2y);
 	
-	enemy_it2->m_pSprite->mVelocity = Vec2(0, 0);
-	enemy_it2->m_pSprite->mPosition = Vec2(e3x, e3y);
+	// the enemy planes are created again at their old positions
+	m_Sim.Enemies().Clear();
+	m_Sim.SpawnEnemy((float)e1x, (float)e1y);
+	m_Sim.SpawnEnemy((float)e2x, (float)e2y);
+	m_Sim.SpawnEnemy((float)e3x, (float)e3y);
 
 	// we load the lives of friendly and enemy planes
 	fin >> garbage >> pLives;
 	fin >> garbage >> eLives;
 
 	// we update the plane lives
-	plane_lives = pLives;
-	enemy_lives = eLives;
+	m_Sim.SetLives((int)pLives, (int)eLives);
 
 	// close the file 
 	fin.close();
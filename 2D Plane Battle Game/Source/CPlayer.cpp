@@ -11,18 +11,22 @@
 // CPlayer Specific Includes
 //-----------------------------------------------------------------------------
 #include "CPlayer.h"
-#include "CGameApp.h"
 
-extern CGameApp	g_App;
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const char *PLANE_IMAGE_FILE			= "data/planeimgandmask.bmp";
+static const char *EXPLOSION_IMAGE_FILE		= "data/explosion.bmp";
+static const char *EXPLOSION_MASK_FILE		= "data/explosionmask.bmp";
 
 //-----------------------------------------------------------------------------
 // Name : CPlayer () (Constructor)
 // Desc : CPlayer Class Constructor
 //-----------------------------------------------------------------------------
-CPlayer::CPlayer(const BackBuffer *pBackBuffer)
+CPlayer::CPlayer(const BackBuffer *pBackBuffer, const CAssetLoader *pAssets)
 {
 	//m_pSprite = new Sprite("data/planeimg.bmp", "data/planemask.bmp");
-	m_pSprite = new Sprite("data/planeimgandmask.bmp", RGB(0xff,0x00, 0xff));
+	m_pSprite = new Sprite(PLANE_IMAGE_FILE, RGB(0xff,0x00, 0xff), pAssets);
 	m_pSprite->setBackBuffer( pBackBuffer );
 	m_eSpeedState = SPEED_STOP;
 	m_fTimer = 0;
@@ -35,7 +39,7 @@ CPlayer::CPlayer(const BackBuffer *pBackBuffer)
 	r.right = 128;
 	r.bottom = 128;
 
-	m_pExplosionSprite	= new AnimatedSprite("data/explosion.bmp", "data/explosionmask.bmp", r, 16);
+	m_pExplosionSprite	= new AnimatedSprite(EXPLOSION_IMAGE_FILE, EXPLOSION_MASK_FILE, r, 16, pAssets);
 	m_pExplosionSprite->setBackBuffer( pBackBuffer );
 	m_bExplosion		= false;
 	m_iExplosionFrame	= 0;
@@ -51,15 +55,19 @@ CPlayer::~CPlayer()
 	delete m_pExplosionSprite;
 }
 
-void CPlayer::Update(float dt)
+//-----------------------------------------------------------------------------
+// Name : AddAssets () (Static)
+// Desc : Queues the files the constructor can take from the loader.
+//-----------------------------------------------------------------------------
+void CPlayer::AddAssets(CAssetLoader& assets)
 {
-	// Update sprite
-	m_pSprite->update(dt);
-
-
-	// Get velocity
-	double v = m_pSprite->mVelocity.Magnitude();
+	assets.Add(PLANE_IMAGE_FILE);
+	assets.Add(EXPLOSION_IMAGE_FILE);
+	assets.Add(EXPLOSION_MASK_FILE);
+}
 
+void CPlayer::Update(float dt)
+{
 	// NOTE: for each async sound played Windows creates a thread for you
 	// but only one, so you cannot play multiple sounds at once.
 	// This creation/destruction of threads also leads to bad performance
@@ -76,12 +84,6 @@ void CPlayer::Update(float dt)
 
 void CPlayer::Draw()
 {	
-	//Cooldown of bullets
-	if (fireCooldown > 1)
-	{
-		fireCooldown--;
-	}
-		
 	if (!m_bExplosion)
 	{
 		m_pSprite->draw();
@@ -93,66 +95,14 @@ void CPlayer::Draw()
 	}
 }
 
-void CPlayer::Move(ULONG ulDirection)
-{
-	if (ulDirection & CPlayer::DIR_LEFT)
-	{
-		m_pSprite->mVelocity.x = m_pSprite->mVelocity.x - 3.5;
-	}
-		
-	if (m_pSprite->mPosition.x < 0) 
-	{
-		m_pSprite->mPosition.x = 0;
-		m_pSprite->mVelocity.x = 0;
-	}
-
-	if (ulDirection & CPlayer::DIR_RIGHT)
-	{
-		m_pSprite->mVelocity.x = m_pSprite->mVelocity.x + 3.5;
-	}
-
-	if (m_pSprite->mPosition.x > g_App.Width) 
-	{
-		m_pSprite->mPosition.x = g_App.Width;
-		m_pSprite->mVelocity.x = 0;
-	}
-
-	if (ulDirection & CPlayer::DIR_FORWARD)
-	{
-		m_pSprite->mVelocity.y = m_pSprite->mVelocity.y - 3.5;
-	}
-		
-	if (m_pSprite->mPosition.y < 300) 
-	{
-		m_pSprite->mPosition.y = 300;
-		m_pSprite->mVelocity.y = 0;
-	}
-		
-	if (ulDirection & CPlayer::DIR_BACKWARD)
-	{
-		m_pSprite->mVelocity.y = m_pSprite->mVelocity.y + 3.5;
-	}
-		
-	if (m_pSprite->mPosition.y > 920) 
-	{
-		m_pSprite->mPosition.y = 920;
-		m_pSprite->mVelocity.y = 0;
-	}
-}
-
 Vec2& CPlayer::Position()
 {
 	return m_pSprite->mPosition;
 }
 
-Vec2& CPlayer::Velocity()
-{
-	return m_pSprite->mVelocity;
-}
-
-void CPlayer::Explode()
+void CPlayer::Explode(const Vec2& position)
 {
-	m_pExplosionSprite->mPosition = m_pSprite->mPosition;
+	m_pExplosionSprite->mPosition = position;
 	m_pExplosionSprite->SetFrame(0);
 	PlaySound("data/explosion.wav", NULL, SND_FILENAME | SND_ASYNC);
 	m_bExplosion = true;
@@ -175,18 +125,3 @@ bool CPlayer::AdvanceExplosion()
 
 	return true;
 }
-
-void CPlayer::Shoot()
-{
-	if (fireCooldown < 5) {
-		Bullet bullet(g_App.m_pBBuffer, "player");
-		
-		/// the current sprite will shoot bullets
-		bullet.m_pSprite->mPosition = this->m_pSprite->mPosition;
-		
-		/// add bullets to the container so that we can draw them all
-		g_App.bulletsOnScreen.push_back(bullet);
-		
-		fireCooldown = 100;
-	}
-}
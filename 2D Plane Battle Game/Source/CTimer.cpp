@@ -39,6 +39,8 @@ CTimer::CTimer()
 
 	// Clear any needed values
 	m_SampleCount		= 0;
+	m_TimeElapsed		= 0.0f;
+	m_FrameTime			= 0.0f;
 	m_FrameRate			= 0;
 	m_FPSFrameCount		= 0;
 	m_FPSTimeElapsed	= 0.0f;
@@ -107,13 +109,14 @@ void CTimer::Tick( float fLockFPS )
 
 	// Save current frame time
 	m_LastTime = m_CurrentTime;
+	m_FrameTime = fTimeElapsed;
 
 	// Filter out values wildly different from current average
 	if ( fabsf(fTimeElapsed - m_TimeElapsed) < 1.0f  )
 	{
 		// Wrap FIFO frame time buffer.
-		memmove( &m_FrameTime[1], m_FrameTime, (MAX_SAMPLE_COUNT - 1) * sizeof(float) );
-		m_FrameTime[ 0 ] = fTimeElapsed;
+		memmove( &m_FrameTimes[1], m_FrameTimes, (MAX_SAMPLE_COUNT - 1) * sizeof(float) );
+		m_FrameTimes[ 0 ] = fTimeElapsed;
 		if ( m_SampleCount < MAX_SAMPLE_COUNT ) m_SampleCount++;
 
 	} // End if
@@ -131,7 +134,7 @@ void CTimer::Tick( float fLockFPS )
 
 	// Count up the new average elapsed time
 	m_TimeElapsed = 0.0f;
-	for ( ULONG i = 0; i < m_SampleCount; i++ ) m_TimeElapsed += m_FrameTime[ i ];
+	for ( ULONG i = 0; i < m_SampleCount; i++ ) m_TimeElapsed += m_FrameTimes[ i ];
 	if ( m_SampleCount > 0 ) m_TimeElapsed /= m_SampleCount;
 
 }
@@ -164,3 +167,31 @@ float CTimer::GetTimeElapsed() const
 {
 	return m_TimeElapsed;
 }
+
+//-----------------------------------------------------------------------------
+// Name : GetFrameTime () 
+// Desc : Returns the exact time of the last frame, without the averaging
+//		(Seconds). This is what a fixed timestep accumulator needs.
+//-----------------------------------------------------------------------------
+float CTimer::GetFrameTime() const
+{
+	return m_FrameTime;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetTime () 
+// Desc : Returns the current time (Seconds), used for frame pacing.
+//-----------------------------------------------------------------------------
+double CTimer::GetTime() const
+{
+	__int64 Time;
+
+	// Is performance hardware available?
+	if ( m_PerfHardware ) 
+	{
+		QueryPerformanceCounter((LARGE_INTEGER *)&Time);
+		return (double)Time / (double)m_PerfFreq;
+	}
+
+	return timeGetTime() * 0.001;
+}
@@ -0,0 +1,195 @@
+//-----------------------------------------------------------------------------
+// File: CollisionMask.cpp
+//
+// Desc: 1 bit per pixel silhouette of a sprite, used for the pixel exact
+//		collision test.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CCollisionMask Specific Includes
+//-----------------------------------------------------------------------------
+#include "CollisionMask.h"
+
+//-----------------------------------------------------------------------------
+// Name : CCollisionMask () (Constructor)
+// Desc : CCollisionMask Class Constructor
+//-----------------------------------------------------------------------------
+CCollisionMask::CCollisionMask()
+{
+	m_iWidth		= 0;
+	m_iHeight		= 0;
+	m_iWordsPerRow	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CCollisionMask () (Destructor)
+// Desc : CCollisionMask Class Destructor
+//-----------------------------------------------------------------------------
+CCollisionMask::~CCollisionMask()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Allocate () (Private)
+// Desc : Sizes the bit array, every bit cleared (so the padding bits at the
+//		end of the rows stay 0).
+//-----------------------------------------------------------------------------
+void CCollisionMask::Allocate(int iWidth, int iHeight)
+{
+	m_iWidth		= iWidth;
+	m_iHeight		= iHeight;
+	m_iWordsPerRow	= (iWidth + 63) / 64;
+
+	m_Bits.assign(m_iWordsPerRow * m_iHeight, 0);
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildFromColorKey ()
+// Desc : Every pixel that is not the transparent color is solid.
+//-----------------------------------------------------------------------------
+void CCollisionMask::BuildFromColorKey(const uint32_t *pPixels, int iWidth, int iHeight, int iStride, uint32_t uColorKey)
+{
+	Allocate(iWidth, iHeight);
+
+	for (int y = 0; y < iHeight; y++)
+	{
+		const uint32_t *src = pPixels + y * iStride;
+		uint64_t *dst = &m_Bits[y * m_iWordsPerRow];
+
+		for (int x = 0; x < iWidth; x++)
+		{
+			if ((src[x] & 0x00FFFFFF) != (uColorKey & 0x00FFFFFF))
+			{
+				dst[x >> 6] |= (uint64_t)1 << (x & 63);
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildFromMask ()
+// Desc : The mask bitmaps are black where the sprite is drawn and white
+//		elsewhere, anything darker than mid gray counts as solid.
+//-----------------------------------------------------------------------------
+void CCollisionMask::BuildFromMask(const uint32_t *pMask, int iWidth, int iHeight, int iStride)
+{
+	Allocate(iWidth, iHeight);
+
+	for (int y = 0; y < iHeight; y++)
+	{
+		const uint32_t *src = pMask + y * iStride;
+		uint64_t *dst = &m_Bits[y * m_iWordsPerRow];
+
+		for (int x = 0; x < iWidth; x++)
+		{
+			uint32_t r = (src[x] >> 16) & 0xFF;
+			uint32_t g = (src[x] >> 8) & 0xFF;
+			uint32_t b = src[x] & 0xFF;
+
+			if (r + g + b < 3 * 128)
+			{
+				dst[x >> 6] |= (uint64_t)1 << (x & 63);
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildSolid ()
+// Desc : Box shaped mask, the padding bits past the width stay 0.
+//-----------------------------------------------------------------------------
+void CCollisionMask::BuildSolid(int iWidth, int iHeight)
+{
+	Allocate(iWidth, iHeight);
+
+	for (int y = 0; y < iHeight; y++)
+	{
+		uint64_t *dst = &m_Bits[y * m_iWordsPerRow];
+
+		for (int x = 0; x < iWidth; x++)
+		{
+			dst[x >> 6] |= (uint64_t)1 << (x & 63);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Test ()
+// Desc : Value of a single pixel (0 outside the mask).
+//-----------------------------------------------------------------------------
+bool CCollisionMask::Test(int x, int y) const
+{
+	if (x < 0 || y < 0 || x >= m_iWidth || y >= m_iHeight)
+	{
+		return false;
+	}
+
+	return ((Row(y)[x >> 6] >> (x & 63)) & 1) != 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Bits () (Private)
+// Desc : Reads 64 consecutive bits of a row starting at any bit offset.
+//-----------------------------------------------------------------------------
+uint64_t CCollisionMask::Bits(const uint64_t *pRow, int iOffset) const
+{
+	if (iOffset < 0)
+	{
+		// only the start of the first word is inside the window
+		return pRow[0] << (-iOffset);
+	}
+
+	int k = iOffset >> 6;
+	int sh = iOffset & 63;
+
+	uint64_t lo = (k < m_iWordsPerRow) ? pRow[k] >> sh : 0;
+	uint64_t hi = (sh != 0 && k + 1 < m_iWordsPerRow) ? pRow[k + 1] << (64 - sh) : 0;
+
+	return lo | hi;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Overlaps ()
+// Desc : Only the rows and the words of this mask that fall inside the
+//		bounding box intersection are visited. The other mask's bits are
+//		shifted into line with this mask's words and ANDed 64 at a time.
+//-----------------------------------------------------------------------------
+bool CCollisionMask::Overlaps(const CCollisionMask& other, int dx, int dy) const
+{
+	if (IsEmpty() || other.IsEmpty())
+	{
+		return false;
+	}
+
+	// intersection in this mask's coordinates
+	int x0 = (dx > 0) ? dx : 0;
+	int y0 = (dy > 0) ? dy : 0;
+	int x1 = (dx + other.m_iWidth < m_iWidth) ? dx + other.m_iWidth : m_iWidth;
+	int y1 = (dy + other.m_iHeight < m_iHeight) ? dy + other.m_iHeight : m_iHeight;
+
+	if (x0 >= x1 || y0 >= y1)
+	{
+		return false;
+	}
+
+	int w0 = x0 >> 6;
+	int w1 = (x1 - 1) >> 6;
+
+	for (int y = y0; y < y1; y++)
+	{
+		const uint64_t *a = Row(y);
+		const uint64_t *b = other.Row(y - dy);
+
+		for (int w = w0; w <= w1; w++)
+		{
+			// bits of this mask outside the intersection meet either zero
+			// padding or bits shifted in from outside the other row (also 0)
+			if (a[w] & other.Bits(b, w * 64 - dx))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,616 @@
+//-----------------------------------------------------------------------------
+// File: ColorSpace.cpp
+//
+// Desc: Pixel <-> single channel row conversions.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CColorSpace Specific Includes
+//-----------------------------------------------------------------------------
+#include "ColorSpace.h"
+#include "CpuFeatures.h"
+#include <string.h>
+
+#if CPU_X86
+	#include <emmintrin.h>
+	#include <immintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Row kernels
+//-----------------------------------------------------------------------------
+typedef void (*ExtractRowFn)(uint8_t *d, const uint32_t *s, int n, CColorSpace::EChannel chn);
+typedef void (*PasteRowFn)(uint32_t *d, const uint8_t *s, int n, CColorSpace::EChannel chn);
+
+static const uint32_t TOP_BYTE = 0xFF000000;
+
+//-----------------------------------------------------------------------------
+// Red, green, blue (plain loops, the compilers vectorize them)
+//-----------------------------------------------------------------------------
+// Bit position of the channel byte in a pixel
+static int ByteShift(CColorSpace::EChannel chn)
+{
+	if (chn == CColorSpace::CHANNEL_RED)
+		return 16;
+	if (chn == CColorSpace::CHANNEL_GREEN)
+		return 8;
+	return 0;
+}
+
+static void ExtractByteRow(uint8_t *d, const uint32_t *s, int n, int iShift)
+{
+	for (int i = 0; i < n; i++)
+		d[i] = (uint8_t)(s[i] >> iShift);
+}
+
+static void PasteByteRow(uint32_t *d, const uint8_t *s, int n, int iShift)
+{
+	const uint32_t uKeep = ~((uint32_t)0xFF << iShift);
+
+	for (int i = 0; i < n; i++)
+		d[i] = (d[i] & uKeep) | ((uint32_t)s[i] << iShift);
+}
+
+// The SIMD kernels use the very same constants
+static const float ONE_THIRD	= 1.0f / 3.0f;
+static const float ONE_SIXTH	= 1.0f / 6.0f;
+static const float TWO_THIRDS	= 2.0f / 3.0f;
+
+//-----------------------------------------------------------------------------
+// Scalar reference
+//
+// r, g, b are in [0, 1], u / d are the largest / smallest of them. The three
+// are always multiples of 1 / 255, so u is one of them exactly and they can
+// be compared with ==.
+//-----------------------------------------------------------------------------
+static inline void Unpack_Scalar(uint32_t p, float& r, float& g, float& b, float& u, float& d)
+{
+	r = (float)((p >> 16) & 0xFF) / 255.0f;
+	g = (float)((p >> 8) & 0xFF) / 255.0f;
+	b = (float)(p & 0xFF) / 255.0f;
+
+	u = (r > g) ? r : g;
+	u = (b > u) ? b : u;
+	d = (r < g) ? r : g;
+	d = (b < d) ? b : d;
+}
+
+// Degrees in [0, 360)
+static inline float Hue_Scalar(float r, float g, float b, float u, float d)
+{
+	if (u == d)
+		return 0.0f;
+
+	float f = 1.0f / (u - d);
+
+	if (u == r)
+		f = f * ((g - b) * 60.0f);
+	else if (u == g)
+		f = f * ((b - r) * 60.0f) + 120.0f;
+	else
+		f = f * ((r - g) * 60.0f) + 240.0f;
+
+	// red is the largest with more blue than green
+	if (f < 0.0f)
+		f += 360.0f;
+
+	return f;
+}
+
+static inline float Saturation_Scalar(float u, float d)
+{
+	if (u == d)
+		return 0.0f;
+
+	float l = (u + d) * 0.5f;
+
+	return (l <= 0.5f) ? (u - d) / (u + d) : (u - d) / (2.0f - u - d);
+}
+
+static inline float Luminosity_Scalar(float u, float d)
+{
+	return (u + d) * 0.5f;
+}
+
+// One component of HSL -> RGB, t is the hue in turns shifted for it
+static inline float HueToChannel_Scalar(float p, float q, float t)
+{
+	if (t < 0.0f)
+		t += 1.0f;
+	if (t >= 1.0f)
+		t -= 1.0f;
+
+	if (t < ONE_SIXTH)
+		return p + (q - p) * 6.0f * t;
+	if (t < 0.5f)
+		return q;
+	if (t < TWO_THIRDS)
+		return p + (q - p) * (TWO_THIRDS - t) * 6.0f;
+
+	return p;
+}
+
+static inline uint32_t HslToRgb_Scalar(float h, float s, float l)
+{
+	float q = (l < 0.5f) ? l * (1.0f + s) : (l + s) - l * s;
+	float p = 2.0f * l - q;
+	float t = h / 360.0f;
+
+	uint32_t r = (uint32_t)(HueToChannel_Scalar(p, q, t + ONE_THIRD) * 255.0f + 0.5f);
+	uint32_t g = (uint32_t)(HueToChannel_Scalar(p, q, t) * 255.0f + 0.5f);
+	uint32_t b = (uint32_t)(HueToChannel_Scalar(p, q, t - ONE_THIRD) * 255.0f + 0.5f);
+
+	return (r << 16) | (g << 8) | b;
+}
+
+static void ExtractRow_Scalar(uint8_t *d, const uint32_t *s, int n, CColorSpace::EChannel chn)
+{
+	for (int i = 0; i < n; i++)
+	{
+		float r, g, b, u, m;
+		Unpack_Scalar(s[i], r, g, b, u, m);
+
+		switch (chn)
+		{
+		case CColorSpace::CHANNEL_HUE:			d[i] = (uint8_t)(Hue_Scalar(r, g, b, u, m) * 255.0f / 360.0f); break;
+		case CColorSpace::CHANNEL_SATURATION:	d[i] = (uint8_t)(Saturation_Scalar(u, m) * 255.0f); break;
+		default:								d[i] = (uint8_t)(Luminosity_Scalar(u, m) * 255.0f); break;
+		}
+	}
+}
+
+static void PasteRow_Scalar(uint32_t *d, const uint8_t *s, int n, CColorSpace::EChannel chn)
+{
+	for (int i = 0; i < n; i++)
+	{
+		float r, g, b, u, m;
+		Unpack_Scalar(d[i], r, g, b, u, m);
+
+		float h = Hue_Scalar(r, g, b, u, m);
+		float sat = Saturation_Scalar(u, m);
+		float l = Luminosity_Scalar(u, m);
+
+		switch (chn)
+		{
+		case CColorSpace::CHANNEL_HUE:			h = (float)s[i] * 360.0f / 255.0f; break;
+		case CColorSpace::CHANNEL_SATURATION:	sat = (float)s[i] / 255.0f; break;
+		default:								l = (float)s[i] / 255.0f; break;
+		}
+
+		d[i] = (d[i] & TOP_BYTE) | HslToRgb_Scalar(h, sat, l);
+	}
+}
+
+#if CPU_X86
+//-----------------------------------------------------------------------------
+// SSE2, 4 pixels per step
+//
+// Every branch of the reference is computed and the results are selected
+// with the comparison masks. The lanes that are thrown away may hold NaNs
+// (the grays divide by zero), they never reach the output.
+//-----------------------------------------------------------------------------
+// mask ? a : b
+static inline __m128 Select_SSE2(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline void Unpack_SSE2(__m128i px, __m128& r, __m128& g, __m128& b, __m128& u, __m128& d)
+{
+	const __m128i vByte	= _mm_set1_epi32(0xFF);
+	const __m128 v255	= _mm_set1_ps(255.0f);
+
+	r = _mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 16), vByte)), v255);
+	g = _mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 8), vByte)), v255);
+	b = _mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(px, vByte)), v255);
+
+	u = _mm_max_ps(b, _mm_max_ps(r, g));
+	d = _mm_min_ps(b, _mm_min_ps(r, g));
+}
+
+static inline __m128 Hue_SSE2(__m128 r, __m128 g, __m128 b, __m128 u, __m128 d)
+{
+	const __m128 v60	= _mm_set1_ps(60.0f);
+	const __m128 v120	= _mm_set1_ps(120.0f);
+	const __m128 v240	= _mm_set1_ps(240.0f);
+	const __m128 v360	= _mm_set1_ps(360.0f);
+
+	__m128 f = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sub_ps(u, d));
+
+	__m128 hr = _mm_mul_ps(f, _mm_mul_ps(_mm_sub_ps(g, b), v60));
+	__m128 hg = _mm_add_ps(_mm_mul_ps(f, _mm_mul_ps(_mm_sub_ps(b, r), v60)), v120);
+	__m128 hb = _mm_add_ps(_mm_mul_ps(f, _mm_mul_ps(_mm_sub_ps(r, g), v60)), v240);
+
+	// red wins over green, green over blue, as in the reference
+	__m128 h = Select_SSE2(_mm_cmpeq_ps(u, g), hg, hb);
+	h = Select_SSE2(_mm_cmpeq_ps(u, r), hr, h);
+	h = _mm_add_ps(h, _mm_and_ps(_mm_cmplt_ps(h, _mm_setzero_ps()), v360));
+
+	return _mm_andnot_ps(_mm_cmpeq_ps(u, d), h);
+}
+
+static inline __m128 Saturation_SSE2(__m128 u, __m128 d)
+{
+	const __m128 vHalf	= _mm_set1_ps(0.5f);
+	const __m128 vTwo	= _mm_set1_ps(2.0f);
+
+	__m128 sum = _mm_add_ps(u, d);
+	__m128 l = _mm_mul_ps(sum, vHalf);
+	__m128 den = Select_SSE2(_mm_cmple_ps(l, vHalf), sum, _mm_sub_ps(_mm_sub_ps(vTwo, u), d));
+
+	return _mm_andnot_ps(_mm_cmpeq_ps(u, d), _mm_div_ps(_mm_sub_ps(u, d), den));
+}
+
+static inline __m128 Luminosity_SSE2(__m128 u, __m128 d)
+{
+	return _mm_mul_ps(_mm_add_ps(u, d), _mm_set1_ps(0.5f));
+}
+
+static inline __m128i HueToChannel_SSE2(__m128 p, __m128 q, __m128 t)
+{
+	const __m128 vOne	= _mm_set1_ps(1.0f);
+	const __m128 vSix	= _mm_set1_ps(6.0f);
+
+	t = _mm_add_ps(t, _mm_and_ps(_mm_cmplt_ps(t, _mm_setzero_ps()), vOne));
+	t = _mm_sub_ps(t, _mm_and_ps(_mm_cmpge_ps(t, vOne), vOne));
+
+	__m128 rise = _mm_add_ps(p, _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(q, p), vSix), t));
+	__m128 fall = _mm_add_ps(p, _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(q, p), _mm_sub_ps(_mm_set1_ps(TWO_THIRDS), t)), vSix));
+
+	__m128 c = Select_SSE2(_mm_cmplt_ps(t, _mm_set1_ps(TWO_THIRDS)), fall, p);
+	c = Select_SSE2(_mm_cmplt_ps(t, _mm_set1_ps(0.5f)), q, c);
+	c = Select_SSE2(_mm_cmplt_ps(t, _mm_set1_ps(ONE_SIXTH)), rise, c);
+
+	return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+static inline __m128i HslToRgb_SSE2(__m128 h, __m128 s, __m128 l)
+{
+	const __m128 vOne	= _mm_set1_ps(1.0f);
+	const __m128 vThird	= _mm_set1_ps(ONE_THIRD);
+
+	__m128 q = Select_SSE2(_mm_cmplt_ps(l, _mm_set1_ps(0.5f)),
+						   _mm_mul_ps(l, _mm_add_ps(vOne, s)),
+						   _mm_sub_ps(_mm_add_ps(l, s), _mm_mul_ps(l, s)));
+	__m128 p = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(2.0f), l), q);
+	__m128 t = _mm_div_ps(h, _mm_set1_ps(360.0f));
+
+	__m128i r = HueToChannel_SSE2(p, q, _mm_add_ps(t, vThird));
+	__m128i g = HueToChannel_SSE2(p, q, t);
+	__m128i b = HueToChannel_SSE2(p, q, _mm_sub_ps(t, vThird));
+
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 16), _mm_slli_epi32(g, 8)), b);
+}
+
+static void ExtractRow_SSE2(uint8_t *d, const uint32_t *s, int n, CColorSpace::EChannel chn)
+{
+	const __m128 v255	= _mm_set1_ps(255.0f);
+	const __m128 v360	= _mm_set1_ps(360.0f);
+	int i = 0;
+
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 r, g, b, u, m, v;
+		Unpack_SSE2(_mm_loadu_si128((const __m128i*)(s + i)), r, g, b, u, m);
+
+		switch (chn)
+		{
+		case CColorSpace::CHANNEL_HUE:			v = _mm_div_ps(_mm_mul_ps(Hue_SSE2(r, g, b, u, m), v255), v360); break;
+		case CColorSpace::CHANNEL_SATURATION:	v = _mm_mul_ps(Saturation_SSE2(u, m), v255); break;
+		default:								v = _mm_mul_ps(Luminosity_SSE2(u, m), v255); break;
+		}
+
+		// 4 x 32 bit -> 4 bytes, the values are already in 0..255
+		__m128i vi = _mm_cvttps_epi32(v);
+		vi = _mm_packs_epi32(vi, vi);
+		vi = _mm_packus_epi16(vi, vi);
+
+		int iBytes = _mm_cvtsi128_si32(vi);
+		memcpy(d + i, &iBytes, 4);
+	}
+
+	ExtractRow_Scalar(d + i, s + i, n - i, chn);
+}
+
+static void PasteRow_SSE2(uint32_t *d, const uint8_t *s, int n, CColorSpace::EChannel chn)
+{
+	const __m128 v255	= _mm_set1_ps(255.0f);
+	const __m128 v360	= _mm_set1_ps(360.0f);
+	const __m128i vTop	= _mm_set1_epi32((int)TOP_BYTE);
+	int i = 0;
+
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128i px = _mm_loadu_si128((const __m128i*)(d + i));
+		__m128 r, g, b, u, m;
+		Unpack_SSE2(px, r, g, b, u, m);
+
+		__m128 h = Hue_SSE2(r, g, b, u, m);
+		__m128 sat = Saturation_SSE2(u, m);
+		__m128 l = Luminosity_SSE2(u, m);
+
+		// 4 bytes -> 4 x 32 bit
+		int iBytes;
+		memcpy(&iBytes, s + i, 4);
+		__m128i vi = _mm_cvtsi32_si128(iBytes);
+		vi = _mm_unpacklo_epi8(vi, _mm_setzero_si128());
+		vi = _mm_unpacklo_epi16(vi, _mm_setzero_si128());
+		__m128 v = _mm_cvtepi32_ps(vi);
+
+		switch (chn)
+		{
+		case CColorSpace::CHANNEL_HUE:			h = _mm_div_ps(_mm_mul_ps(v, v360), v255); break;
+		case CColorSpace::CHANNEL_SATURATION:	sat = _mm_div_ps(v, v255); break;
+		default:								l = _mm_div_ps(v, v255); break;
+		}
+
+		px = _mm_or_si128(_mm_and_si128(px, vTop), HslToRgb_SSE2(h, sat, l));
+		_mm_storeu_si128((__m128i*)(d + i), px);
+	}
+
+	PasteRow_Scalar(d + i, s + i, n - i, chn);
+}
+
+//-----------------------------------------------------------------------------
+// AVX2, 8 pixels per step (the SSE2 kernels on twice the lanes)
+//-----------------------------------------------------------------------------
+CPU_TARGET_AVX2 static inline void Unpack_AVX2(__m256i px, __m256& r, __m256& g, __m256& b, __m256& u, __m256& d)
+{
+	const __m256i vByte	= _mm256_set1_epi32(0xFF);
+	const __m256 v255	= _mm256_set1_ps(255.0f);
+
+	r = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(px, 16), vByte)), v255);
+	g = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(px, 8), vByte)), v255);
+	b = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_and_si256(px, vByte)), v255);
+
+	u = _mm256_max_ps(b, _mm256_max_ps(r, g));
+	d = _mm256_min_ps(b, _mm256_min_ps(r, g));
+}
+
+CPU_TARGET_AVX2 static inline __m256 Hue_AVX2(__m256 r, __m256 g, __m256 b, __m256 u, __m256 d)
+{
+	const __m256 v60	= _mm256_set1_ps(60.0f);
+	const __m256 v120	= _mm256_set1_ps(120.0f);
+	const __m256 v240	= _mm256_set1_ps(240.0f);
+	const __m256 v360	= _mm256_set1_ps(360.0f);
+
+	__m256 f = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sub_ps(u, d));
+
+	__m256 hr = _mm256_mul_ps(f, _mm256_mul_ps(_mm256_sub_ps(g, b), v60));
+	__m256 hg = _mm256_add_ps(_mm256_mul_ps(f, _mm256_mul_ps(_mm256_sub_ps(b, r), v60)), v120);
+	__m256 hb = _mm256_add_ps(_mm256_mul_ps(f, _mm256_mul_ps(_mm256_sub_ps(r, g), v60)), v240);
+
+	// red wins over green, green over blue, as in the reference
+	__m256 h = _mm256_blendv_ps(hb, hg, _mm256_cmp_ps(u, g, _CMP_EQ_OQ));
+	h = _mm256_blendv_ps(h, hr, _mm256_cmp_ps(u, r, _CMP_EQ_OQ));
+	h = _mm256_add_ps(h, _mm256_and_ps(_mm256_cmp_ps(h, _mm256_setzero_ps(), _CMP_LT_OQ), v360));
+
+	return _mm256_andnot_ps(_mm256_cmp_ps(u, d, _CMP_EQ_OQ), h);
+}
+
+CPU_TARGET_AVX2 static inline __m256 Saturation_AVX2(__m256 u, __m256 d)
+{
+	const __m256 vHalf	= _mm256_set1_ps(0.5f);
+	const __m256 vTwo	= _mm256_set1_ps(2.0f);
+
+	__m256 sum = _mm256_add_ps(u, d);
+	__m256 l = _mm256_mul_ps(sum, vHalf);
+	__m256 den = _mm256_blendv_ps(_mm256_sub_ps(_mm256_sub_ps(vTwo, u), d), sum, _mm256_cmp_ps(l, vHalf, _CMP_LE_OQ));
+
+	return _mm256_andnot_ps(_mm256_cmp_ps(u, d, _CMP_EQ_OQ), _mm256_div_ps(_mm256_sub_ps(u, d), den));
+}
+
+CPU_TARGET_AVX2 static inline __m256 Luminosity_AVX2(__m256 u, __m256 d)
+{
+	return _mm256_mul_ps(_mm256_add_ps(u, d), _mm256_set1_ps(0.5f));
+}
+
+CPU_TARGET_AVX2 static inline __m256i HueToChannel_AVX2(__m256 p, __m256 q, __m256 t)
+{
+	const __m256 vOne	= _mm256_set1_ps(1.0f);
+	const __m256 vSix	= _mm256_set1_ps(6.0f);
+
+	t = _mm256_add_ps(t, _mm256_and_ps(_mm256_cmp_ps(t, _mm256_setzero_ps(), _CMP_LT_OQ), vOne));
+	t = _mm256_sub_ps(t, _mm256_and_ps(_mm256_cmp_ps(t, vOne, _CMP_GE_OQ), vOne));
+
+	__m256 rise = _mm256_add_ps(p, _mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(q, p), vSix), t));
+	__m256 fall = _mm256_add_ps(p, _mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(q, p), _mm256_sub_ps(_mm256_set1_ps(TWO_THIRDS), t)), vSix));
+
+	__m256 c = _mm256_blendv_ps(p, fall, _mm256_cmp_ps(t, _mm256_set1_ps(TWO_THIRDS), _CMP_LT_OQ));
+	c = _mm256_blendv_ps(c, q, _mm256_cmp_ps(t, _mm256_set1_ps(0.5f), _CMP_LT_OQ));
+	c = _mm256_blendv_ps(c, rise, _mm256_cmp_ps(t, _mm256_set1_ps(ONE_SIXTH), _CMP_LT_OQ));
+
+	return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(c, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f)));
+}
+
+CPU_TARGET_AVX2 static inline __m256i HslToRgb_AVX2(__m256 h, __m256 s, __m256 l)
+{
+	const __m256 vOne	= _mm256_set1_ps(1.0f);
+	const __m256 vThird	= _mm256_set1_ps(ONE_THIRD);
+
+	__m256 q = _mm256_blendv_ps(_mm256_sub_ps(_mm256_add_ps(l, s), _mm256_mul_ps(l, s)),
+								_mm256_mul_ps(l, _mm256_add_ps(vOne, s)),
+								_mm256_cmp_ps(l, _mm256_set1_ps(0.5f), _CMP_LT_OQ));
+	__m256 p = _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(2.0f), l), q);
+	__m256 t = _mm256_div_ps(h, _mm256_set1_ps(360.0f));
+
+	__m256i r = HueToChannel_AVX2(p, q, _mm256_add_ps(t, vThird));
+	__m256i g = HueToChannel_AVX2(p, q, t);
+	__m256i b = HueToChannel_AVX2(p, q, _mm256_sub_ps(t, vThird));
+
+	return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(r, 16), _mm256_slli_epi32(g, 8)), b);
+}
+
+CPU_TARGET_AVX2 static void ExtractRow_AVX2(uint8_t *d, const uint32_t *s, int n, CColorSpace::EChannel chn)
+{
+	const __m256 v255	= _mm256_set1_ps(255.0f);
+	const __m256 v360	= _mm256_set1_ps(360.0f);
+	int i = 0;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256 r, g, b, u, m, v;
+		Unpack_AVX2(_mm256_loadu_si256((const __m256i*)(s + i)), r, g, b, u, m);
+
+		switch (chn)
+		{
+		case CColorSpace::CHANNEL_HUE:			v = _mm256_div_ps(_mm256_mul_ps(Hue_AVX2(r, g, b, u, m), v255), v360); break;
+		case CColorSpace::CHANNEL_SATURATION:	v = _mm256_mul_ps(Saturation_AVX2(u, m), v255); break;
+		default:								v = _mm256_mul_ps(Luminosity_AVX2(u, m), v255); break;
+		}
+
+		// 8 x 32 bit -> 8 bytes, the values are already in 0..255
+		__m256i vi = _mm256_cvttps_epi32(v);
+		__m128i vw = _mm_packs_epi32(_mm256_castsi256_si128(vi), _mm256_extracti128_si256(vi, 1));
+		_mm_storel_epi64((__m128i*)(d + i), _mm_packus_epi16(vw, vw));
+	}
+
+	ExtractRow_Scalar(d + i, s + i, n - i, chn);
+}
+
+CPU_TARGET_AVX2 static void PasteRow_AVX2(uint32_t *d, const uint8_t *s, int n, CColorSpace::EChannel chn)
+{
+	const __m256 v255	= _mm256_set1_ps(255.0f);
+	const __m256 v360	= _mm256_set1_ps(360.0f);
+	const __m256i vTop	= _mm256_set1_epi32((int)TOP_BYTE);
+	int i = 0;
+
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256i px = _mm256_loadu_si256((const __m256i*)(d + i));
+		__m256 r, g, b, u, m;
+		Unpack_AVX2(px, r, g, b, u, m);
+
+		__m256 h = Hue_AVX2(r, g, b, u, m);
+		__m256 sat = Saturation_AVX2(u, m);
+		__m256 l = Luminosity_AVX2(u, m);
+
+		__m256 v = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(s + i))));
+
+		switch (chn)
+		{
+		case CColorSpace::CHANNEL_HUE:			h = _mm256_div_ps(_mm256_mul_ps(v, v360), v255); break;
+		case CColorSpace::CHANNEL_SATURATION:	sat = _mm256_div_ps(v, v255); break;
+		default:								l = _mm256_div_ps(v, v255); break;
+		}
+
+		px = _mm256_or_si256(_mm256_and_si256(px, vTop), HslToRgb_AVX2(h, sat, l));
+		_mm256_storeu_si256((__m256i*)(d + i), px);
+	}
+
+	PasteRow_Scalar(d + i, s + i, n - i, chn);
+}
+#endif // CPU_X86
+
+//-----------------------------------------------------------------------------
+// Kernels of the selected path (chosen on first use)
+//-----------------------------------------------------------------------------
+static CColorSpace::EPath	s_ePath			= CColorSpace::PATH_SCALAR;
+static ExtractRowFn			s_pExtractRow	= ExtractRow_Scalar;
+static PasteRowFn			s_pPasteRow		= PasteRow_Scalar;
+
+//-----------------------------------------------------------------------------
+// Name : SelectPath () / EnsurePath () (Static, Local)
+// Desc : Points the kernels at a path / at the best one, once, on first use.
+//		The blits can start on several threads at once (the loader threads
+//		and the main thread): the local static makes the other first
+//		callers wait until the kernels are set.
+//-----------------------------------------------------------------------------
+static void SelectPath(CColorSpace::EPath path)
+{
+	s_pExtractRow	= ExtractRow_Scalar;
+	s_pPasteRow		= PasteRow_Scalar;
+
+#if CPU_X86
+	if (path == CColorSpace::PATH_SSE2)
+	{
+		s_pExtractRow	= ExtractRow_SSE2;
+		s_pPasteRow		= PasteRow_SSE2;
+	}
+	else if (path == CColorSpace::PATH_AVX2)
+	{
+		s_pExtractRow	= ExtractRow_AVX2;
+		s_pPasteRow		= PasteRow_AVX2;
+	}
+#endif
+
+	s_ePath		= path;
+}
+
+static void EnsurePath()
+{
+	static const bool s_bSelected = (SelectPath(CColorSpace::GetBestPath()), true);
+	(void)s_bSelected;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetBestPath () / GetPath ()
+// Desc : Widest kernel set the processor supports / the one in use.
+//-----------------------------------------------------------------------------
+CColorSpace::EPath CColorSpace::GetBestPath()
+{
+	if (CCpuFeatures::HasAVX2())
+		return PATH_AVX2;
+
+	if (CCpuFeatures::HasSSE2())
+		return PATH_SSE2;
+
+	return PATH_SCALAR;
+}
+
+CColorSpace::EPath CColorSpace::GetPath()
+{
+	EnsurePath();
+
+	return s_ePath;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetPath ()
+// Desc : Selects the kernels, never a path the processor can't run. Not
+//		meant to be called while other threads blit (tests and benchmarks).
+//-----------------------------------------------------------------------------
+void CColorSpace::SetPath(EPath path)
+{
+	EPath best = GetBestPath();
+
+	if (path > best)
+		path = best;
+
+	EnsurePath();
+	SelectPath(path);
+}
+
+//-----------------------------------------------------------------------------
+// Name : ExtractRow ()
+// Desc : One channel of a row of pixels.
+//-----------------------------------------------------------------------------
+void CColorSpace::ExtractRow(EChannel chn, uint8_t *pDst, const uint32_t *pSrc, int n)
+{
+	if (chn < CHANNEL_HUE)
+	{
+		ExtractByteRow(pDst, pSrc, n, ByteShift(chn));
+		return;
+	}
+
+	EnsurePath();
+
+	s_pExtractRow(pDst, pSrc, n, chn);
+}
+
+//-----------------------------------------------------------------------------
+// Name : PasteRow ()
+// Desc : Writes one channel into a row of pixels.
+//-----------------------------------------------------------------------------
+void CColorSpace::PasteRow(EChannel chn, uint32_t *pPixels, const uint8_t *pSrc, int n)
+{
+	if (chn < CHANNEL_HUE)
+	{
+		PasteByteRow(pPixels, pSrc, n, ByteShift(chn));
+		return;
+	}
+
+	EnsurePath();
+
+	s_pPasteRow(pPixels, pSrc, n, chn);
+}
@@ -0,0 +1,113 @@
+//-----------------------------------------------------------------------------
+// File: CpuFeatures.cpp
+//
+// Desc: Run time detection of the SIMD instruction sets.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CCpuFeatures Specific Includes
+//-----------------------------------------------------------------------------
+#include "CpuFeatures.h"
+
+#if CPU_X86
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+#if CPU_X86
+//-----------------------------------------------------------------------------
+// Name : CpuId () (Static, Local)
+// Desc : Registers eax, ebx, ecx, edx of the cpuid instruction.
+//-----------------------------------------------------------------------------
+static void CpuId(unsigned int regs[4], unsigned int leaf, unsigned int subleaf)
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuidex(info, (int)leaf, (int)subleaf);
+	for (int i = 0; i < 4; i++)
+		regs[i] = (unsigned int)info[i];
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Name : XCR0 () (Static, Local)
+// Desc : Register states the operating system saves on a context switch.
+//-----------------------------------------------------------------------------
+static unsigned long long XCR0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int lo, hi;
+	__asm__ __volatile__ ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+#endif // CPU_X86
+
+//-----------------------------------------------------------------------------
+// Name : Detect () (Private, Static)
+// Desc : Reads the feature bits. AVX2 also needs the OS to save the ymm
+//		registers (OSXSAVE set and XCR0 bits 1 and 2).
+//-----------------------------------------------------------------------------
+CCpuFeatures::Features CCpuFeatures::Detect()
+{
+	Features features = { false, false, false };
+
+#if CPU_X86
+	unsigned int regs[4];
+
+	CpuId(regs, 0, 0);
+	unsigned int uMaxLeaf = regs[0];
+
+	CpuId(regs, 1, 0);
+	features.bSSE2 = ((regs[3] >> 26) & 1) != 0;
+	features.bSSSE3 = ((regs[2] >> 9) & 1) != 0;
+
+	bool bOSXSave	= ((regs[2] >> 27) & 1) != 0;
+	bool bAVX		= ((regs[2] >> 28) & 1) != 0;
+
+	if (uMaxLeaf >= 7 && bOSXSave && bAVX && (XCR0() & 6) == 6)
+	{
+		CpuId(regs, 7, 0);
+		features.bAVX2 = ((regs[1] >> 5) & 1) != 0;
+	}
+#endif
+
+	return features;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Get () (Private, Static)
+// Desc : The initialization of a local static runs exactly once, the other
+//		threads calling meanwhile wait for it to finish.
+//-----------------------------------------------------------------------------
+const CCpuFeatures::Features& CCpuFeatures::Get()
+{
+	static const Features s_Features = Detect();
+	return s_Features;
+}
+
+//-----------------------------------------------------------------------------
+// Name : HasSSE2 () / HasSSSE3 () / HasAVX2 ()
+// Desc : Instruction set queries.
+//-----------------------------------------------------------------------------
+bool CCpuFeatures::HasSSE2()
+{
+	return Get().bSSE2;
+}
+
+bool CCpuFeatures::HasSSSE3()
+{
+	return Get().bSSSE3;
+}
+
+bool CCpuFeatures::HasAVX2()
+{
+	return Get().bAVX2;
+}
@@ -0,0 +1,224 @@
+//-----------------------------------------------------------------------------
+// File: DirtyRegion.cpp
+//
+// Desc: The parts of a frame that changed, on a grid of cells.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CDirtyRegion Specific Includes
+//-----------------------------------------------------------------------------
+#include "DirtyRegion.h"
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Name : CDirtyRegion () (Constructor)
+// Desc : CDirtyRegion Class Constructor
+//-----------------------------------------------------------------------------
+CDirtyRegion::CDirtyRegion(int iCellSize)
+{
+	m_iCellSize	= std::max(iCellSize, 1);
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+	m_nColumns	= 0;
+	m_nRows		= 0;
+	m_nMarked	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CDirtyRegion () (Destructor)
+// Desc : CDirtyRegion Class Destructor
+//-----------------------------------------------------------------------------
+CDirtyRegion::~CDirtyRegion()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Resize ()
+// Desc : Rebuilds the grid for the new frame size.
+//-----------------------------------------------------------------------------
+void CDirtyRegion::Resize(int iWidth, int iHeight)
+{
+	m_iWidth	= std::max(iWidth, 0);
+	m_iHeight	= std::max(iHeight, 0);
+	m_nColumns	= (m_iWidth + m_iCellSize - 1) / m_iCellSize;
+	m_nRows		= (m_iHeight + m_iCellSize - 1) / m_iCellSize;
+
+	m_Cells.assign(m_nColumns * m_nRows, 0);
+	m_nMarked = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Unmarks every cell.
+//-----------------------------------------------------------------------------
+void CDirtyRegion::Clear()
+{
+	if (m_nMarked > 0)
+		std::fill(m_Cells.begin(), m_Cells.end(), 0);
+
+	m_nMarked = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Mark ()
+// Desc : Marks every cell the rectangle touches.
+//-----------------------------------------------------------------------------
+void CDirtyRegion::Mark(int x, int y, int w, int h)
+{
+	int x0 = std::max(x, 0);
+	int y0 = std::max(y, 0);
+	int x1 = std::min(x + w, m_iWidth);
+	int y1 = std::min(y + h, m_iHeight);
+
+	if (x0 >= x1 || y0 >= y1)
+		return;
+
+	int c0 = x0 / m_iCellSize, c1 = (x1 - 1) / m_iCellSize;
+	int r0 = y0 / m_iCellSize, r1 = (y1 - 1) / m_iCellSize;
+
+	for (int r = r0; r <= r1; r++)
+	{
+		uint8_t *pRow = &m_Cells[r * m_nColumns];
+
+		for (int c = c0; c <= c1; c++)
+		{
+			m_nMarked += 1 - pRow[c];
+			pRow[c] = 1;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : MarkAll ()
+// Desc : The whole frame changed.
+//-----------------------------------------------------------------------------
+void CDirtyRegion::MarkAll()
+{
+	std::fill(m_Cells.begin(), m_Cells.end(), 1);
+	m_nMarked = (int)m_Cells.size();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Add ()
+// Desc : Union with a region of the same size (any other is ignored).
+//-----------------------------------------------------------------------------
+void CDirtyRegion::Add(const CDirtyRegion& other)
+{
+	if (other.m_Cells.size() != m_Cells.size() || other.m_nColumns != m_nColumns || other.IsEmpty())
+		return;
+
+	m_nMarked = 0;
+
+	for (std::size_t i = 0; i < m_Cells.size(); i++)
+	{
+		m_Cells[i] |= other.m_Cells[i];
+		m_nMarked += m_Cells[i];
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Swap ()
+// Desc : Exchanges the contents of two regions.
+//-----------------------------------------------------------------------------
+void CDirtyRegion::Swap(CDirtyRegion& other)
+{
+	std::swap(m_iCellSize, other.m_iCellSize);
+	std::swap(m_iWidth, other.m_iWidth);
+	std::swap(m_iHeight, other.m_iHeight);
+	std::swap(m_nColumns, other.m_nColumns);
+	std::swap(m_nRows, other.m_nRows);
+	std::swap(m_nMarked, other.m_nMarked);
+	m_Cells.swap(other.m_Cells);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Area ()
+// Desc : The cells of the last column / row may be cut by the frame edge.
+//-----------------------------------------------------------------------------
+size_t CDirtyRegion::Area() const
+{
+	if (m_nMarked == 0)
+		return 0;
+
+	size_t uArea = 0;
+
+	for (int r = 0; r < m_nRows; r++)
+	{
+		int h = std::min(m_iCellSize, m_iHeight - r * m_iCellSize);
+		const uint8_t *pRow = &m_Cells[r * m_nColumns];
+
+		for (int c = 0; c < m_nColumns; c++)
+		{
+			if (pRow[c])
+				uArea += (size_t)std::min(m_iCellSize, m_iWidth - c * m_iCellSize) * h;
+		}
+	}
+
+	return uArea;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetRects ()
+// Desc : The rectangles still growing are kept sorted by column, like the
+//		runs of a row, so each row is matched against them in one sweep: an
+//		open rectangle with the same run goes one row down, the others are
+//		finished.
+//-----------------------------------------------------------------------------
+void CDirtyRegion::GetRects(std::vector<FrameRect>& rects) const
+{
+	rects.clear();
+
+	if (m_nMarked == 0)
+		return;
+
+	struct Open { int c0, c1, r0; };
+	std::vector<Open> open, next;
+
+	// the rectangle of an open run whose last row of cells is r - 1
+	auto finish = [this, &rects](const Open& run, int r)
+	{
+		FrameRect rc;
+		rc.x = run.c0 * m_iCellSize;
+		rc.y = run.r0 * m_iCellSize;
+		rc.w = std::min(run.c1 * m_iCellSize, m_iWidth) - rc.x;
+		rc.h = std::min(r * m_iCellSize, m_iHeight) - rc.y;
+		rects.push_back(rc);
+	};
+
+	// one row past the last one finishes every rectangle
+	for (int r = 0; r <= m_nRows; r++)
+	{
+		const uint8_t *pRow = (r < m_nRows) ? &m_Cells[r * m_nColumns] : NULL;
+		int nColumns = (r < m_nRows) ? m_nColumns : 0;
+		std::size_t k = 0;
+
+		next.clear();
+
+		for (int c = 0; c < nColumns; )
+		{
+			if (!pRow[c])
+			{
+				c++;
+				continue;
+			}
+
+			Open run = { c, c, r };
+			while (run.c1 < nColumns && pRow[run.c1]) run.c1++;
+			c = run.c1;
+
+			// the open rectangles left of this run can't continue
+			for (; k < open.size() && open[k].c0 < run.c0; k++)
+				finish(open[k], r);
+
+			if (k < open.size() && open[k].c0 == run.c0 && open[k].c1 == run.c1)
+				run.r0 = open[k++].r0;
+
+			next.push_back(run);
+		}
+
+		for (; k < open.size(); k++)
+			finish(open[k], r);
+
+		open.swap(next);
+	}
+}
@@ -0,0 +1,231 @@
+//-----------------------------------------------------------------------------
+// File: EntityStore.cpp
+//
+// Desc: Structure of arrays storage for bullets and enemies.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CEntityStore Specific Includes
+//-----------------------------------------------------------------------------
+#include "EntityStore.h"
+
+//-----------------------------------------------------------------------------
+// Name : CEntityStore () (Constructor)
+// Desc : CEntityStore Class Constructor
+//-----------------------------------------------------------------------------
+CEntityStore::CEntityStore(int iCapacity)
+{
+	m_iCapacity		= iCapacity;
+
+	m_pPosX			= new float[m_iCapacity];
+	m_pPosY			= new float[m_iCapacity];
+	m_pVelX			= new float[m_iCapacity];
+	m_pVelY			= new float[m_iCapacity];
+	m_pPrevX		= new float[m_iCapacity];
+	m_pPrevY		= new float[m_iCapacity];
+	m_pFaction		= new unsigned char[m_iCapacity];
+	m_pFlags		= new unsigned char[m_iCapacity];
+	m_pCooldown		= new float[m_iCapacity];
+
+	m_pIdOfSlot		= new int[m_iCapacity];
+	m_pSlotOfId		= new int[m_iCapacity];
+	m_pGeneration	= new unsigned int[m_iCapacity];
+	m_pFreeIds		= new int[m_iCapacity];
+
+	for (int i = 0; i < m_iCapacity; i++)
+	{
+		m_pGeneration[i] = 0;
+	}
+
+	Clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CEntityStore () (Destructor)
+// Desc : CEntityStore Class Destructor
+//-----------------------------------------------------------------------------
+CEntityStore::~CEntityStore()
+{
+	delete[] m_pPosX;
+	delete[] m_pPosY;
+	delete[] m_pVelX;
+	delete[] m_pVelY;
+	delete[] m_pPrevX;
+	delete[] m_pPrevY;
+	delete[] m_pFaction;
+	delete[] m_pFlags;
+	delete[] m_pCooldown;
+
+	delete[] m_pIdOfSlot;
+	delete[] m_pSlotOfId;
+	delete[] m_pGeneration;
+	delete[] m_pFreeIds;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Removes all the entities. Outstanding handles become stale.
+//-----------------------------------------------------------------------------
+void CEntityStore::Clear()
+{
+	m_iCount = 0;
+	m_iHighWaterMark = 0;
+
+	// ids are popped from the top of the stack, so push them in reverse
+	// order to hand out the lowest ids first
+	m_iFreeCount = m_iCapacity;
+	for (int i = 0; i < m_iCapacity; i++)
+	{
+		m_pGeneration[i]++;
+		m_pSlotOfId[i] = -1;
+		m_pFreeIds[i] = m_iCapacity - 1 - i;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Appends an entity at the end of the arrays (O(1), no allocation).
+//-----------------------------------------------------------------------------
+EntityHandle CEntityStore::Create(float x, float y, float vx, float vy, unsigned char faction)
+{
+	EntityHandle h;
+
+	if (m_iFreeCount == 0)
+	{
+		// store is full
+		h.id = -1;
+		h.generation = 0;
+		return h;
+	}
+
+	int id = m_pFreeIds[--m_iFreeCount];
+	int slot = m_iCount++;
+
+	m_pIdOfSlot[slot]	= id;
+	m_pSlotOfId[id]		= slot;
+
+	m_pPosX[slot]		= x;
+	m_pPosY[slot]		= y;
+	m_pVelX[slot]		= vx;
+	m_pVelY[slot]		= vy;
+	m_pPrevX[slot]		= x;
+	m_pPrevY[slot]		= y;
+	m_pFaction[slot]	= faction;
+	m_pFlags[slot]		= 0;
+	m_pCooldown[slot]	= 0.0f;
+
+	if (m_iCount > m_iHighWaterMark)
+	{
+		m_iHighWaterMark = m_iCount;
+	}
+
+	h.id = id;
+	h.generation = m_pGeneration[id];
+	return h;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Destroy ()
+// Desc : Removes the entity referred by a handle (stale handles are ignored).
+//-----------------------------------------------------------------------------
+void CEntityStore::Destroy(EntityHandle h)
+{
+	int slot = SlotOf(h);
+
+	if (slot != -1)
+	{
+		DestroyAt(slot);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : DestroyAt ()
+// Desc : Removes the entity in a slot by moving the last entity into it, so
+//		the arrays stay densely packed.
+//-----------------------------------------------------------------------------
+void CEntityStore::DestroyAt(int iSlot)
+{
+	int id = m_pIdOfSlot[iSlot];
+	int last = m_iCount - 1;
+
+	if (iSlot != last)
+	{
+		m_pPosX[iSlot]		= m_pPosX[last];
+		m_pPosY[iSlot]		= m_pPosY[last];
+		m_pVelX[iSlot]		= m_pVelX[last];
+		m_pVelY[iSlot]		= m_pVelY[last];
+		m_pPrevX[iSlot]		= m_pPrevX[last];
+		m_pPrevY[iSlot]		= m_pPrevY[last];
+		m_pFaction[iSlot]	= m_pFaction[last];
+		m_pFlags[iSlot]		= m_pFlags[last];
+		m_pCooldown[iSlot]	= m_pCooldown[last];
+
+		m_pIdOfSlot[iSlot]	= m_pIdOfSlot[last];
+		m_pSlotOfId[m_pIdOfSlot[iSlot]] = iSlot;
+	}
+
+	// release the id, old handles to it become stale
+	m_pSlotOfId[id] = -1;
+	m_pGeneration[id]++;
+	m_pFreeIds[m_iFreeCount++] = id;
+
+	m_iCount--;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SlotOf ()
+// Desc : Current slot of the entity referred by a handle, -1 if stale.
+//-----------------------------------------------------------------------------
+int CEntityStore::SlotOf(EntityHandle h) const
+{
+	if (h.id < 0 || h.id >= m_iCapacity || m_pGeneration[h.id] != h.generation)
+	{
+		return -1;
+	}
+
+	return m_pSlotOfId[h.id];
+}
+
+//-----------------------------------------------------------------------------
+// Name : HandleAt ()
+// Desc : Handle of the entity currently stored in a slot.
+//-----------------------------------------------------------------------------
+EntityHandle CEntityStore::HandleAt(int iSlot) const
+{
+	EntityHandle h;
+	h.id = m_pIdOfSlot[iSlot];
+	h.generation = m_pGeneration[h.id];
+	return h;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Integrate ()
+// Desc : Moves every entity by its velocity. The loop only touches the four
+//		position / velocity arrays, so the compiler is free to vectorize it.
+//-----------------------------------------------------------------------------
+void CEntityStore::Integrate(float dt)
+{
+	float *px = m_pPosX;
+	float *py = m_pPosY;
+	const float *vx = m_pVelX;
+	const float *vy = m_pVelY;
+
+	for (int i = 0; i < m_iCount; i++)
+	{
+		px[i] += vx[i] * dt;
+		py[i] += vy[i] * dt;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : SavePositions ()
+// Desc : Remembers where every entity was before the tick moves it.
+//-----------------------------------------------------------------------------
+void CEntityStore::SavePositions()
+{
+	for (int i = 0; i < m_iCount; i++)
+	{
+		m_pPrevX[i] = m_pPosX[i];
+		m_pPrevY[i] = m_pPosY[i];
+	}
+}
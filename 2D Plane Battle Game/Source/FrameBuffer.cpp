@@ -0,0 +1,97 @@
+//-----------------------------------------------------------------------------
+// File: FrameBuffer.cpp
+//
+// Desc: CPU side 32 bit pixel surface.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CFrameBuffer Specific Includes
+//-----------------------------------------------------------------------------
+#include "FrameBuffer.h"
+
+//-----------------------------------------------------------------------------
+// Name : CFrameBuffer () (Constructor)
+// Desc : CFrameBuffer Class Constructor
+//-----------------------------------------------------------------------------
+CFrameBuffer::CFrameBuffer()
+{
+	m_pPixels	= 0;
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+	m_iPitch	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CFrameBuffer () (Destructor)
+// Desc : CFrameBuffer Class Destructor
+//-----------------------------------------------------------------------------
+CFrameBuffer::~CFrameBuffer()
+{
+	Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Allocates an owned, tightly packed surface cleared to black.
+//-----------------------------------------------------------------------------
+void CFrameBuffer::Create(int iWidth, int iHeight)
+{
+	Release();
+
+	if (iWidth <= 0 || iHeight <= 0)
+	{
+		return;
+	}
+
+	m_Storage.assign((std::size_t)iWidth * iHeight, 0);
+
+	m_pPixels	= &m_Storage[0];
+	m_iWidth	= iWidth;
+	m_iHeight	= iHeight;
+	m_iPitch	= iWidth;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Attach ()
+// Desc : Wraps external pixels, they must outlive the surface (or Release).
+//-----------------------------------------------------------------------------
+void CFrameBuffer::Attach(uint32_t *pPixels, int iWidth, int iHeight, int iPitch)
+{
+	Release();
+
+	m_pPixels	= pPixels;
+	m_iWidth	= iWidth;
+	m_iHeight	= iHeight;
+	m_iPitch	= iPitch;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees owned pixels or forgets attached ones.
+//-----------------------------------------------------------------------------
+void CFrameBuffer::Release()
+{
+	std::vector<uint32_t>().swap(m_Storage);
+
+	m_pPixels	= 0;
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+	m_iPitch	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Fill ()
+// Desc : Sets every pixel to the same color.
+//-----------------------------------------------------------------------------
+void CFrameBuffer::Fill(uint32_t uColor)
+{
+	for (int y = 0; y < m_iHeight; y++)
+	{
+		uint32_t *pRow = Row(y);
+
+		for (int x = 0; x < m_iWidth; x++)
+		{
+			pRow[x] = uColor;
+		}
+	}
+}
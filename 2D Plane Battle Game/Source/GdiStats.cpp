@@ -0,0 +1,24 @@
+//-----------------------------------------------------------------------------
+// File: GdiStats.cpp
+//
+// Desc: Counts the GDI objects (DCs, bitmaps) the game creates.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CGdiStats Specific Includes
+//-----------------------------------------------------------------------------
+#include "GdiStats.h"
+
+ULONG CGdiStats::s_ulTotal		= 0;
+ULONG CGdiStats::s_ulFrameStart	= 0;
+ULONG CGdiStats::s_ulLastFrame	= 0;
+
+//-----------------------------------------------------------------------------
+// Name : EndFrame ()
+// Desc : Closes the current frame's count.
+//-----------------------------------------------------------------------------
+void CGdiStats::EndFrame()
+{
+	s_ulLastFrame	= s_ulTotal - s_ulFrameStart;
+	s_ulFrameStart	= s_ulTotal;
+}
@@ -0,0 +1,195 @@
+//-----------------------------------------------------------------------------
+// File: ImageCache.cpp
+//
+// Desc: Process wide cache of the sprite images.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CImageCache Specific Includes
+//-----------------------------------------------------------------------------
+#include "ImageCache.h"
+#include <stdio.h>
+
+//-----------------------------------------------------------------------------
+// Name : CImageCache () (Constructor)
+// Desc : CImageCache Class Constructor
+//-----------------------------------------------------------------------------
+CImageCache::CImageCache()
+{
+	m_ulHits	= 0;
+	m_ulMisses	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CImageCache () (Destructor)
+// Desc : CImageCache Class Destructor
+//-----------------------------------------------------------------------------
+CImageCache::~CImageCache()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Shared () (Static)
+// Desc : Created on first use, lives until the program exits.
+//-----------------------------------------------------------------------------
+CImageCache& CImageCache::Shared()
+{
+	static CImageCache cache;
+	return cache;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetMasked ()
+// Desc : The key is both file names.
+//-----------------------------------------------------------------------------
+std::shared_ptr<const SpriteImage> CImageCache::GetMasked(const char *szImageFile, const char *szMaskFile, const LoadFn& load)
+{
+	std::string strKey = std::string(szImageFile) + "|mask:" + szMaskFile;
+
+	return Get(strKey, szImageFile, szMaskFile, 0, load);
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetColorKeyed ()
+// Desc : The key is the file name and the color.
+//-----------------------------------------------------------------------------
+std::shared_ptr<const SpriteImage> CImageCache::GetColorKeyed(const char *szImageFile, uint32_t uColorKey, const LoadFn& load)
+{
+	char szColor[16];
+	snprintf(szColor, sizeof(szColor), "%06X", (unsigned int)(uColorKey & 0x00FFFFFF));
+
+	std::string strKey = std::string(szImageFile) + "|key:" + szColor;
+
+	return Get(strKey, szImageFile, 0, uColorKey & 0x00FFFFFF, load);
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetStats ()
+// Desc : Only the images still alive are counted.
+//-----------------------------------------------------------------------------
+CImageCache::Stats CImageCache::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	Prune();
+
+	Stats stats;
+	stats.iEntries	= (int)m_Entries.size();
+	stats.uBytes	= 0;
+	stats.ulHits	= m_ulHits;
+	stats.ulMisses	= m_ulMisses;
+
+	for (std::map<std::string, Entry>::const_iterator it = m_Entries.begin(); it != m_Entries.end(); ++it)
+	{
+		stats.uBytes += it->second.uBytes;
+	}
+
+	return stats;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Get () (Private)
+// Desc : The files are loaded without holding the lock, other images can be
+//		served meanwhile.
+//-----------------------------------------------------------------------------
+std::shared_ptr<const SpriteImage> CImageCache::Get(const std::string& strKey, const char *szImageFile, const char *szMaskFile,
+													 uint32_t uColorKey, const LoadFn& load)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		std::shared_ptr<const SpriteImage> pImage = Find(strKey);
+
+		if (pImage)
+		{
+			m_ulHits++;
+			return pImage;
+		}
+
+		m_ulMisses++;
+	}
+
+	std::shared_ptr<SpriteImage> pImage = std::make_shared<SpriteImage>();
+	SpriteImage &img = *pImage;
+
+	if (!load(szImageFile, img.image))
+		return std::shared_ptr<const SpriteImage>();
+
+	if (szMaskFile != 0)
+	{
+		if (!load(szMaskFile, img.mask) || img.mask.Width() != img.image.Width() || img.mask.Height() != img.image.Height())
+			return std::shared_ptr<const SpriteImage>();
+
+		img.collision.BuildFromMask(img.mask.Pixels(), img.mask.Width(), img.mask.Height(), img.mask.Pitch());
+		img.rle.BuildFromMask(img.image, img.mask, 0, 0, img.image.Width(), img.image.Height());
+	}
+	else
+	{
+		img.uColorKey = uColorKey;
+		img.collision.BuildFromColorKey(img.image.Pixels(), img.image.Width(), img.image.Height(), img.image.Pitch(), uColorKey);
+		img.rle.BuildFromColorKey(img.image, 0, 0, img.image.Width(), img.image.Height(), uColorKey);
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	// another thread may have loaded the same image in the meantime
+	std::shared_ptr<const SpriteImage> pOther = Find(strKey);
+	if (pOther)
+		return pOther;
+
+	Prune();
+
+	Entry &entry = m_Entries[strKey];
+	entry.pImage = pImage;
+	entry.uBytes = MemorySize(img);
+
+	return pImage;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Find () (Private)
+// Desc : An entry whose image was freed counts as missing.
+//-----------------------------------------------------------------------------
+std::shared_ptr<const SpriteImage> CImageCache::Find(const std::string& strKey) const
+{
+	std::map<std::string, Entry>::const_iterator it = m_Entries.find(strKey);
+
+	if (it == m_Entries.end())
+		return std::shared_ptr<const SpriteImage>();
+
+	return it->second.pImage.lock();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Prune () (Private)
+// Desc : Drops the entries of the freed images.
+//-----------------------------------------------------------------------------
+void CImageCache::Prune() const
+{
+	std::map<std::string, Entry>::iterator it = m_Entries.begin();
+
+	while (it != m_Entries.end())
+	{
+		if (it->second.pImage.expired())
+			it = m_Entries.erase(it);
+		else
+			++it;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : MemorySize () (Private, Static)
+// Desc : Pixels of the image and mask plus the collision bits and the
+//		spans. Pixels attached from an asset pack belong to its mapping and
+//		are not counted.
+//-----------------------------------------------------------------------------
+size_t CImageCache::MemorySize(const SpriteImage& image)
+{
+	size_t uBytes = sizeof(SpriteImage);
+
+	uBytes += image.image.MemorySize();
+	uBytes += image.mask.MemorySize();
+	uBytes += image.collision.MemorySize();
+	uBytes += image.rle.MemorySize();
+
+	return uBytes;
+}
@@ -2,22 +2,44 @@
 // by Mihai Popescu
 // March 2009
 #include "ImageFile.h"
+#include "GdiStats.h"
+#include "BmpDecoder.h"
+#include "MappedFile.h"
+#include "ColorSpace.h"
 
 extern HINSTANCE g_hInst;
 
+// the channel as CColorSpace knows it, the exclusive ones are plain colors
+static CColorSpace::EChannel ToChannel(EColorChannel chn)
+{
+	switch(chn)
+	{
+	case ECC_RED:
+	case ECC_EXCLUSIVERED:		return CColorSpace::CHANNEL_RED;
+	case ECC_GREEN:
+	case ECC_EXCLUSIVEGREEN:	return CColorSpace::CHANNEL_GREEN;
+	case ECC_BLUE:
+	case ECC_EXCLUSIVEBLUE:		return CColorSpace::CHANNEL_BLUE;
+	case ECC_HUE:				return CColorSpace::CHANNEL_HUE;
+	case ECC_SATURATION:		return CColorSpace::CHANNEL_SATURATION;
+	default:					return CColorSpace::CHANNEL_LUMINOSITY;
+	}
+}
+
 
 CImageFile::CImageFile() : height(m_biInfo.biHeight), width(m_biInfo.biWidth)
 {
 	m_hBMP = 0;
+	m_hMemDC = 0;
+	m_hOldBMP = 0;
 	m_pRGB = NULL;
 	ZeroMemory(&m_biInfo, sizeof(BITMAPINFOHEADER));
+	m_lDirtyBegin = 0;
+	m_lDirtyEnd = 0;
 }
 
-bool CImageFile::LoadBitmapFromFile(const char *szFileName, HDC hdc)
+bool CImageFile::LoadBitmapFromFile(const char *szFileName, HDC hdc, const CAssetLoader *pAssets)
 {
-	BYTE *pData;
-	HDC mdc = CreateCompatibleDC(hdc);
-
 	strcpy_s(m_szFileName, MAX_PATH, szFileName);
 
 	// release previously loaded file data
@@ -27,14 +49,77 @@ bool CImageFile::LoadBitmapFromFile(const char *szFileName, HDC hdc)
 		m_pRGB = NULL;
 	}
 
-	if(m_hBMP)
+	ReleaseDeviceBitmap();
+
+	// The loader decoded the file already (or attached it from the asset
+	// pack), only the row order differs. The image owns its bottom-up rows,
+	// GDI and the resampler write them, so they are copied either way.
+	int iAsset = pAssets ? pAssets->Find(szFileName) : -1;
+
+	if(iAsset >= 0 && pAssets->IsFinished() && pAssets->Succeeded(iAsset))
 	{
-		DeleteObject(m_hBMP);
-		m_hBMP = 0;
+		const CFrameBuffer& pixels = pAssets->Pixels(iAsset);
+		int w = pixels.Width();
+		int h = pixels.Height();
+
+		m_pRGB = new RGBQUAD[w * h];
+
+		for(int y = 0; y < h; y++)
+			CopyMemory(m_pRGB + (h - 1 - y) * w, pixels.Row(y), w * sizeof(RGBQUAD));
+
+		SetPixelsInfo(w, h);
+
+		return true;
+	}
+
+	// The file is mapped and its rows converted straight into m_pRGB, the
+	// system loader is only used for the formats CBmpDecoder can't read.
+	CMappedFile file;
+	CBmpDecoder::BmpInfo info;
+
+	if(file.Open(szFileName) && CBmpDecoder::ReadInfo(file.Data(), file.Size(), info))
+	{
+		m_pRGB = new RGBQUAD[info.iWidth * info.iHeight];
+
+		// m_pRGB is bottom-up like the DIB it is uploaded to
+		if(CBmpDecoder::Decode(file.Data(), file.Size(), (uint32_t*)m_pRGB, info.iWidth, true))
+		{
+			SetPixelsInfo(info.iWidth, info.iHeight);
+
+			return true;
+		}
+
+		delete[] m_pRGB;
+		m_pRGB = NULL;
 	}
 
+	return LoadBitmapWithGdi(hdc);
+}
+
+void CImageFile::SetPixelsInfo(int w, int h)
+{
+	ZeroMemory(&m_biInfo, sizeof(BITMAPINFOHEADER));
+	m_biInfo.biSize = sizeof(BITMAPINFOHEADER);
+	m_biInfo.biWidth = w;
+	m_biInfo.biHeight = h;
+	m_biInfo.biPlanes = 1;
+	m_biInfo.biBitCount = 32;
+	m_biInfo.biCompression = BI_RGB;
+	m_biInfo.biSizeImage = w * h * sizeof(RGBQUAD);
+
+	// the new pixels have to be uploaded
+	MarkDirty();
+}
+
+bool CImageFile::LoadBitmapWithGdi(HDC hdc)
+{
+	BYTE *pData;
+	HDC mdc = CreateCompatibleDC(hdc);
+	CGdiStats::OnCreate();
+
 	// Loads the image.
-	m_hBMP = (HBITMAP)LoadImage(g_hInst, szFileName, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION | LR_LOADFROMFILE);	
+	m_hBMP = (HBITMAP)LoadImage(g_hInst, m_szFileName, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION | LR_LOADFROMFILE);	
+	CGdiStats::OnCreate();
 
 	if(!m_hBMP)
 		return false;
@@ -81,6 +166,9 @@ bool CImageFile::LoadBitmapFromFile(const char *szFileName, HDC hdc)
 
 	delete[] pData;
 
+	// the new pixels have to be uploaded
+	MarkDirty();
+
 	return true;
 }
 
@@ -94,18 +182,77 @@ void CImageFile::Paint(HDC hdc, int x, int y)
 	if(!m_pRGB)
 		return;
 
+	// the device bitmap and its DC are created once and then kept
 	if(!m_hBMP)
+	{
 		m_hBMP = CreateCompatibleBitmap(hdc, width, height);
+		m_hMemDC = CreateCompatibleDC(hdc);
+		CGdiStats::OnCreate(2);
 
-	HDC mdc = CreateCompatibleDC(hdc);
+		m_hOldBMP = SelectObject(m_hMemDC, m_hBMP);
 
-	SelectObject(mdc, m_hBMP);
+		MarkDirty();
+	}
 
-	SetDIBits(mdc, m_hBMP, 0, height, m_pRGB, (BITMAPINFO*)&m_biInfo, DIB_RGB_COLORS);
+	// upload only the rows changed since the last paint
+	if(IsDirty())
+	{
+		// the bitmap must not be selected in a DC while SetDIBits writes it
+		SelectObject(m_hMemDC, m_hOldBMP);
 
-	BitBlt(hdc, x, y, width, height, mdc, 0, 0, SRCCOPY);
+		// the DIB is bottom-up, so scan line i is row i of m_pRGB
+		SetDIBits(hdc, m_hBMP, m_lDirtyBegin, m_lDirtyEnd - m_lDirtyBegin, m_pRGB + m_lDirtyBegin * width,
+			(BITMAPINFO*)&m_biInfo, DIB_RGB_COLORS);
 
-	DeleteDC(mdc);
+		SelectObject(m_hMemDC, m_hBMP);
+
+		m_lDirtyBegin = 0;
+		m_lDirtyEnd = 0;
+	}
+
+	BitBlt(hdc, x, y, width, height, m_hMemDC, 0, 0, SRCCOPY);
+}
+
+void CImageFile::MarkDirty(const RECT* rc)
+{
+	LONG lBegin = rc? rc->top : 0;
+	LONG lEnd = rc? rc->bottom + 1 : height;
+
+	if(lBegin < 0)
+		lBegin = 0;
+	if(lEnd > height)
+		lEnd = height;
+	if(lBegin >= lEnd)
+		return;
+
+	// grow the dirty band to cover the new rows
+	if(!IsDirty())
+	{
+		m_lDirtyBegin = lBegin;
+		m_lDirtyEnd = lEnd;
+	}
+	else
+	{
+		m_lDirtyBegin = min(m_lDirtyBegin, lBegin);
+		m_lDirtyEnd = max(m_lDirtyEnd, lEnd);
+	}
+}
+
+void CImageFile::ReleaseDeviceBitmap()
+{
+	if(m_hMemDC)
+	{
+		SelectObject(m_hMemDC, m_hOldBMP);
+		DeleteDC(m_hMemDC);
+		m_hMemDC = 0;
+		m_hOldBMP = 0;
+	}
+
+	if(m_hBMP)
+	{
+		DeleteObject(m_hBMP);
+		m_hBMP = 0;
+	}
 }
 
 
@@ -114,185 +261,73 @@ CImageFile::~CImageFile(void)
 	if(m_pRGB)
 		delete[] m_pRGB;
 
-	DeleteObject(m_hBMP);
+	ReleaseDeviceBitmap();
+}
+
+void CImageFile::GetRegion(const RECT* rc, int& x, int& y, int& w, int& h) const
+{
+	x = rc? rc->left : 0;
+	y = rc? rc->top : 0;
+	w = rc? rc->right - rc->left + 1 : width;
+	h = rc? rc->bottom - rc->top + 1 : height;
 }
 
 BYTE* CImageFile::CopyMonoImage(EColorChannel chn, const RECT* rc)
 {
-	int imgHeight = rc? rc->bottom - rc->top + 1 : height;
-	int imgWidth = rc? rc->right - rc->left + 1 : width;
-	int x = rc? rc->left : 0;
-	int y = rc? rc->top : 0;
+	int x, y, imgWidth, imgHeight;
+	GetRegion(rc, x, y, imgWidth, imgHeight);
 
 	BYTE *img = new BYTE[imgHeight * imgWidth];
+	CopyMonoImage(chn, img, imgWidth, rc);
 
-	switch(chn)
-	{
+	return img;
+}
 
-	case ECC_RED:
-		for(int i=0;i<imgHeight;i++)
-			for(int j=0;j<imgWidth;j++)
-				img[i*imgWidth + j] = m_pRGB[(i+y)*width + j + x].rgbRed;
-		break;
+void CImageFile::CopyMonoImage(EColorChannel chn, BYTE *img, int pitch, const RECT* rc)
+{
+	MonoView view = { chn, img, pitch };
+	CopyMonoImages(&view, 1, rc);
+}
 
-	case ECC_GREEN:
-		for(int i=0;i<imgHeight;i++)
-			for(int j=0;j<imgWidth;j++)
-				img[i*imgWidth + j] = m_pRGB[(i+y)*width + j + x].rgbGreen;
-		break;
+void CImageFile::CopyMonoImages(const MonoView *views, int count, const RECT* rc)
+{
+	int x, y, imgWidth, imgHeight;
+	GetRegion(rc, x, y, imgWidth, imgHeight);
 
-	case ECC_BLUE:
-		for(int i=0;i<imgHeight;i++)
-			for(int j=0;j<imgWidth;j++)
-				img[i*imgWidth + j] = m_pRGB[(i+y)*width + j + x].rgbBlue;
-		break;
-
-	case ECC_HUE:
-		for(int i=0;i<imgHeight;i++)
-			for(int j=0;j<imgWidth;j++)
-			{
-				RGBQUAD &q = m_pRGB[(i+y)*width + j + x];
-				float r = q.rgbRed/255.0f;
-				float g = q.rgbGreen/255.0f;
-				float b = q.rgbBlue/255.0f;
-
-				float u = max(r, g);
-				u = max(b, u);
-				float d = min(r, g);
-				d = min(b, d);
-
-				BYTE v;
-
-				if(fabsf(u-d)<EPS)
-					v=0;
-				else
-				{
-					float f = 1/(u-d);
-
-					if(fabsf(u-r)<EPS)
-					{
-						f *= (g-b)*60.f;
-					}
-					else
-					if(fabsf(u-g)<EPS)
-					{
-						f *= (b-r)*60.f;
-						f += 120;
-					}
-					else
-					if(fabsf(u-b)<EPS)
-					{
-						f *= (r-g)*60.f;
-						f += 240;
-					}
-
-					v = (BYTE)(f*255.f/360.f);
-				}
-
-				img[i*imgWidth + j] = v;
-			}
-
-	case ECC_SATURATION:
-		for(int i=0;i<imgHeight;i++)
-			for(int j=0;j<imgWidth;j++)
-			{
-				RGBQUAD &q = m_pRGB[(i+y)*width + j + x];
-				float r = q.rgbRed/255.0f;
-				float g = q.rgbGreen/255.0f;
-				float b = q.rgbBlue/255.0f;
-
-				float u = max(r, g);
-				u = max(b, u);
-				float d = min(r, g);
-				d = min(b, d);
-
-				BYTE v;
-
-				if(fabsf(u-d)<EPS)
-					v=0;
-				else
-				{
-					float l = (u+d)/2;
-					float f = (u-d);
-
-					if(l<=0.5f)
-						f /= u+d;
-					else
-						f /= 2-u-d;
-
-					v = (BYTE)(f*255.f);
-				}
-
-				img[i*imgWidth + j] = v;
-			}
-		break;
-
-	case ECC_LUMINOSITY:
-		for(int i=0;i<imgHeight;i++)
-			for(int j=0;j<imgWidth;j++)
-			{
-				RGBQUAD &q = m_pRGB[(i+y)*width + j + x];
-				float r = q.rgbRed/255.0f;
-				float g = q.rgbGreen/255.0f;
-				float b = q.rgbBlue/255.0f;
-
-				float u = max(r, g);
-				u = max(b, u);
-				float d = min(r, g);
-				d = min(b, d);
-
-				BYTE v;
-
-				if(fabsf(u-d)<EPS)
-					v=0;
-				else
-				{
-					float f = (u+d)/2;
-					v = (BYTE)(f*255.f);
-				}
-
-				img[i*imgWidth + j] = v;
-			}
-		break;
-	}
+	// a row of pixels is read from memory once, the other channels find it
+	// in the cache
+	for(int i=0;i<imgHeight;i++)
+	{
+		const uint32_t *row = (const uint32_t*)&m_pRGB[(i+y)*width + x];
 
-	return img;
+		for(int k=0;k<count;k++)
+			CColorSpace::ExtractRow(ToChannel(views[k].chn), views[k].pBits + i*views[k].iPitch, row, imgWidth);
+	}
 }
 
 void CImageFile::PasteMonoImage(const BYTE *img, EColorChannel chn, const RECT* rc)
 {
-	int imgHeight = rc? rc->bottom - rc->top + 1 : height;
-	int imgWidth = rc? rc->right - rc->left + 1 : width;
-	int x = rc? rc->left : 0;
-	int y = rc? rc->top : 0;
+	int x, y, imgWidth, imgHeight;
+	GetRegion(rc, x, y, imgWidth, imgHeight);
 
-	if(chn >= ECC_EXCLUSIVERED)
-		Clear();
+	PasteMonoImage(img, imgWidth, chn, rc);
+}
 
-	switch(chn)
-	{
+void CImageFile::PasteMonoImage(const BYTE *img, int pitch, EColorChannel chn, const RECT* rc)
+{
+	int x, y, imgWidth, imgHeight;
+	GetRegion(rc, x, y, imgWidth, imgHeight);
 
-	case ECC_EXCLUSIVERED:
-	case ECC_RED:
-		for(int i=0;i<imgHeight;i++)
-			for(int j=0;j<imgWidth;j++)
-				m_pRGB[(i+y)*width + j + x].rgbRed = img[i*imgWidth + j];
-		break;
+	for(int i=0;i<imgHeight;i++)
+	{
+		RGBQUAD *row = &m_pRGB[(i+y)*width + x];
 
-	case ECC_EXCLUSIVEGREEN:
-	case ECC_GREEN:
-		for(int i=0;i<imgHeight;i++)
-			for(int j=0;j<imgWidth;j++)
-				m_pRGB[(i+y)*width + j + x].rgbGreen = img[i*imgWidth + j];
-		break;
+		// the exclusive channels leave the others black, inside rc only
+		if(chn >= ECC_EXCLUSIVERED)
+			ZeroMemory(row, imgWidth * sizeof(RGBQUAD));
 
-	case ECC_EXCLUSIVEBLUE:
-	case ECC_BLUE:
-		for(int i=0;i<imgHeight;i++)
-			for(int j=0;j<imgWidth;j++)
-				m_pRGB[(i+y)*width + j + x].rgbBlue = img[i*imgWidth + j];
-		break;
+		CColorSpace::PasteRow(ToChannel(chn), (uint32_t*)row, img + i*pitch, imgWidth);
 	}
 
+	MarkDirty(rc);
 }
-
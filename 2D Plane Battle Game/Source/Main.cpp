@@ -34,6 +34,9 @@ int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, LPTSTR lpCmdLi
 	// initialize global instance
 	g_hInst = hInstance;
 
+	// "-buildpack" only bakes the bitmaps into the asset pack
+	if ( lpCmdLine && _tcsstr( lpCmdLine, _T("-buildpack") ) ) return g_App.BuildAssetPack();
+
 	// Initialise the engine.
 	if (!g_App.InitInstance( lpCmdLine, iCmdShow )) return 1;
 	
@@ -0,0 +1,130 @@
+//-----------------------------------------------------------------------------
+// File: MappedFile.cpp
+//
+// Desc: Read only view of a whole file mapped into memory.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CMappedFile Specific Includes
+//-----------------------------------------------------------------------------
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Name : CMappedFile () (Constructor)
+// Desc : CMappedFile Class Constructor
+//-----------------------------------------------------------------------------
+CMappedFile::CMappedFile()
+{
+	m_pData		= 0;
+	m_uSize		= 0;
+	m_hFile		= 0;
+	m_hMapping	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CMappedFile () (Destructor)
+// Desc : CMappedFile Class Destructor
+//-----------------------------------------------------------------------------
+CMappedFile::~CMappedFile()
+{
+	Close();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Open ()
+// Desc : Maps the whole file read only.
+//-----------------------------------------------------------------------------
+bool CMappedFile::Open(const char *szFileName)
+{
+	Close();
+
+#if defined(_WIN32)
+	HANDLE hFile = CreateFileA(szFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+							   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(hFile, &size) || size.QuadPart == 0 || (unsigned long long)size.QuadPart > (size_t)-1)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (hMapping == NULL)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	const void *pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (pView == NULL)
+	{
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return false;
+	}
+
+	m_hFile		= hFile;
+	m_hMapping	= hMapping;
+	m_pData		= (const uint8_t*)pView;
+	m_uSize		= (size_t)size.QuadPart;
+#else
+	int fd = open(szFileName, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	void *pView = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// the mapping keeps its own reference to the file
+	close(fd);
+
+	if (pView == MAP_FAILED)
+		return false;
+
+	m_pData		= (const uint8_t*)pView;
+	m_uSize		= (size_t)st.st_size;
+#endif
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Close ()
+// Desc : Unmaps the file (nothing happens if it isn't open).
+//-----------------------------------------------------------------------------
+void CMappedFile::Close()
+{
+	if (m_pData == 0)
+		return;
+
+#if defined(_WIN32)
+	UnmapViewOfFile(m_pData);
+	CloseHandle((HANDLE)m_hMapping);
+	CloseHandle((HANDLE)m_hFile);
+#else
+	munmap((void*)m_pData, m_uSize);
+#endif
+
+	m_pData		= 0;
+	m_uSize		= 0;
+	m_hFile		= 0;
+	m_hMapping	= 0;
+}
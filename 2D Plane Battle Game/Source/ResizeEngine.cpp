@@ -1,8 +1,41 @@
 #include "ResizeEngine.h"
+#include "CpuFeatures.h"
+#include <typeinfo>
+
+#if CPU_X86
+	#include <emmintrin.h>
+	#include <immintrin.h>
+#endif
+
+// smallest amount of work handed to a thread of the pool
+#define ROWS_PER_TASK	8
+
+// Filter evaluations handed to CWeightsTable::BuildWeights
+template <class TFilter>
+struct DirectCall
+{
+	TFilter *pFilter;
+
+	DirectCall(TFilter *p) : pFilter(p) {}
+	// qualified, so not a virtual call
+	double operator()(double dVal) const { return pFilter->TFilter::Filter(dVal); }
+};
+
+struct VirtualCall
+{
+	CGenericFilter *pFilter;
+
+	VirtualCall(CGenericFilter *p) : pFilter(p) {}
+	double operator()(double dVal) const { return pFilter->Filter(dVal); }
+};
+
+struct Lanczos3LookupCall
+{
+	double operator()(double dVal) const { return CLanczos3Filter::FilterLookup(dVal); }
+};
 
 CWeightsTable::CWeightsTable(CGenericFilter *pFilter, DWORD uDstSize, DWORD uSrcSize) 
 {
-	DWORD u;
 	double dWidth;
 	double dFScale = 1.0;
 	double dFilterWidth = pFilter->GetWidth();
@@ -28,13 +61,34 @@ CWeightsTable::CWeightsTable(CGenericFilter *pFilter, DWORD uDstSize, DWORD uSrc
 	m_LineLength = uDstSize;
 	// allocate list of contributions
 	m_WeightTable = new sContribution[m_LineLength];
-	for(u = 0 ; u < m_LineLength ; u++) 
-	{
-		// allocate contributions for every pixel
-		m_WeightTable[u].Weights = new double[m_WindowSize];
-	}
+	// contributions of every pixel in one block, unused taps stay 0
+	m_Weights = new double[m_LineLength * m_WindowSize];
+	memset(m_Weights, 0, sizeof(double) * m_LineLength * m_WindowSize);
+
+	// evaluate the filter through a direct call for the filters of
+	// Filters.h, a derived or unknown class goes through the virtual call
+	const std::type_info &type = typeid(*pFilter);
+
+	if(type == typeid(CBoxFilter))
+		BuildWeights(DirectCall<CBoxFilter>((CBoxFilter*)pFilter), dScale, dFScale, dWidth, uSrcSize);
+	else if(type == typeid(CBilinearFilter))
+		BuildWeights(DirectCall<CBilinearFilter>((CBilinearFilter*)pFilter), dScale, dFScale, dWidth, uSrcSize);
+	else if(type == typeid(CBicubicFilter))
+		BuildWeights(DirectCall<CBicubicFilter>((CBicubicFilter*)pFilter), dScale, dFScale, dWidth, uSrcSize);
+	else if(type == typeid(CBSplineFilter))
+		BuildWeights(DirectCall<CBSplineFilter>((CBSplineFilter*)pFilter), dScale, dFScale, dWidth, uSrcSize);
+	else if(type == typeid(CLanczos3Filter) && dFilterWidth == 3)
+		BuildWeights(Lanczos3LookupCall(), dScale, dFScale, dWidth, uSrcSize);
+	else
+		BuildWeights(VirtualCall(pFilter), dScale, dFScale, dWidth, uSrcSize);
+
+	BuildFixedWeights();
+}
 
-	for(u = 0; u < m_LineLength; u++) 
+template <class TKernel>
+void CWeightsTable::BuildWeights(TKernel kernel, double dScale, double dFScale, double dWidth, DWORD uSrcSize)
+{
+	for(DWORD u = 0; u < m_LineLength; u++) 
 	{
 		// scan through line of contributions
 		double dCenter = (double)u / dScale;   // reverse mapping
@@ -58,13 +112,14 @@ CWeightsTable::CWeightsTable(CGenericFilter *pFilter, DWORD uDstSize, DWORD uSrc
 		m_WeightTable[u].Left = iLeft;
 		m_WeightTable[u].Right = iRight;
 
+		double *pWeights = &m_Weights[u * m_WindowSize];
 		int iSrc = 0;
 		double dTotalWeight = 0;  // zero sum of weights
 		for(iSrc = iLeft; iSrc <= iRight; iSrc++) 
 		{
 			// calculate weights
-			double weight = dFScale * pFilter->Filter(dFScale * (dCenter - (double)iSrc));
-			m_WeightTable[u].Weights[iSrc-iLeft] = weight;
+			double weight = dFScale * kernel(dFScale * (dCenter - (double)iSrc));
+			pWeights[iSrc-iLeft] = weight;
 			dTotalWeight += weight;
 		}
 
@@ -74,52 +129,525 @@ CWeightsTable::CWeightsTable(CGenericFilter *pFilter, DWORD uDstSize, DWORD uSrc
 			for(iSrc = iLeft; iSrc <= iRight; iSrc++)
 			{
 				// normalize point
-				m_WeightTable[u].Weights[iSrc-iLeft] /= dTotalWeight;
+				pWeights[iSrc-iLeft] /= dTotalWeight;
 			}
 		}
 	}
 }
 
-CWeightsTable::~CWeightsTable() 
+void CWeightsTable::BuildFixedWeights()
 {
-		for(DWORD u = 0; u < m_LineLength; u++) 
+	// unused taps at the end of a window stay 0
+	m_FixedWeights = new short[m_LineLength * m_WindowSize];
+	memset(m_FixedWeights, 0, sizeof(short) * m_LineLength * m_WindowSize);
+
+	for(DWORD u = 0; u < m_LineLength; u++) 
+	{
+		short *pFixed = &m_FixedWeights[u * m_WindowSize];
+		int nTaps = m_WeightTable[u].Right - m_WeightTable[u].Left + 1;
+		int iTotal = 0;
+		int iLargest = 0;
+
+		for(int i = 0; i < nTaps; i++)
 		{
-				// free contributions for every pixel
-				delete []m_WeightTable[u].Weights;
+			double dFixed = floor(getWeight(u, i) * RESIZE_FIXED_ONE + 0.5);
+			dFixed = max(-32768.0, min(32767.0, dFixed));
+
+			pFixed[i] = (short)dFixed;
+			iTotal += pFixed[i];
+
+			if(abs(pFixed[i]) > abs(pFixed[iLargest]))
+				iLargest = i;
 		}
 
+		// the rounding error goes to the largest weight, so a flat color
+		// stays exactly the same color
+		if(nTaps > 0 && iTotal != 0)
+			pFixed[iLargest] = (short)(pFixed[iLargest] + RESIZE_FIXED_ONE - iTotal);
+	}
+}
+
+CWeightsTable::~CWeightsTable() 
+{
 		// free list of pixels contributions
 		delete []m_WeightTable;
+		delete []m_Weights;
+		delete []m_FixedWeights;
 }
 
+size_t CWeightsTable::getMemorySize() const
+{
+	return sizeof(*this) + m_LineLength * (sizeof(sContribution) + m_WindowSize * (sizeof(double) + sizeof(short)));
+}
 
-void CResizableImage::ScaleRow(unsigned int dst_width, unsigned int /*dst_height*/, unsigned int row)
+
+CWeightsCache::CWeightsCache(size_t uBudget)
 {
-	RGBQUAD *pDstRow = &(m_pResImg[row * dst_width]);
-	RGBQUAD *pSrcRow = &(m_pRGB[row * width]);
+	m_uBudget = uBudget;
+	m_uMemory = 0;
+	m_ulHits = 0;
+	m_ulMisses = 0;
+}
+
+CWeightsCache &CWeightsCache::Shared()
+{
+	static CWeightsCache cache;
+	return cache;
+}
+
+CWeightsCache::sKey CWeightsCache::MakeKey(CGenericFilter *pFilter, DWORD uDstSize, DWORD uSrcSize)
+{
+	sKey key;
 
-	for (UINT x = 0; x < dst_width; x++) 
+	// the class tells the shape, the width and the parameters the rest
+	key.Filter = typeid(*pFilter).name();
+	key.Width = pFilter->GetWidth();
+	memset(key.Params, 0, sizeof(key.Params));
+	key.ParamCount = pFilter->GetParams(key.Params);
+	key.DstSize = uDstSize;
+	key.SrcSize = uSrcSize;
+
+	return key;
+}
+
+bool CWeightsCache::SameKey(const sKey &a, const sKey &b)
+{
+	if (a.DstSize != b.DstSize || a.SrcSize != b.SrcSize || a.Width != b.Width || a.ParamCount != b.ParamCount)
+		return false;
+
+	for (int i = 0; i < a.ParamCount; i++)
 	{
-		// Loop through row
-		BYTE r = 0;
-		BYTE g = 0;
-		BYTE b = 0;
-		int iLeft = m_pWeights->getLeftBoundary(x);	// Retrieve left boundries
-		int iRight = m_pWeights->getRightBoundary(x);  // Retrieve right boundries
-		for (int i = iLeft; i <= iRight; i++)
+		if (a.Params[i] != b.Params[i])
+			return false;
+	}
+
+	return a.Filter == b.Filter;
+}
+
+std::shared_ptr<const CWeightsTable> CWeightsCache::Find(const sKey &key)
+{
+	for (std::list<sEntry>::iterator it = m_Entries.begin(); it != m_Entries.end(); ++it)
+	{
+		if (SameKey(it->Key, key))
+		{
+			m_Entries.splice(m_Entries.begin(), m_Entries, it);
+			return m_Entries.front().Table;
+		}
+	}
+
+	return std::shared_ptr<const CWeightsTable>();
+}
+
+void CWeightsCache::Trim()
+{
+	while (m_uMemory > m_uBudget && !m_Entries.empty())
+	{
+		m_uMemory -= m_Entries.back().Table->getMemorySize();
+		m_Entries.pop_back();
+	}
+}
+
+std::shared_ptr<const CWeightsTable> CWeightsCache::Get(CGenericFilter *pFilter, DWORD uDstSize, DWORD uSrcSize)
+{
+	sKey key = MakeKey(pFilter, uDstSize, uSrcSize);
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		std::shared_ptr<const CWeightsTable> pTable = Find(key);
+
+		if (pTable)
+		{
+			m_ulHits++;
+			return pTable;
+		}
+
+		m_ulMisses++;
+	}
+
+	// built without holding the lock, other sizes can be served meanwhile
+	std::shared_ptr<const CWeightsTable> pTable(new CWeightsTable(pFilter, uDstSize, uSrcSize));
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	// another thread may have built the same table in the meantime
+	std::shared_ptr<const CWeightsTable> pOther = Find(key);
+	if (pOther)
+		return pOther;
+
+	sEntry entry;
+	entry.Key = key;
+	entry.Table = pTable;
+
+	m_Entries.push_front(entry);
+	m_uMemory += pTable->getMemorySize();
+	Trim();
+
+	return pTable;
+}
+
+void CWeightsCache::SetBudget(size_t uBudget)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	m_uBudget = uBudget;
+	Trim();
+}
+
+void CWeightsCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	m_Entries.clear();
+	m_uMemory = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// Row kernels
+//
+// The four channels of a pixel are filtered together with RESIZE_FIXED_BITS
+// fixed point weights, rounded, then clamped to 0..255.
+//
+// FilterLine (horizontal pass): dst[k] = sum of w(k)[j] * src[left(k) + j]
+// for the n destination pixels of a row.
+//
+// FilterRows (vertical pass): dst[x] = sum of w[j] * rows[j][x] for x in
+// [iBegin, n), a destination row from nTaps source rows. The rows are read
+// left to right, so every cache line loaded contributes to all its pixels
+// instead of one pixel per tap when walking down a column. The rows are
+// passed one by one so they can come from a ring buffer.
+//-----------------------------------------------------------------------------
+typedef void (*FilterLineFn)(RGBQUAD *pDst, const RGBQUAD *pSrc, int n, const CWeightsTable &table);
+typedef void (*FilterRowsFn)(RGBQUAD *pDst, const RGBQUAD *const *ppRows, int iBegin, int n, const short *w, int nTaps);
+
+static const int FIXED_HALF = RESIZE_FIXED_ONE / 2;
+
+static inline BYTE ClampFixed(int iValue)
+{
+	iValue >>= RESIZE_FIXED_BITS;
+	return (BYTE)(iValue < 0 ? 0 : (iValue > 255 ? 255 : iValue));
+}
+
+//-----------------------------------------------------------------------------
+// Scalar reference
+//-----------------------------------------------------------------------------
+static inline void StoreFixed_Scalar(RGBQUAD *pDst, int b, int g, int r, int a)
+{
+	pDst->rgbBlue		= ClampFixed(b);
+	pDst->rgbGreen		= ClampFixed(g);
+	pDst->rgbRed		= ClampFixed(r);
+	pDst->rgbReserved	= ClampFixed(a);
+}
+
+static void FilterLine_Scalar(RGBQUAD *pDst, const RGBQUAD *pSrc, int n, const CWeightsTable &table)
+{
+	for (int x = 0; x < n; x++)
+	{
+		int iLeft = table.getLeftBoundary(x);
+		int nTaps = table.getRightBoundary(x) - iLeft + 1;
+		const short *w = table.getFixedWeights(x);
+		const RGBQUAD *s = pSrc + iLeft;
+
+		int b = FIXED_HALF, g = FIXED_HALF, r = FIXED_HALF, a = FIXED_HALF;
+
+		for (int i = 0; i < nTaps; i++)
+		{
+			b += w[i] * s[i].rgbBlue;
+			g += w[i] * s[i].rgbGreen;
+			r += w[i] * s[i].rgbRed;
+			a += w[i] * s[i].rgbReserved;
+		}
+
+		StoreFixed_Scalar(pDst + x, b, g, r, a);
+	}
+}
+
+static void FilterRows_Scalar(RGBQUAD *pDst, const RGBQUAD *const *ppRows, int iBegin, int n, const short *w, int nTaps)
+{
+	for (int x = iBegin; x < n; x++)
+	{
+		int b = FIXED_HALF, g = FIXED_HALF, r = FIXED_HALF, a = FIXED_HALF;
+
+		for (int i = 0; i < nTaps; i++)
+		{
+			const RGBQUAD &s = ppRows[i][x];
+
+			b += w[i] * s.rgbBlue;
+			g += w[i] * s.rgbGreen;
+			r += w[i] * s.rgbRed;
+			a += w[i] * s.rgbReserved;
+		}
+
+		StoreFixed_Scalar(pDst + x, b, g, r, a);
+	}
+}
+
+#if CPU_X86
+//-----------------------------------------------------------------------------
+// SSE2. The channels of two taps are interleaved (b0 b1 g0 g1 r0 r1 a0 a1)
+// so pmaddwd adds both taps of every channel in one step.
+//-----------------------------------------------------------------------------
+static inline int PixelBits(const RGBQUAD *p)
+{
+	return *(const int*)p;
+}
+
+static inline int WeightPair(short w0, short w1)
+{
+	return (int)(((unsigned)(unsigned short)w1 << 16) | (unsigned short)w0);
+}
+
+static inline __m128i MaddTwoTaps(const RGBQUAD *s, const short *w)
+{
+	__m128i p = _mm_unpacklo_epi8(_mm_cvtsi32_si128(PixelBits(s)), _mm_cvtsi32_si128(PixelBits(s + 1)));
+	p = _mm_unpacklo_epi8(p, _mm_setzero_si128());
+
+	return _mm_madd_epi16(p, _mm_set1_epi32(WeightPair(w[0], w[1])));
+}
+
+static inline __m128i MaddOneTap(const RGBQUAD *s, const short *w)
+{
+	__m128i p = _mm_unpacklo_epi8(_mm_cvtsi32_si128(PixelBits(s)), _mm_setzero_si128());
+	p = _mm_unpacklo_epi16(p, _mm_setzero_si128());
+
+	return _mm_madd_epi16(p, _mm_set1_epi32(WeightPair(w[0], 0)));
+}
+
+static inline void StoreFixed(RGBQUAD *pDst, __m128i acc)
+{
+	acc = _mm_srai_epi32(acc, RESIZE_FIXED_BITS);
+	acc = _mm_packs_epi32(acc, acc);
+	acc = _mm_packus_epi16(acc, acc);
+
+	*(int*)pDst = _mm_cvtsi128_si32(acc);
+}
+
+static void FilterLine_SSE2(RGBQUAD *pDst, const RGBQUAD *pSrc, int n, const CWeightsTable &table)
+{
+	const __m128i vHalf = _mm_set1_epi32(FIXED_HALF);
+
+	for (int x = 0; x < n; x++)
+	{
+		int iLeft = table.getLeftBoundary(x);
+		int nTaps = table.getRightBoundary(x) - iLeft + 1;
+		const short *w = table.getFixedWeights(x);
+		const RGBQUAD *s = pSrc + iLeft;
+
+		__m128i acc = vHalf;
+		int i = 0;
+
+		for (; i + 2 <= nTaps; i += 2)
+			acc = _mm_add_epi32(acc, MaddTwoTaps(s + i, w + i));
+
+		if (i < nTaps)
+			acc = _mm_add_epi32(acc, MaddOneTap(s + i, w + i));
+
+		StoreFixed(pDst + x, acc);
+	}
+}
+
+// four pixels per step, one accumulator per pixel
+static void FilterRows_SSE2(RGBQUAD *pDst, const RGBQUAD *const *ppRows, int iBegin, int n, const short *w, int nTaps)
+{
+	const __m128i vZero = _mm_setzero_si128();
+	const __m128i vHalf = _mm_set1_epi32(FIXED_HALF);
+	int x = iBegin;
+
+	for (; x + 4 <= n; x += 4)
+	{
+		__m128i acc0 = vHalf, acc1 = vHalf, acc2 = vHalf, acc3 = vHalf;
+
+		for (int i = 0; i < nTaps; i += 2)
 		{
-			// Scan between boundries
-			// Accumulate weighted effect of each neighboring pixel
-			r += (BYTE)(m_pWeights->getWeight(x, i-iLeft) * (double)(pSrcRow[i].rgbRed)); 
-			g += (BYTE)(m_pWeights->getWeight(x, i-iLeft) * (double)(pSrcRow[i].rgbGreen)); 
-			b += (BYTE)(m_pWeights->getWeight(x, i-iLeft) * (double)(pSrcRow[i].rgbBlue)); 
-		} 
-		// set destination row
-		pDstRow[x].rgbRed = r;
-		pDstRow[x].rgbGreen = g;
-		pDstRow[x].rgbBlue = b;
-		pDstRow[x].rgbReserved = 0;
+			// an odd tap count pairs the last row with a zero weight
+			bool bPair = (i + 1 < nTaps);
+
+			__m128i a = _mm_loadu_si128((const __m128i*)(ppRows[i] + x));
+			__m128i b = bPair ? _mm_loadu_si128((const __m128i*)(ppRows[i + 1] + x)) : vZero;
+			__m128i vw = _mm_set1_epi32(WeightPair(w[i], bPair ? w[i + 1] : 0));
+
+			__m128i lo = _mm_unpacklo_epi8(a, b);	// pixels 0, 1
+			__m128i hi = _mm_unpackhi_epi8(a, b);	// pixels 2, 3
+
+			acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, vZero), vw));
+			acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, vZero), vw));
+			acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, vZero), vw));
+			acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, vZero), vw));
+		}
+
+		__m128i p01 = _mm_packs_epi32(_mm_srai_epi32(acc0, RESIZE_FIXED_BITS), _mm_srai_epi32(acc1, RESIZE_FIXED_BITS));
+		__m128i p23 = _mm_packs_epi32(_mm_srai_epi32(acc2, RESIZE_FIXED_BITS), _mm_srai_epi32(acc3, RESIZE_FIXED_BITS));
+
+		_mm_storeu_si128((__m128i*)(pDst + x), _mm_packus_epi16(p01, p23));
+	}
+
+	FilterRows_Scalar(pDst, ppRows, x, n, w, nTaps);
+}
+
+//-----------------------------------------------------------------------------
+// AVX2. Four taps per step for the lines (two in every 128 bit lane),
+// eight pixels per step for the rows.
+//-----------------------------------------------------------------------------
+CPU_TARGET_AVX2 static void FilterLine_AVX2(RGBQUAD *pDst, const RGBQUAD *pSrc, int n, const CWeightsTable &table)
+{
+	// b0 g0 r0 a0 b1 g1 r1 a1 -> b0 b1 g0 g1 r0 r1 a0 a1 in each lane
+	const __m256i vPairs = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15,
+											0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+	const __m256i vSpread = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+	const __m128i vHalf = _mm_set1_epi32(FIXED_HALF);
+
+	for (int x = 0; x < n; x++)
+	{
+		int iLeft = table.getLeftBoundary(x);
+		int nTaps = table.getRightBoundary(x) - iLeft + 1;
+		const short *w = table.getFixedWeights(x);
+		const RGBQUAD *s = pSrc + iLeft;
+
+		__m256i acc8 = _mm256_setzero_si256();
+		int i = 0;
+
+		for (; i + 4 <= nTaps; i += 4)
+		{
+			// w0 w1 in every pair of the low lane, w2 w3 in the high lane
+			__m256i vw = _mm256_castsi128_si256(_mm_loadl_epi64((const __m128i*)(w + i)));
+			vw = _mm256_permutevar8x32_epi32(vw, vSpread);
+
+			__m256i p = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(s + i)));
+			p = _mm256_shuffle_epi8(p, vPairs);
+
+			acc8 = _mm256_add_epi32(acc8, _mm256_madd_epi16(p, vw));
+		}
+
+		__m128i acc = _mm_add_epi32(vHalf, _mm_add_epi32(_mm256_castsi256_si128(acc8), _mm256_extracti128_si256(acc8, 1)));
+
+		for (; i + 2 <= nTaps; i += 2)
+			acc = _mm_add_epi32(acc, MaddTwoTaps(s + i, w + i));
+
+		if (i < nTaps)
+			acc = _mm_add_epi32(acc, MaddOneTap(s + i, w + i));
+
+		StoreFixed(pDst + x, acc);
+	}
+}
+
+CPU_TARGET_AVX2 static void FilterRows_AVX2(RGBQUAD *pDst, const RGBQUAD *const *ppRows, int iBegin, int n, const short *w, int nTaps)
+{
+	const __m256i vZero = _mm256_setzero_si256();
+	const __m256i vHalf = _mm256_set1_epi32(FIXED_HALF);
+	int x = iBegin;
+
+	for (; x + 8 <= n; x += 8)
+	{
+		__m256i acc0 = vHalf, acc1 = vHalf, acc2 = vHalf, acc3 = vHalf;
+
+		for (int i = 0; i < nTaps; i += 2)
+		{
+			bool bPair = (i + 1 < nTaps);
+
+			__m256i a = _mm256_loadu_si256((const __m256i*)(ppRows[i] + x));
+			__m256i b = bPair ? _mm256_loadu_si256((const __m256i*)(ppRows[i + 1] + x)) : vZero;
+			__m256i vw = _mm256_set1_epi32(WeightPair(w[i], bPair ? w[i + 1] : 0));
+
+			__m256i lo = _mm256_unpacklo_epi8(a, b);	// pixels 0, 1 | 4, 5
+			__m256i hi = _mm256_unpackhi_epi8(a, b);	// pixels 2, 3 | 6, 7
+
+			acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, vZero), vw));
+			acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, vZero), vw));
+			acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, vZero), vw));
+			acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, vZero), vw));
+		}
+
+		// the packs work per lane, which puts the pixels back in order
+		__m256i p01 = _mm256_packs_epi32(_mm256_srai_epi32(acc0, RESIZE_FIXED_BITS), _mm256_srai_epi32(acc1, RESIZE_FIXED_BITS));
+		__m256i p23 = _mm256_packs_epi32(_mm256_srai_epi32(acc2, RESIZE_FIXED_BITS), _mm256_srai_epi32(acc3, RESIZE_FIXED_BITS));
+
+		_mm256_storeu_si256((__m256i*)(pDst + x), _mm256_packus_epi16(p01, p23));
+	}
+
+	FilterRows_SSE2(pDst, ppRows, x, n, w, nTaps);
+}
+#endif // CPU_X86
+
+//-----------------------------------------------------------------------------
+// Kernels of the selected path (chosen on first use)
+//-----------------------------------------------------------------------------
+static CResizableImage::EKernel			s_eKernel		= CResizableImage::KERNEL_SCALAR;
+static FilterLineFn						s_pFilterLine	= FilterLine_Scalar;
+static FilterRowsFn						s_pFilterRows	= FilterRows_Scalar;
+
+static void SelectKernel(CResizableImage::EKernel kernel)
+{
+	s_pFilterLine = FilterLine_Scalar;
+	s_pFilterRows = FilterRows_Scalar;
+
+#if CPU_X86
+	if (kernel == CResizableImage::KERNEL_SSE2)
+	{
+		s_pFilterLine = FilterLine_SSE2;
+		s_pFilterRows = FilterRows_SSE2;
 	}
+	else if (kernel == CResizableImage::KERNEL_AVX2)
+	{
+		s_pFilterLine = FilterLine_AVX2;
+		s_pFilterRows = FilterRows_AVX2;
+	}
+#endif
+
+	s_eKernel = kernel;
+}
+
+// The pool threads can be the first to resample: the local static selects
+// the kernels once and makes the other first callers wait for it
+static void EnsureKernel()
+{
+	static const bool s_bSelected = (SelectKernel(CResizableImage::GetBestKernel()), true);
+	(void)s_bSelected;
+}
+
+CResizableImage::EKernel CResizableImage::GetBestKernel()
+{
+	if (CCpuFeatures::HasAVX2())
+		return KERNEL_AVX2;
+
+	if (CCpuFeatures::HasSSE2())
+		return KERNEL_SSE2;
+
+	return KERNEL_SCALAR;
+}
+
+CResizableImage::EKernel CResizableImage::GetKernel()
+{
+	EnsureKernel();
+
+	return s_eKernel;
+}
+
+// Not meant to be called while images are resampled
+void CResizableImage::SetKernel(EKernel kernel)
+{
+	EKernel best = GetBestKernel();
+
+	if (kernel > best)
+		kernel = best;
+
+	EnsureKernel();
+	SelectKernel(kernel);
+}
+
+std::shared_ptr<const CWeightsTable> CResizableImage::GetWeights(DWORD uDstSize, DWORD uSrcSize)
+{
+	if (m_pCache)
+		return m_pCache->Get(m_pFilter, uDstSize, uSrcSize);
+
+	return std::shared_ptr<const CWeightsTable>(new CWeightsTable(m_pFilter, uDstSize, uSrcSize));
+}
+
+void CResizableImage::ScaleRow(unsigned int dst_width, unsigned int /*dst_height*/, unsigned int row)
+{
+	RGBQUAD *pDstRow = &(m_pResImg[row * dst_width]);
+	RGBQUAD *pSrcRow = &(m_pRGB[row * width]);
+
+	s_pFilterLine(pDstRow, pSrcRow, dst_width, *m_pWeights);
 }
 
 void CResizableImage::HorizontalFilter(unsigned int dst_width, unsigned int dst_height)
@@ -131,43 +659,38 @@ void CResizableImage::HorizontalFilter(unsigned int dst_width, unsigned int dst_
 		memcpy (m_pResImg, m_pRGB, sizeof(RGBQUAD) * width * height);
 	}
 	
-	m_pWeights = new CWeightsTable(m_pFilter, dst_width, width);
+	std::shared_ptr<const CWeightsTable> pWeights = GetWeights(dst_width, width);
+	m_pWeights = pWeights.get();
 
-	for (UINT u = 0; u < dst_height; u++)
+	// every row only reads its own source row, the rows are split between threads
+	auto scaleRows = [&](int begin, int end)
 	{
-		// scale each row
-		ScaleRow (dst_width, dst_width, u);	// Scale each row 
-	}
+		for (int u = begin; u < end; u++)
+		{
+			// scale each row
+			ScaleRow (dst_width, dst_width, u);	// Scale each row 
+		}
+	};
 
-	delete m_pWeights;
+	if (m_pPool)
+		m_pPool->ParallelFor(dst_height, ROWS_PER_TASK, scaleRows);
+	else
+		scaleRows(0, dst_height);
+
+	m_pWeights = NULL;
 }
 
-void CResizableImage::ScaleCol(unsigned int dst_width, unsigned int dst_height, unsigned int col)
+void CResizableImage::ScaleCols(unsigned int dst_width, unsigned int row)
 { 
-	for (UINT y = 0; y < dst_height; y++) 
-	{
-		// Loop through column
-		BYTE r = 0;
-		BYTE g = 0;
-		BYTE b = 0;
-		int iLeft = m_pWeights->getLeftBoundary(y);	// Retrieve left boundries
-		int iRight = m_pWeights->getRightBoundary(y);  // Retrieve right boundries
-		for (int i = iLeft; i <= iRight; i++)
-		{
-			// Scan between boundries
-			// Accumulate weighted effect of each neighboring pixel
-			RGBQUAD &src = m_pRGB[i * width + col];
-			r += (BYTE)(m_pWeights->getWeight(y, i-iLeft) * (double)(src.rgbRed));
-			g += (BYTE)(m_pWeights->getWeight(y, i-iLeft) * (double)(src.rgbGreen));
-			b += (BYTE)(m_pWeights->getWeight(y, i-iLeft) * (double)(src.rgbBlue));
-		}
+	// every column of a destination row at once, from whole source rows
+	int iLeft = m_pWeights->getLeftBoundary(row);
+	int nTaps = m_pWeights->getRightBoundary(row) - iLeft + 1;
 
-		RGBQUAD &dst = m_pResImg[y * dst_width + col];
-		dst.rgbRed = r;
-		dst.rgbGreen = g;
-		dst.rgbBlue = b;
-		dst.rgbReserved = 0;
-	}
+	std::vector<const RGBQUAD*> rows(nTaps);
+	for (int i = 0; i < nTaps; i++)
+		rows[i] = &m_pRGB[(iLeft + i) * width];
+
+	s_pFilterRows(&m_pResImg[row * dst_width], &rows[0], 0, dst_width, m_pWeights->getFixedWeights(row), nTaps);
 }
 
 
@@ -179,19 +702,32 @@ void CResizableImage::VerticalFilter(unsigned int dst_width, unsigned int dst_he
 		memcpy(m_pResImg, m_pRGB, sizeof (RGBQUAD) * width * height);
 	}
 	
-	m_pWeights = new CWeightsTable(m_pFilter, dst_height, height);
+	std::shared_ptr<const CWeightsTable> pWeights = GetWeights(dst_height, height);
+	m_pWeights = pWeights.get();
 
-	for (UINT u = 0; u < dst_width; u++)
+	// the destination rows are computed independently, split between threads
+	auto scaleCols = [&](int begin, int end)
 	{
-		// Step through columns
-		ScaleCol(dst_width, dst_height, u);   // Scale each column
-	}
+		for (int u = begin; u < end; u++)
+		{
+			// all the columns of a row
+			ScaleCols(dst_width, u);
+		}
+	};
+
+	if (m_pPool)
+		m_pPool->ParallelFor(dst_height, ROWS_PER_TASK, scaleCols);
+	else
+		scaleCols(0, dst_height);
 
-	delete m_pWeights;
+	m_pWeights = NULL;
 }
 
 void CResizableImage::Resample(unsigned dst_width, unsigned dst_height)
 {
+	// pick the kernel before the passes start on several threads
+	EnsureKernel();
+
 	// decide which filtering order (xy or yx) is faster for this mapping
 	if(dst_width * height <= dst_height * width) 
 	{
@@ -199,7 +735,7 @@ void CResizableImage::Resample(unsigned dst_width, unsigned dst_height)
 
 		HorizontalFilter(dst_width, height);
 		
-		delete m_pRGB;
+		delete []m_pRGB;
 		m_pRGB = m_pResImg;
 		width = dst_width;
 		m_pResImg = new RGBQUAD[dst_width * dst_height];
@@ -211,7 +747,7 @@ void CResizableImage::Resample(unsigned dst_width, unsigned dst_height)
 		m_pResImg = new RGBQUAD[width * dst_height];
 		VerticalFilter(width, dst_height);
 		
-		delete m_pRGB;
+		delete []m_pRGB;
 		m_pRGB = m_pResImg;
 		height = dst_height;
 		m_pResImg = new RGBQUAD[dst_width * dst_height];
@@ -219,11 +755,46 @@ void CResizableImage::Resample(unsigned dst_width, unsigned dst_height)
 		HorizontalFilter(dst_width, dst_height);
 	}
 
-	delete m_pRGB;
+	delete []m_pRGB;
 	m_pRGB = m_pResImg;
 	width = dst_width;
 	height = dst_height;
 
-	DeleteObject(m_hBMP);
-	m_hBMP = 0;
-}
\ No newline at end of file
+	// the size changed, the device bitmap is created again by the next Paint
+	ReleaseDeviceBitmap();
+	MarkDirty();
+}
+
+void CResizableImage::ResampleRows(unsigned dst_width, unsigned dst_height, const RowSink &sink)
+{
+	EnsureKernel();
+
+	std::shared_ptr<const CWeightsTable> pHorz = GetWeights(dst_width, width);
+	std::shared_ptr<const CWeightsTable> pVert = GetWeights(dst_height, height);
+
+	// horizontally scaled source rows, row r is kept in slot r % nSlots. A
+	// window spans at most getWindowSize() + 1 rows once the cut edge points
+	// are taken into account, and the windows only move down.
+	int nSlots = pVert->getWindowSize() + 1;
+	std::vector<RGBQUAD> ring(nSlots * dst_width);
+	std::vector<RGBQUAD> out(dst_width);
+	std::vector<const RGBQUAD*> rows(nSlots);
+	int iNextRow = 0;
+
+	for (unsigned y = 0; y < dst_height; y++)
+	{
+		int iLeft = pVert->getLeftBoundary(y);
+		int iRight = pVert->getRightBoundary(y);
+
+		// scale the source rows the window reaches for the first time
+		for (; iNextRow <= iRight; iNextRow++)
+			s_pFilterLine(&ring[(iNextRow % nSlots) * dst_width], &m_pRGB[iNextRow * width], dst_width, *pHorz);
+
+		for (int i = iLeft; i <= iRight; i++)
+			rows[i - iLeft] = &ring[(i % nSlots) * dst_width];
+
+		s_pFilterRows(&out[0], &rows[0], 0, dst_width, pVert->getFixedWeights(y), iRight - iLeft + 1);
+
+		sink(y, &out[0]);
+	}
+}
@@ -0,0 +1,262 @@
+//-----------------------------------------------------------------------------
+// File: RleSprite.cpp
+//
+// Desc: Run length encoded sprites.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CRleSprite Specific Includes
+//-----------------------------------------------------------------------------
+#include "RleSprite.h"
+#include "Blitters.h"
+#include <algorithm>
+#include <string.h>
+
+static const uint32_t RGB_BITS = 0x00FFFFFF;
+
+// Mask spans run on through gaps shorter than this: the SIMD mask kernel
+// goes through a few skipped pixels faster than it starts a new span
+static const int MASK_GAP = 16;
+
+//-----------------------------------------------------------------------------
+// Name : CRleSprite () (Constructor)
+// Desc : CRleSprite Class Constructor
+//-----------------------------------------------------------------------------
+CRleSprite::CRleSprite()
+{
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+	m_uOpaque	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CRleSprite () (Destructor)
+// Desc : CRleSprite Class Destructor
+//-----------------------------------------------------------------------------
+CRleSprite::~CRleSprite()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildFromMask ()
+// Desc : A pixel is skipped when the mask keeps all of the destination and
+//		the image adds nothing to it. The runs of the other pixels are copy
+//		spans when the mask keeps nothing of the destination anywhere in
+//		them, mask spans otherwise: one long run through the SIMD mask
+//		kernel beats short copy and mask spans in turn. For the same reason
+//		a mask span takes in the skipped pixels of short gaps.
+//-----------------------------------------------------------------------------
+void CRleSprite::BuildFromMask(const CFrameBuffer& image, const CFrameBuffer& mask, int sx, int sy, int w, int h)
+{
+	Release();
+
+	if (image.IsEmpty() || mask.Width() < image.Width() || mask.Height() < image.Height())
+		return;
+
+	// the part of the rectangle inside the image
+	w = std::min(sx + w, image.Width()) - std::max(sx, 0);
+	h = std::min(sy + h, image.Height()) - std::max(sy, 0);
+	sx = std::max(sx, 0);
+	sy = std::max(sy, 0);
+
+	if (w <= 0 || h <= 0)
+		return;
+
+	m_iWidth = w;
+	m_iHeight = h;
+	m_RowStart.resize(h + 1);
+
+	for (int y = 0; y < h; y++)
+	{
+		const uint32_t *pPixels = image.Row(sy + y) + sx;
+		const uint32_t *pMask = mask.Row(sy + y) + sx;
+		int x0 = -1, xEnd = 0;
+		bool bMasked = false;
+
+		m_RowStart[y] = (int)m_Spans.size();
+
+		for (int x = 0; x <= w; x++)
+		{
+			bool bDrawn = x < w && ((pMask[x] & RGB_BITS) != RGB_BITS || pPixels[x] != 0);
+
+			if (bDrawn)
+			{
+				if (x0 < 0)
+				{
+					x0 = x;
+					bMasked = false;
+				}
+				else if (x > xEnd)
+				{
+					// a short gap went into the mask span, the mask leaves
+					// the destination of its pixels as it is
+					bMasked = true;
+				}
+
+				bMasked |= ((pMask[x] & RGB_BITS) != 0);
+				xEnd = x + 1;
+			}
+			else if (x0 >= 0 && (!bMasked || x == w || x - xEnd >= MASK_GAP))
+			{
+				// and on to a whole number of SIMD steps, the pixels after
+				// xEnd are skipped ones up to the gap
+				if (bMasked)
+					xEnd = std::min(w, x0 + ((xEnd - x0 + 7) & ~7));
+
+				AddSpan(x0, xEnd, pPixels, bMasked ? pMask : NULL);
+				x0 = -1;
+			}
+		}
+	}
+
+	m_RowStart[h] = (int)m_Spans.size();
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildFromColorKey ()
+// Desc : Every pixel that is not the color key goes in a copy span.
+//-----------------------------------------------------------------------------
+void CRleSprite::BuildFromColorKey(const CFrameBuffer& image, int sx, int sy, int w, int h, uint32_t uColorKey)
+{
+	Release();
+
+	if (image.IsEmpty())
+		return;
+
+	w = std::min(sx + w, image.Width()) - std::max(sx, 0);
+	h = std::min(sy + h, image.Height()) - std::max(sy, 0);
+	sx = std::max(sx, 0);
+	sy = std::max(sy, 0);
+
+	if (w <= 0 || h <= 0)
+		return;
+
+	m_iWidth = w;
+	m_iHeight = h;
+	m_RowStart.resize(h + 1);
+
+	uColorKey &= RGB_BITS;
+
+	for (int y = 0; y < h; y++)
+	{
+		const uint32_t *pPixels = image.Row(sy + y) + sx;
+		int x0 = -1;
+
+		m_RowStart[y] = (int)m_Spans.size();
+
+		for (int x = 0; x <= w; x++)
+		{
+			bool bOpaque = x < w && (pPixels[x] & RGB_BITS) != uColorKey;
+
+			if (bOpaque && x0 < 0)
+			{
+				x0 = x;
+			}
+			else if (!bOpaque && x0 >= 0)
+			{
+				AddSpan(x0, x, pPixels, NULL);
+				x0 = -1;
+			}
+		}
+	}
+
+	m_RowStart[h] = (int)m_Spans.size();
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddSpan () (Private)
+// Desc : pPixels / pMask are the first pixels of the row.
+//-----------------------------------------------------------------------------
+void CRleSprite::AddSpan(int x0, int x, const uint32_t *pPixels, const uint32_t *pMask)
+{
+	Span span;
+	span.x			= x0;
+	span.n			= x - x0;
+	span.pPixels	= pPixels + x0;
+	span.pMask		= pMask ? pMask + x0 : NULL;
+
+	m_Spans.push_back(span);
+	m_uOpaque += span.n;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Forgets the spans, the sprite draws nothing.
+//-----------------------------------------------------------------------------
+void CRleSprite::Release()
+{
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+	m_uOpaque	= 0;
+
+	m_Spans.clear();
+	m_RowStart.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : MemorySize ()
+// Desc : The spans only, the pixels belong to the source surfaces.
+//-----------------------------------------------------------------------------
+size_t CRleSprite::MemorySize() const
+{
+	return m_Spans.size() * sizeof(Span) + m_RowStart.size() * sizeof(int);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Draw ()
+// Desc : Clips like CBlitter::Clip, then every span of the rows drawn is cut
+//		to the columns [sx, sx + w).
+//-----------------------------------------------------------------------------
+void CRleSprite::Draw(CFrameBuffer& dst, int x, int y, int sx, int sy, int w, int h) const
+{
+	if (IsEmpty() || dst.IsEmpty())
+		return;
+
+	if (sx < 0) { x -= sx; w += sx; sx = 0; }
+	if (sy < 0) { y -= sy; h += sy; sy = 0; }
+	if (sx + w > m_iWidth)  w = m_iWidth - sx;
+	if (sy + h > m_iHeight) h = m_iHeight - sy;
+
+	if (x < 0) { sx -= x; w += x; x = 0; }
+	if (y < 0) { sy -= y; h += y; y = 0; }
+	if (x + w > dst.Width())  w = dst.Width() - x;
+	if (y + h > dst.Height()) h = dst.Height() - y;
+
+	if (w <= 0 || h <= 0)
+		return;
+
+	int sx1 = sx + w;
+
+	for (int row = 0; row < h; row++)
+	{
+		// pixel x + i of the row is column sx + i of the sprite
+		uint32_t *pRow = dst.Row(y + row) + x;
+		int iEnd = m_RowStart[sy + row + 1];
+
+		for (int k = m_RowStart[sy + row]; k < iEnd; k++)
+		{
+			const Span &span = m_Spans[k];
+
+			if (span.x >= sx1)
+				break;
+
+			int c0 = std::max(span.x, sx);
+			int c1 = std::min(span.x + span.n, sx1);
+
+			if (c0 >= c1)
+				continue;
+
+			uint32_t *d = pRow + (c0 - sx);
+			const uint32_t *s = span.pPixels + (c0 - span.x);
+
+			if (span.pMask == NULL)
+			{
+				memcpy(d, s, (c1 - c0) * sizeof(uint32_t));
+			}
+			else
+			{
+				CBlitter::MaskRow(d, s, span.pMask + (c0 - span.x), c1 - c0);
+			}
+		}
+	}
+}
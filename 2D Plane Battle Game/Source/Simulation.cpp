@@ -0,0 +1,524 @@
+//-----------------------------------------------------------------------------
+// File: Simulation.cpp
+//
+// Desc: The rules of a match, without any drawing, sound or window.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSimulation Specific Includes
+//-----------------------------------------------------------------------------
+#include "Simulation.h"
+
+//-----------------------------------------------------------------------------
+// Local Constants
+//-----------------------------------------------------------------------------
+static const float	RESPAWN_X[SIM_PLAYER_COUNT]	= { 100.0f, 1800.0f };
+static const float	RESPAWN_Y					= 900.0f;
+
+static const float	PLAYER_ACCELERATION	= 210.0f;	// pixels per second, every second a key is held
+static const float	PLAYER_MIN_Y		= 300.0f;
+static const float	PLAYER_MAX_Y		= 920.0f;
+static const float	PLAYER_FIRE_DELAY	= 1.6f;		// seconds
+
+static const float	ENEMY_SPEED			= 180.0f;	// pixels per second
+static const float	ENEMY_PATROL_LEFT	= 200.0f;
+static const float	ENEMY_PATROL_RIGHT	= 1700.0f;
+static const float	ENEMY_FIRST_SHOT	= 2.4f;		// seconds
+static const float	ENEMY_FIRE_DELAY	= 1.6f;		// seconds
+
+static const float	FIELD_TOP			= 35.0f;	// bullets and enemies past these are removed
+static const float	FIELD_BOTTOM		= 960.0f;
+
+//-----------------------------------------------------------------------------
+// Name : CSimulation () (Constructor)
+// Desc : CSimulation Class Constructor
+//-----------------------------------------------------------------------------
+CSimulation::CSimulation(int iBulletCapacity, int iEnemyCapacity)
+	: m_Bullets(iBulletCapacity), m_Enemies(iEnemyCapacity), m_Grid(FieldWidth, FieldHeight, 128)
+{
+	m_fTickTime = 1.0f / 60.0f;
+
+	Reset();
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CSimulation () (Destructor)
+// Desc : CSimulation Class Destructor
+//-----------------------------------------------------------------------------
+CSimulation::~CSimulation()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetShape ()
+// Desc : Copies the collision mask of an entity type.
+//-----------------------------------------------------------------------------
+void CSimulation::SetShape(ESimShape shape, const CCollisionMask& mask)
+{
+	m_Shapes[shape] = mask;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reset ()
+// Desc : Planes at their start positions, a fresh wave, full lives.
+//-----------------------------------------------------------------------------
+void CSimulation::Reset()
+{
+	m_Bullets.Clear();
+	m_Enemies.Clear();
+	m_Events.clear();
+
+	for (int p = 0; p < SIM_PLAYER_COUNT; p++)
+	{
+		RespawnPlayer(p);
+		m_Players[p].fFireCooldown = PLAYER_FIRE_DELAY;
+	}
+
+	m_iPlayerLives	= 2;
+	m_iEnemyLives	= 2;
+	m_ulTickCount	= 0;
+
+	SpawnWave();
+}
+
+//-----------------------------------------------------------------------------
+// Name : RespawnPlayer () / PlacePlayer ()
+// Desc : Moves a plane, stopped and without interpolation from where it was.
+//-----------------------------------------------------------------------------
+void CSimulation::RespawnPlayer(int iPlayer)
+{
+	PlacePlayer(iPlayer, RESPAWN_X[iPlayer], RESPAWN_Y);
+}
+
+void CSimulation::PlacePlayer(int iPlayer, float x, float y)
+{
+	SimPlayer &pl = m_Players[iPlayer];
+
+	pl.x = pl.prevX = x;
+	pl.y = pl.prevY = y;
+	pl.vx = 0;
+	pl.vy = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetLives ()
+// Desc : Used when a saved game is loaded.
+//-----------------------------------------------------------------------------
+void CSimulation::SetLives(int iPlayerLives, int iEnemyLives)
+{
+	m_iPlayerLives	= iPlayerLives;
+	m_iEnemyLives	= iEnemyLives;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SpawnWave () / SpawnEnemy () / SpawnBullet ()
+// Desc : Entity creation, the handles are invalid if a store is full.
+//-----------------------------------------------------------------------------
+void CSimulation::SpawnWave()
+{
+	SpawnEnemy(950, 70);
+	SpawnEnemy(350, 70);
+	SpawnEnemy(1550, 70);
+}
+
+EntityHandle CSimulation::SpawnEnemy(float x, float y)
+{
+	EntityHandle h = m_Enemies.Create(x, y, 0, 0, FACTION_ENEMY);
+
+	int slot = m_Enemies.SlotOf(h);
+	if (slot != -1)
+	{
+		// first shot comes a bit later than the next ones
+		m_Enemies.Cooldown()[slot] = ENEMY_FIRST_SHOT;
+	}
+
+	return h;
+}
+
+EntityHandle CSimulation::SpawnBullet(float x, float y, EFaction owner)
+{
+	// enemy bullets go from top to bottom, player bullets from bottom to top
+	float vy = (owner == FACTION_ENEMY) ? (float)BulletSpeed : -(float)BulletSpeed;
+
+	return m_Bullets.Create(x, y, 0, vy, (unsigned char)owner);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Tick ()
+// Desc : One step of the match.
+//-----------------------------------------------------------------------------
+void CSimulation::Tick(const SimInput& input)
+{
+	m_Events.clear();
+
+	// remember where everything was, for interpolated drawing
+	for (int p = 0; p < SIM_PLAYER_COUNT; p++)
+	{
+		m_Players[p].prevX = m_Players[p].x;
+		m_Players[p].prevY = m_Players[p].y;
+	}
+
+	m_Bullets.SavePositions();
+	m_Enemies.SavePositions();
+
+	MovePlayers(input);
+
+	// if there is no enemy, a new wave comes in
+	if (m_Enemies.Count() == 0 && m_iEnemyLives != -1)
+	{
+		SpawnWave();
+	}
+
+	// the enemies only fly while both sides are still in the match
+	if (!IsOver())
+	{
+		MoveEnemies();
+		EnemiesShoot();
+	}
+
+	// the enemies are sorted in a grid (broadphase), so the planes and the
+	// bullets only run the exact test against the enemies close to them
+	float enemyW = (float)m_Shapes[SIM_SHAPE_ENEMY].Width();
+	float enemyH = (float)m_Shapes[SIM_SHAPE_ENEMY].Height();
+
+	m_Grid.Clear();
+	for (int e = 0; e < m_Enemies.Count(); e++)
+	{
+		m_Grid.InsertCentered(e, m_Enemies.PosX()[e], m_Enemies.PosY()[e], enemyW, enemyH);
+	}
+	m_Grid.Build();
+
+	CollidePlayers();
+
+	// the bullets move by their velocity (pixels per second)
+	m_Bullets.Integrate(m_fTickTime);
+
+	CollideBullets();
+	RemoveDead();
+
+	m_ulTickCount++;
+}
+
+//-----------------------------------------------------------------------------
+// Name : MovePlayers () (Private)
+// Desc : Shooting, steering (every key held adds some speed), keeping the
+//		planes on the field, then moving them.
+//-----------------------------------------------------------------------------
+void CSimulation::MovePlayers(const SimInput& input)
+{
+	for (int p = 0; p < SIM_PLAYER_COUNT; p++)
+	{
+		SimPlayer &pl = m_Players[p];
+		unsigned int dir = input.uDirection[p];
+		float dv = PLAYER_ACCELERATION * m_fTickTime;
+
+		if (input.bShoot[p] && pl.fFireCooldown <= 0.0f)
+		{
+			SpawnBullet(pl.x, pl.y, FACTION_PLAYER);
+			pl.fFireCooldown = PLAYER_FIRE_DELAY;
+		}
+
+		if (dir & SIM_DIR_LEFT)
+		{
+			pl.vx -= dv;
+		}
+
+		if (pl.x < 0)
+		{
+			pl.x = 0;
+			pl.vx = 0;
+		}
+
+		if (dir & SIM_DIR_RIGHT)
+		{
+			pl.vx += dv;
+		}
+
+		if (pl.x > FieldWidth)
+		{
+			pl.x = (float)FieldWidth;
+			pl.vx = 0;
+		}
+
+		if (dir & SIM_DIR_FORWARD)
+		{
+			pl.vy -= dv;
+		}
+
+		if (pl.y < PLAYER_MIN_Y)
+		{
+			pl.y = PLAYER_MIN_Y;
+			pl.vy = 0;
+		}
+
+		if (dir & SIM_DIR_BACKWARD)
+		{
+			pl.vy += dv;
+		}
+
+		if (pl.y > PLAYER_MAX_Y)
+		{
+			pl.y = PLAYER_MAX_Y;
+			pl.vy = 0;
+		}
+
+		pl.x += pl.vx * m_fTickTime;
+		pl.y += pl.vy * m_fTickTime;
+
+		if (pl.fFireCooldown > 0.0f)
+		{
+			pl.fFireCooldown -= m_fTickTime;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : MoveEnemies () (Private)
+// Desc : The enemies patrol between the two turning points. A step stops
+//		at the turning point, so they turn there whatever the tick rate.
+//-----------------------------------------------------------------------------
+void CSimulation::MoveEnemies()
+{
+	float *px = m_Enemies.PosX();
+	unsigned char *flags = m_Enemies.Flags();
+	float step = ENEMY_SPEED * m_fTickTime;
+
+	for (int i = 0; i < m_Enemies.Count(); i++)
+	{
+		bool left = (flags[i] & CEntityStore::FLAG_LEFT) != 0;
+
+		if (px[i] <= ENEMY_PATROL_LEFT)
+		{
+			left = false;
+		}
+
+		if (px[i] >= ENEMY_PATROL_RIGHT)
+		{
+			left = true;
+		}
+
+		if (left == false)
+		{
+			px[i] = (px[i] + step < ENEMY_PATROL_RIGHT) ? px[i] + step : ENEMY_PATROL_RIGHT;
+		}
+		else
+		{
+			px[i] = (px[i] - step > ENEMY_PATROL_LEFT) ? px[i] - step : ENEMY_PATROL_LEFT;
+		}
+
+		flags[i] = left ? (flags[i] | CEntityStore::FLAG_LEFT) : (flags[i] & ~CEntityStore::FLAG_LEFT);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : EnemiesShoot () (Private)
+// Desc : Every enemy fires when its cooldown runs out.
+//-----------------------------------------------------------------------------
+void CSimulation::EnemiesShoot()
+{
+	float *cooldown = m_Enemies.Cooldown();
+	const float *px = m_Enemies.PosX();
+	const float *py = m_Enemies.PosY();
+
+	for (int i = 0; i < m_Enemies.Count(); i++)
+	{
+		cooldown[i] -= m_fTickTime;
+
+		if (cooldown[i] <= 0.0f)
+		{
+			SpawnBullet(px[i], py[i], FACTION_ENEMY);
+			cooldown[i] = ENEMY_FIRE_DELAY;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : CollidePlayers () (Private)
+// Desc : A plane that touches an enemy explodes and starts again from its
+//		respawn point (it doesn't cost a life).
+//-----------------------------------------------------------------------------
+void CSimulation::CollidePlayers()
+{
+	const float *ex = m_Enemies.PosX();
+	const float *ey = m_Enemies.PosY();
+
+	float playerW = (float)m_Shapes[SIM_SHAPE_PLAYER].Width();
+	float playerH = (float)m_Shapes[SIM_SHAPE_PLAYER].Height();
+
+	for (int p = 0; p < SIM_PLAYER_COUNT; p++)
+	{
+		SimPlayer &pl = m_Players[p];
+
+		m_Grid.QueryCentered(pl.x, pl.y, playerW, playerH, [&](int e)
+		{
+			if (!Collide(ex[e], ey[e], SIM_SHAPE_ENEMY, pl.x, pl.y, SIM_SHAPE_PLAYER))
+			{
+				return false;
+			}
+
+			AddEvent(SIM_EVENT_PLAYER_EXPLODED, p, pl.x, pl.y);
+			RespawnPlayer(p);
+			return true;
+		});
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : CollideBullets () (Private)
+// Desc : Player bullets against the enemies (through the grid), enemy
+//		bullets against the two planes. Both sides have 3 lives, a bullet
+//		is used up by the first thing it hits.
+//-----------------------------------------------------------------------------
+void CSimulation::CollideBullets()
+{
+	float *ex = m_Enemies.PosX();
+	float *ey = m_Enemies.PosY();
+	const float *bx = m_Bullets.PosX();
+	const float *by = m_Bullets.PosY();
+	unsigned char *bulletFlags = m_Bullets.Flags();
+
+	float bulletW = (float)m_Shapes[SIM_SHAPE_BULLET].Width();
+	float bulletH = (float)m_Shapes[SIM_SHAPE_BULLET].Height();
+
+	for (int b = 0; b < m_Bullets.Count(); b++)
+	{
+		if (m_Bullets.Faction()[b] == FACTION_PLAYER)
+		{
+			m_Grid.QueryCentered(bx[b], by[b], bulletW, bulletH, [&](int e)
+			{
+				if (!Collide(bx[b], by[b], SIM_SHAPE_BULLET, ex[e], ey[e], SIM_SHAPE_ENEMY))
+				{
+					return false;
+				}
+
+				if (m_iEnemyLives > 0)
+				{
+					m_Enemies.Flags()[e] |= CEntityStore::FLAG_HIT;
+					m_iEnemyLives--;
+
+					AddEvent(SIM_EVENT_ENEMY_HIT, -1, ex[e], ey[e]);
+				}
+
+				// the last life is gone, we win the match
+				else if (m_iEnemyLives == 0)
+				{
+					ex[e] = m_Enemies.PrevX()[e] = 950;
+					ey[e] = m_Enemies.PrevY()[e] = 70;
+
+					m_iEnemyLives = -1;
+
+					AddEvent(SIM_EVENT_MATCH_WON, -1, bx[b], by[b]);
+				}
+
+				bulletFlags[b] |= CEntityStore::FLAG_HIT;
+				return true;
+			});
+		}
+
+		// the enemy bullets can only hit the two friendly planes, no broadphase needed
+		else
+		{
+			for (int p = 0; p < SIM_PLAYER_COUNT; p++)
+			{
+				SimPlayer &pl = m_Players[p];
+
+				if (!Collide(bx[b], by[b], SIM_SHAPE_BULLET, pl.x, pl.y, SIM_SHAPE_PLAYER))
+				{
+					continue;
+				}
+
+				if (m_iPlayerLives > 0)
+				{
+					m_iPlayerLives--;
+
+					AddEvent(SIM_EVENT_PLAYER_HIT, p, pl.x, pl.y);
+				}
+
+				// the last life is gone, we lose the match
+				else if (m_iPlayerLives == 0)
+				{
+					AddEvent(SIM_EVENT_PLAYER_EXPLODED, p, pl.x, pl.y);
+					AddEvent(SIM_EVENT_MATCH_LOST, p, pl.x, pl.y);
+
+					RespawnPlayer(p);
+
+					m_iPlayerLives = -1;
+				}
+
+				bulletFlags[b] |= CEntityStore::FLAG_HIT;
+				break;
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : RemoveDead () (Private)
+// Desc : Used up bullets and everything that left the field go away. Once
+//		the match is over all the bullets are removed.
+//-----------------------------------------------------------------------------
+void CSimulation::RemoveDead()
+{
+	const unsigned char *bulletFlags = m_Bullets.Flags();
+	const float *bulletY = m_Bullets.PosY();
+	bool bOver = IsOver();
+
+	m_Bullets.RemoveIf([&](int b)
+	{
+		return (bulletFlags[b] & CEntityStore::FLAG_HIT) || bulletY[b] < FIELD_TOP || bulletY[b] > FIELD_BOTTOM || bOver;
+	});
+
+	const float *enemyY = m_Enemies.PosY();
+
+	m_Enemies.RemoveIf([&](int e)
+	{
+		return enemyY[e] < FIELD_TOP || enemyY[e] > FIELD_BOTTOM;
+	});
+}
+
+//-----------------------------------------------------------------------------
+// Name : Collide () (Private)
+// Desc : The bounding boxes are compared first, the collision masks are only
+//		tested when they touch. The upper-left corners are computed the same
+//		way the sprites are drawn.
+//-----------------------------------------------------------------------------
+bool CSimulation::Collide(float x1, float y1, ESimShape shape1, float x2, float y2, ESimShape shape2) const
+{
+	const CCollisionMask &mask1 = m_Shapes[shape1];
+	const CCollisionMask &mask2 = m_Shapes[shape2];
+
+	int w1 = mask1.Width(), h1 = mask1.Height();
+	int w2 = mask2.Width(), h2 = mask2.Height();
+
+	double left1 = x1 - (w1 / 2);
+	double left2 = x2 - (w2 / 2);
+	double top1 = y1 - (h1 / 2);
+	double top2 = y2 - (h2 / 2);
+
+	if (top1 + h1 < top2 || top1 > top2 + h2 || left1 + w1 < left2 || left1 > left2 + w2)
+	{
+		return false;
+	}
+
+	int ix1 = (int)x1 - (w1 / 2);
+	int iy1 = (int)y1 - (h1 / 2);
+	int ix2 = (int)x2 - (w2 / 2);
+	int iy2 = (int)y2 - (h2 / 2);
+
+	return mask1.Overlaps(mask2, ix2 - ix1, iy2 - iy1);
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddEvent () (Private)
+// Desc : Records something that happened during the current tick.
+//-----------------------------------------------------------------------------
+void CSimulation::AddEvent(ESimEventType type, int iPlayer, float x, float y)
+{
+	SimEvent ev;
+	ev.type		= type;
+	ev.iPlayer	= iPlayer;
+	ev.x		= x;
+	ev.y		= y;
+
+	m_Events.push_back(ev);
+}
@@ -0,0 +1,132 @@
+//-----------------------------------------------------------------------------
+// File: SpatialGrid.cpp
+//
+// Desc: Uniform grid broadphase for the collision tests.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSpatialGrid Specific Includes
+//-----------------------------------------------------------------------------
+#include "SpatialGrid.h"
+
+//-----------------------------------------------------------------------------
+// Name : CSpatialGrid () (Constructor)
+// Desc : CSpatialGrid Class Constructor
+//-----------------------------------------------------------------------------
+CSpatialGrid::CSpatialGrid(int iWorldWidth, int iWorldHeight, int iCellSize)
+{
+	m_iCellSize	= iCellSize;
+	m_iCellsX	= (iWorldWidth + iCellSize - 1) / iCellSize;
+	m_iCellsY	= (iWorldHeight + iCellSize - 1) / iCellSize;
+	m_uStamp	= 0;
+
+	m_CellStart.assign(m_iCellsX * m_iCellsY + 1, 0);
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CSpatialGrid () (Destructor)
+// Desc : CSpatialGrid Class Destructor
+//-----------------------------------------------------------------------------
+CSpatialGrid::~CSpatialGrid()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Forgets all the targets (the memory is kept for the next frame).
+//-----------------------------------------------------------------------------
+void CSpatialGrid::Clear()
+{
+	m_Targets.clear();
+	m_CellItems.clear();
+	m_CellStart.assign(m_CellStart.size(), 0);
+}
+
+//-----------------------------------------------------------------------------
+// Name : CellRange () (Private)
+// Desc : Cells covered by a box. Anything outside the playfield is clamped
+//		to the border cells.
+//-----------------------------------------------------------------------------
+void CSpatialGrid::CellRange(float left, float top, float right, float bottom,
+							 int& cx0, int& cy0, int& cx1, int& cy1) const
+{
+	cx0 = (left < 0) ? 0 : (int)left / m_iCellSize;
+	cy0 = (top < 0) ? 0 : (int)top / m_iCellSize;
+	cx1 = (right < 0) ? 0 : (int)right / m_iCellSize;
+	cy1 = (bottom < 0) ? 0 : (int)bottom / m_iCellSize;
+
+	if (cx0 >= m_iCellsX) cx0 = m_iCellsX - 1;
+	if (cy0 >= m_iCellsY) cy0 = m_iCellsY - 1;
+	if (cx1 >= m_iCellsX) cx1 = m_iCellsX - 1;
+	if (cy1 >= m_iCellsY) cy1 = m_iCellsY - 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Insert ()
+// Desc : Registers a target with its bounding box.
+//-----------------------------------------------------------------------------
+void CSpatialGrid::Insert(int id, float left, float top, float right, float bottom)
+{
+	Target t;
+	t.id = id;
+	CellRange(left, top, right, bottom, t.cx0, t.cy0, t.cx1, t.cy1);
+
+	m_Targets.push_back(t);
+
+	if (id >= (int)m_Stamp.size())
+	{
+		m_Stamp.resize(id + 1, 0);
+	}
+}
+
+void CSpatialGrid::InsertCentered(int id, float cx, float cy, float w, float h)
+{
+	Insert(id, cx - w / 2, cy - h / 2, cx + w / 2, cy + h / 2);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build ()
+// Desc : Counting sort of the targets by cell, so every cell ends up as a
+//		contiguous run of ids in m_CellItems.
+//-----------------------------------------------------------------------------
+void CSpatialGrid::Build()
+{
+	std::size_t t;
+	int cell, cx, cy;
+	int nCells = m_iCellsX * m_iCellsY;
+
+	// count the items of every cell (shifted by one for the prefix sum)
+	for (t = 0; t < m_Targets.size(); t++)
+	{
+		const Target &tg = m_Targets[t];
+
+		for (cy = tg.cy0; cy <= tg.cy1; cy++)
+			for (cx = tg.cx0; cx <= tg.cx1; cx++)
+				m_CellStart[cy * m_iCellsX + cx + 1]++;
+	}
+
+	for (cell = 0; cell < nCells; cell++)
+	{
+		m_CellStart[cell + 1] += m_CellStart[cell];
+	}
+
+	m_CellItems.resize(m_CellStart[nCells]);
+
+	// scatter the ids, using the start of every cell as a write cursor
+	for (t = 0; t < m_Targets.size(); t++)
+	{
+		const Target &tg = m_Targets[t];
+
+		for (cy = tg.cy0; cy <= tg.cy1; cy++)
+			for (cx = tg.cx0; cx <= tg.cx1; cx++)
+				m_CellItems[m_CellStart[cy * m_iCellsX + cx]++] = tg.id;
+	}
+
+	// the cursors now point at the end of every cell, shift them back
+	for (cell = nCells; cell > 0; cell--)
+	{
+		m_CellStart[cell] = m_CellStart[cell - 1];
+	}
+
+	m_CellStart[0] = 0;
+}
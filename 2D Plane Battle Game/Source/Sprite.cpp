@@ -1,63 +1,148 @@
 #include "Sprite.h"
+#include "BmpDecoder.h"
+#include "AssetPack.h"
 
 extern HINSTANCE g_hInst;
 
-Sprite::Sprite(int imageID, int maskID)
+// Reads a bitmap as 32 bit top-down pixels (0x00RRGGBB)
+static bool GetBitmapPixels(HBITMAP hBitmap, int iWidth, int iHeight, CFrameBuffer& pixels)
 {
-	// Load the bitmap resources.
-	mhImage = LoadBitmap(g_hInst, MAKEINTRESOURCE(imageID));
-	mhMask = LoadBitmap(g_hInst, MAKEINTRESOURCE(maskID));
+	if (hBitmap == 0 || iWidth <= 0 || iHeight <= 0)
+		return false;
+
+	BITMAPINFO bmi;
+	ZeroMemory(&bmi, sizeof(BITMAPINFO));
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = iWidth;
+	bmi.bmiHeader.biHeight = -iHeight;	// negative height asks for top-down rows
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	pixels.Create(iWidth, iHeight);
 
-	// Get the BITMAP structure for each of the bitmaps.
-	GetObject(mhImage, sizeof(BITMAP), &mImageBM);
-	GetObject(mhMask, sizeof(BITMAP), &mMaskBM);
+	HDC hDC = CreateCompatibleDC(NULL);
+	int iLines = GetDIBits(hDC, hBitmap, 0, iHeight, pixels.Pixels(), &bmi, DIB_RGB_COLORS);
+	DeleteDC(hDC);
 
-	// Image and Mask should be the same dimensions.
-	assert(mImageBM.bmWidth == mMaskBM.bmWidth);
-	assert(mImageBM.bmHeight == mMaskBM.bmHeight);	
+	if( iLines != iHeight )
+	{
+		pixels.Release();
+		return false;
+	}
 
-	mcTransparentColor = 0;
-	mhSpriteDC = 0;
+	return true;
 }
 
-Sprite::Sprite(const char *szImageFile, const char *szMaskFile)
+// Copies the pixels of a GDI bitmap and frees it, the blitters only need
+// the pixels
+static bool TakeBitmapPixels(HBITMAP hBitmap, CFrameBuffer& pixels)
 {
-	mhImage = (HBITMAP)LoadImage(g_hInst, szImageFile, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION | LR_LOADFROMFILE);
-	mhMask = (HBITMAP)LoadImage(g_hInst, szMaskFile, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION | LR_LOADFROMFILE);
+	if( hBitmap == 0 )
+		return false;
+
+	CGdiStats::OnCreate();
+
+	BITMAP bm;
+	bool bLoaded = GetObject(hBitmap, sizeof(BITMAP), &bm) != 0 && GetBitmapPixels(hBitmap, bm.bmWidth, bm.bmHeight, pixels);
+
+	DeleteObject(hBitmap);
+
+	return bLoaded;
+}
 
-	// Get the BITMAP structure for each of the bitmaps.
-	GetObject(mhImage, sizeof(BITMAP), &mImageBM);
-	GetObject(mhMask, sizeof(BITMAP), &mMaskBM);
+// Attaches the pixels of szFileName in the asset pack (no copy, the game
+// keeps the pack open as long as the sprites), or copies the pixels pAssets
+// decoded for it, false if it has neither
+static bool GetAssetPixels(const CAssetLoader *pAssets, const char *szFileName, CFrameBuffer& pixels)
+{
+	if( pAssets && pAssets->GetPack() && pAssets->GetPack()->GetImage(szFileName, pixels) )
+		return true;
+
+	int i = pAssets ? pAssets->Find(szFileName) : -1;
+
+	if( i < 0 || !pAssets->IsFinished() || !pAssets->Succeeded(i) )
+		return false;
+
+	const CFrameBuffer& src = pAssets->Pixels(i);
+	pixels.Create(src.Width(), src.Height());
+
+	for( int y = 0; y < src.Height(); y++ )
+		CopyMemory(pixels.Row(y), src.Row(y), src.Width() * sizeof(uint32_t));
+
+	return true;
+}
+
+// Reads a sprite file: the asset pack or the startup loader may have it
+// already, otherwise CBmpDecoder reads it, and GDI the formats CBmpDecoder
+// can't.
+static CImageCache::LoadFn FileLoader(const CAssetLoader *pAssets)
+{
+	return [pAssets](const char *szFileName, CFrameBuffer& pixels)
+	{
+		return GetAssetPixels(pAssets, szFileName, pixels) ||
+			   CBmpDecoder::LoadFile(szFileName, pixels) ||
+			   TakeBitmapPixels((HBITMAP)LoadImage(g_hInst, szFileName, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION | LR_LOADFROMFILE), pixels);
+	};
+}
 
-	// Image and Mask should be the same dimensions.
-	assert(mImageBM.bmWidth == mMaskBM.bmWidth);
-	assert(mImageBM.bmHeight == mMaskBM.bmHeight);
+// Reads a bitmap resource, the cache knows them as "#<id>"
+static bool LoadBitmapResource(const char *szName, CFrameBuffer& pixels)
+{
+	return TakeBitmapPixels(LoadBitmap(g_hInst, MAKEINTRESOURCE(atoi(szName + 1))), pixels);
+}
 
-	mcTransparentColor = 0;
-	mhSpriteDC = 0;
+// COLORREF is 0x00BBGGRR, the pixels are 0x00RRGGBB
+static uint32_t ColorToPixel(COLORREF cr)
+{
+	return (GetRValue(cr) << 16) | (GetGValue(cr) << 8) | GetBValue(cr);
 }
 
-Sprite::Sprite(const char *szImageFile, COLORREF crTransparentColor)
+Sprite::Sprite(int imageID, int maskID)
 {
-	mhImage = (HBITMAP)LoadImage(g_hInst, szImageFile, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION | LR_LOADFROMFILE);
+	char szImage[16], szMask[16];
+	sprintf_s(szImage, "#%d", imageID);
+	sprintf_s(szMask, "#%d", maskID);
 
-	mhMask = 0;
-	mhSpriteDC = 0;
-	mcTransparentColor = crTransparentColor;
+	mpImage = CImageCache::Shared().GetMasked(szImage, szMask, LoadBitmapResource);
+	mpBackBuffer = NULL;
+	szImageFile = NULL;
 
-	// Get the BITMAP structure for the bitmap.
-	GetObject(mhImage, sizeof(BITMAP), &mImageBM);
+	setImage();
+}
 
+Sprite::Sprite(const char *szImageFile, const char *szMaskFile, const CAssetLoader *pAssets)
+{
+	// Every sprite made from the same files shares one copy of the image.
+	mpImage = CImageCache::Shared().GetMasked(szImageFile, szMaskFile, FileLoader(pAssets));
+	mpBackBuffer = NULL;
 	this->szImageFile = szImageFile;
+
+	setImage();
+}
+
+Sprite::Sprite(const char *szImageFile, COLORREF crTransparentColor, const CAssetLoader *pAssets)
+{
+	mpImage = CImageCache::Shared().GetColorKeyed(szImageFile, ColorToPixel(crTransparentColor), FileLoader(pAssets));
+	mpBackBuffer = NULL;
+	this->szImageFile = szImageFile;
+
+	setImage();
 }
 
 Sprite::~Sprite()
 {
-	// Free the resources we created in the constructor.
-	DeleteObject(mhImage);
-	DeleteObject(mhMask);
+	// The image is freed with the last sprite using it.
+}
 
-	DeleteDC(mhSpriteDC);
+void Sprite::setImage()
+{
+	mpAtlas = NULL;
+	miAtlasIndex = -1;
+
+	// A sprite whose files could not be loaded draws and collides with nothing.
+	if( !mpImage )
+		mpImage = std::make_shared<SpriteImage>();
 }
 
 void Sprite::update(float dt)
@@ -71,69 +156,49 @@ void Sprite::update(float dt)
 void Sprite::setBackBuffer(const BackBuffer *pBackBuffer)
 {
 	mpBackBuffer = pBackBuffer;
-	if(mpBackBuffer)
-	{
-		DeleteDC(mhSpriteDC);
-		mhSpriteDC = CreateCompatibleDC(mpBackBuffer->getDC());
-	}
 }
 
-void Sprite::draw()
+void Sprite::setAtlas(const CSpriteAtlas *pAtlas)
 {
-	if( mhMask != 0 )
-		drawMask();
-	else
-		drawTransparent();
+	miAtlasIndex = pAtlas ? pAtlas->Find(mpImage) : -1;
+	mpAtlas = (miAtlasIndex >= 0) ? pAtlas : NULL;
 }
 
-void Sprite::drawMask()
+void Sprite::blit(int x, int y, int sx, int sy, int w, int h)
 {
-	if( mpBackBuffer == NULL )
-		return;
-
-	HDC hBackBufferDC = mpBackBuffer->getDC();
-
-	// The position BitBlt wants is not the sprite's center
-	// position; rather, it wants the upper-left position,
-	// so compute that.
-	int w = width();
-	int h = height();
+	const SpriteImage &img = *mpImage;
+	CTiledCompositor *pCompositor = mpBackBuffer->getCompositor();
 
-	// Upper-left corner.
-	int x = (int)mPosition.x - (w / 2);
-	int y = (int)mPosition.y - (h / 2);
-
-	// Note: For this masking technique to work, it is assumed
-	// the backbuffer bitmap has been cleared to some
-	// non-zero value.
-	// Select the mask bitmap.
-	HGDIOBJ oldObj = SelectObject(mhSpriteDC, mhMask);
-
-	// Draw the mask to the backbuffer with SRCAND. This
-	// only draws the black pixels in the mask to the backbuffer,
-	// thereby marking the pixels we want to draw the sprite
-	// image onto.
-	BitBlt(hBackBufferDC, x, y, w, h, mhSpriteDC, 0, 0, SRCAND);
-
-	// Now select the image bitmap.
-	SelectObject(mhSpriteDC, mhImage);
+	// Only the opaque spans of the image are drawn, the way the
+	// mask (like SRCAND then SRCPAINT) or the transparent color
+	// would have drawn them.
+	if( pCompositor )
+	{
+		if( mpAtlas )
+			mpAtlas->Draw(*pCompositor, x, y, miAtlasIndex, sx, sy, w, h);
+		else
+			pCompositor->Rle(x, y, img.rle, sx, sy, w, h);
+		return;
+	}
 
-	// Draw the image to the backbuffer with SRCPAINT. This
-	// will only draw the image onto the pixels that where previously
-	// marked black by the mask.
-	BitBlt(hBackBufferDC, x, y, w, h, mhSpriteDC, 0, 0, SRCPAINT);
+	CFrameBuffer &frame = mpBackBuffer->getFrame();
 
-	// Restore the original bitmap object.
-	SelectObject(mhSpriteDC, oldObj);
+	if( mpAtlas )
+		mpAtlas->Draw(frame, x, y, miAtlasIndex, sx, sy, w, h);
+	else
+		img.rle.Draw(frame, x, y, sx, sy, w, h);
 }
 
-void Sprite::drawTransparent()
+// Masked and color keyed images draw the same way, the RLE spans were
+// built for whichever the image has
+void Sprite::draw()
 {
 	if( mpBackBuffer == NULL )
 		return;
 
-	HDC hBackBuffer = mpBackBuffer->getDC();
-
+	// The position the blitter wants is not the sprite's center
+	// position; rather, it wants the upper-left position,
+	// so compute that.
 	int w = width();
 	int h = height();
 
@@ -141,48 +206,13 @@ void Sprite::drawTransparent()
 	int x = (int)mPosition.x - (w / 2);
 	int y = (int)mPosition.y - (h / 2);
 
-	COLORREF crOldBack = SetBkColor(hBackBuffer, RGB(255, 255, 255));
-	COLORREF crOldText = SetTextColor(hBackBuffer, RGB(0, 0, 0));
-	HDC dcImage, dcTrans;
-
-	// Create two memory dcs for the image and the mask
-	dcImage=CreateCompatibleDC(hBackBuffer);
-	dcTrans=CreateCompatibleDC(hBackBuffer);
-
-	// Select the image into the appropriate dc
-	SelectObject(dcImage, mhImage);
-
-	// Create the mask bitmap
-	BITMAP bitmap;
-	GetObject(mhImage, sizeof(BITMAP), &bitmap);
-	HBITMAP bitmapTrans = CreateBitmap(bitmap.bmWidth, bitmap.bmHeight, 1, 1, NULL);
-
-	// Select the mask bitmap into the appropriate dc
-	SelectObject(dcTrans, bitmapTrans);
-
-	// Build mask based on transparent color
-	SetBkColor(dcImage, mcTransparentColor);
-	BitBlt(dcTrans, 0, 0, bitmap.bmWidth, bitmap.bmHeight, dcImage, 0, 0, SRCCOPY);
-
-	// Do the work - True Mask method - cool if not actual display
-	BitBlt(hBackBuffer, x, y, bitmap.bmWidth, bitmap.bmHeight, dcImage, 0, 0, SRCINVERT);
-	BitBlt(hBackBuffer, x, y, bitmap.bmWidth, bitmap.bmHeight, dcTrans, 0, 0, SRCAND);
-	BitBlt(hBackBuffer, x, y, bitmap.bmWidth, bitmap.bmHeight, dcImage, 0, 0, SRCINVERT);
-
-	// free memory	
-	DeleteDC(dcImage);
-	DeleteDC(dcTrans);
-	DeleteObject(bitmapTrans);
-
-	// Restore settings
-	SetBkColor(hBackBuffer, crOldBack);
-	SetTextColor(hBackBuffer, crOldText);
+	blit(x, y, 0, 0, w, h);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-AnimatedSprite::AnimatedSprite(const char *szImageFile, const char *szMaskFile, const RECT& rcFirstFrame, int iFrameCount) 
-			: Sprite (szImageFile, szMaskFile)
+AnimatedSprite::AnimatedSprite(const char *szImageFile, const char *szMaskFile, const RECT& rcFirstFrame, int iFrameCount, const CAssetLoader *pAssets) 
+			: Sprite (szImageFile, szMaskFile, pAssets)
 {
 	mptFrameCrop.x = rcFirstFrame.left;
 	mptFrameCrop.y = rcFirstFrame.top;
@@ -220,38 +250,16 @@ void AnimatedSprite::draw()
 	if( mpBackBuffer == NULL )
 		return;
 
-	// The position BitBlt wants is not the sprite's center
+	// The position the blitter wants is not the sprite's center
 	// position; rather, it wants the upper-left position,
 	// so compute that.
 	int w = miFrameWidth;
 	int h = miFrameHeight;
 
-	HDC hBackBufferDC = mpBackBuffer->getDC();
-
 	// Upper-left corner.
 	int x = (int)mPosition.x - (w / 2);
 	int y = (int)mPosition.y - (h / 2);
 
-	// Note: For this masking technique to work, it is assumed
-	// the backbuffer bitmap has been cleared to some
-	// non-zero value.
-	// Select the mask bitmap.
-	HGDIOBJ oldObj = SelectObject(mhSpriteDC, mhMask);
-
-	// Draw the mask to the backbuffer with SRCAND. This
-	// only draws the black pixels in the mask to the backbuffer,
-	// thereby marking the pixels we want to draw the sprite
-	// image onto.
-	BitBlt(hBackBufferDC, x, y, w, h, mhSpriteDC, mptFrameCrop.x, mptFrameCrop.y, SRCAND);
-
-	// Now select the image bitmap.
-	SelectObject(mhSpriteDC, mhImage);
-
-	// Draw the image to the backbuffer with SRCPAINT. This
-	// will only draw the image onto the pixels that where previously
-	// marked black by the mask.
-	BitBlt(hBackBufferDC, x, y, w, h, mhSpriteDC, mptFrameCrop.x, mptFrameCrop.y, SRCPAINT);
-
-	// Restore the original bitmap object.
-	SelectObject(mhSpriteDC, oldObj);
+	// Same as Sprite::draw, for the current frame only.
+	blit(x, y, mptFrameCrop.x, mptFrameCrop.y, w, h);
 }
\ No newline at end of file
@@ -0,0 +1,310 @@
+//-----------------------------------------------------------------------------
+// File: SpriteAtlas.cpp
+//
+// Desc: Packs the sprite images into a few large surfaces.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSpriteAtlas Specific Includes
+//-----------------------------------------------------------------------------
+#include "SpriteAtlas.h"
+#include "TiledCompositor.h"
+#include <algorithm>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Name : CSpriteAtlas () (Constructor)
+// Desc : CSpriteAtlas Class Constructor
+//-----------------------------------------------------------------------------
+CSpriteAtlas::CSpriteAtlas()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CSpriteAtlas () (Destructor)
+// Desc : CSpriteAtlas Class Destructor
+//-----------------------------------------------------------------------------
+CSpriteAtlas::~CSpriteAtlas()
+{
+	Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Add ()
+// Desc : Queues an image (once).
+//-----------------------------------------------------------------------------
+int CSpriteAtlas::Add(const std::shared_ptr<const SpriteImage>& pImage)
+{
+	int iIndex = Find(pImage);
+
+	if (iIndex >= 0)
+		return iIndex;
+
+	AtlasRect rc = { 0, 0, 0, pImage->image.Width(), pImage->image.Height(), !pImage->mask.IsEmpty(), pImage->uColorKey };
+
+	m_Images.push_back(pImage);
+	m_Rects.push_back(rc);
+
+	return (int)m_Images.size() - 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Find ()
+// Desc : Images are told apart by address, the cache shares them. The atlas
+//		holds the images it has, so none of them can be freed and its
+//		address reused by another one.
+//-----------------------------------------------------------------------------
+int CSpriteAtlas::Find(const std::shared_ptr<const SpriteImage>& pImage) const
+{
+	for (std::size_t i = 0; i < m_Images.size(); i++)
+	{
+		if (m_Images[i] == pImage)
+			return (int)i;
+	}
+
+	return -1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees the pages and forgets every image.
+//-----------------------------------------------------------------------------
+void CSpriteAtlas::Release()
+{
+	ReleaseSprites();
+
+	for (std::size_t i = 0; i < m_Pages.size(); i++)
+	{
+		delete m_Pages[i];
+	}
+
+	m_Pages.clear();
+	m_Images.clear();
+	m_Rects.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReleaseSprites () (Private)
+// Desc : Frees the spans, before the pages they point into.
+//-----------------------------------------------------------------------------
+void CSpriteAtlas::ReleaseSprites()
+{
+	for (std::size_t i = 0; i < m_Sprites.size(); i++)
+	{
+		delete m_Sprites[i];
+	}
+
+	m_Sprites.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build ()
+// Desc : The tallest images are placed first, each one goes to the first
+//		page it fits in. The pages are then cropped to the area used, and
+//		every image is compiled into spans over its page.
+//-----------------------------------------------------------------------------
+void CSpriteAtlas::Build(int iPageSize)
+{
+	std::vector<int> order(m_Rects.size());
+	std::vector<Skyline> skylines;
+
+	for (std::size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = (int)i;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [this](int a, int b)
+	{
+		if (m_Rects[a].h != m_Rects[b].h) return m_Rects[a].h > m_Rects[b].h;
+		return m_Rects[a].w > m_Rects[b].w;
+	});
+
+	for (std::size_t i = 0; i < order.size(); i++)
+	{
+		AtlasRect &rc = m_Rects[order[i]];
+
+		if (rc.w <= 0 || rc.h <= 0)
+			continue;
+
+		std::size_t p = 0;
+
+		for (; p < skylines.size(); p++)
+		{
+			if (Place(skylines[p], rc.w, rc.h, rc.x, rc.y))
+				break;
+		}
+
+		if (p == skylines.size())
+		{
+			Skyline sky;
+			sky.iWidth		= std::max(iPageSize, rc.w);
+			sky.iHeight		= std::max(iPageSize, rc.h);
+			sky.iUsedWidth	= 0;
+			sky.iUsedHeight	= 0;
+
+			SkylineSegment seg = { 0, 0, sky.iWidth };
+			sky.segments.push_back(seg);
+
+			skylines.push_back(sky);
+			Place(skylines[p], rc.w, rc.h, rc.x, rc.y);
+		}
+
+		rc.iPage = (int)p;
+	}
+
+	ReleaseSprites();
+
+	for (std::size_t p = 0; p < m_Pages.size(); p++)
+	{
+		delete m_Pages[p];
+	}
+
+	m_Pages.resize(skylines.size());
+
+	for (std::size_t p = 0; p < skylines.size(); p++)
+	{
+		m_Pages[p] = new Page;
+		m_Pages[p]->image.Create(skylines[p].iUsedWidth, skylines[p].iUsedHeight);
+		m_Pages[p]->image.Fill(0);
+		m_Pages[p]->mask.Create(skylines[p].iUsedWidth, skylines[p].iUsedHeight);
+		m_Pages[p]->mask.Fill(0);
+	}
+
+	m_Sprites.resize(m_Rects.size());
+
+	for (std::size_t i = 0; i < m_Rects.size(); i++)
+	{
+		const AtlasRect &rc = m_Rects[i];
+
+		m_Sprites[i] = new CRleSprite;
+
+		if (rc.w <= 0 || rc.h <= 0)
+			continue;
+
+		CopyImage(*m_Images[i], rc);
+
+		const Page &page = *m_Pages[rc.iPage];
+
+		if (rc.bMasked)
+			m_Sprites[i]->BuildFromMask(page.image, page.mask, rc.x, rc.y, rc.w, rc.h);
+		else
+			m_Sprites[i]->BuildFromColorKey(page.image, rc.x, rc.y, rc.w, rc.h, rc.uColorKey);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Place () (Private, Static)
+// Desc : Tries the rectangle at the left edge of every skyline segment and
+//		keeps the position whose bottom is highest (then the leftmost one),
+//		then raises the skyline over it.
+//-----------------------------------------------------------------------------
+bool CSpriteAtlas::Place(Skyline& sky, int w, int h, int& x, int& y)
+{
+	std::vector<SkylineSegment> &segs = sky.segments;
+	int iBest = -1, iBestX = 0, iBestY = 0;
+
+	for (std::size_t i = 0; i < segs.size(); i++)
+	{
+		int iX = segs[i].x;
+
+		// the segments are sorted by x, the next ones are further right
+		if (iX + w > sky.iWidth)
+			break;
+
+		// the rectangle rests on the highest segment below it
+		int iY = 0;
+		for (std::size_t j = i; j < segs.size() && segs[j].x < iX + w; j++)
+		{
+			iY = std::max(iY, segs[j].y);
+		}
+
+		if (iY + h > sky.iHeight)
+			continue;
+
+		// left to right, so a tie keeps the leftmost position
+		if (iBest < 0 || iY < iBestY)
+		{
+			iBest	= (int)i;
+			iBestX	= iX;
+			iBestY	= iY;
+		}
+	}
+
+	if (iBest < 0)
+		return false;
+
+	// the new segment covers [x, x + w), the ones under it are cut or removed
+	SkylineSegment seg = { iBestX, iBestY + h, w };
+	segs.insert(segs.begin() + iBest, seg);
+
+	std::size_t k = iBest + 1;
+	while (k < segs.size() && segs[k].x < iBestX + w)
+	{
+		int iCut = iBestX + w - segs[k].x;
+
+		if (iCut >= segs[k].w)
+		{
+			segs.erase(segs.begin() + k);
+		}
+		else
+		{
+			segs[k].x += iCut;
+			segs[k].w -= iCut;
+			break;
+		}
+	}
+
+	// neighbours at the same height become one segment
+	for (std::size_t i = 0; i + 1 < segs.size(); )
+	{
+		if (segs[i].y == segs[i + 1].y)
+		{
+			segs[i].w += segs[i + 1].w;
+			segs.erase(segs.begin() + i + 1);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	sky.iUsedWidth	= std::max(sky.iUsedWidth, iBestX + w);
+	sky.iUsedHeight	= std::max(sky.iUsedHeight, iBestY + h);
+
+	x = iBestX;
+	y = iBestY;
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CopyImage () (Private)
+// Desc : The mask page is only written for the masked images.
+//-----------------------------------------------------------------------------
+void CSpriteAtlas::CopyImage(const SpriteImage& image, const AtlasRect& rc)
+{
+	Page &page = *m_Pages[rc.iPage];
+
+	for (int y = 0; y < rc.h; y++)
+	{
+		memcpy(page.image.Row(rc.y + y) + rc.x, image.image.Row(y), rc.w * sizeof(uint32_t));
+
+		if (rc.bMasked)
+			memcpy(page.mask.Row(rc.y + y) + rc.x, image.mask.Row(y), rc.w * sizeof(uint32_t));
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Draw ()
+// Desc : The spans of an image only cover the image, so nothing of its
+//		neighbours in the page can be drawn.
+//-----------------------------------------------------------------------------
+void CSpriteAtlas::Draw(CFrameBuffer& dst, int x, int y, int iIndex, int sx, int sy, int w, int h) const
+{
+	m_Sprites[iIndex]->Draw(dst, x, y, sx, sy, w, h);
+}
+
+void CSpriteAtlas::Draw(CTiledCompositor& dst, int x, int y, int iIndex, int sx, int sy, int w, int h) const
+{
+	dst.Rle(x, y, *m_Sprites[iIndex], sx, sy, w, h);
+}
@@ -0,0 +1,158 @@
+//-----------------------------------------------------------------------------
+// File: ThreadPool.cpp
+//
+// Desc: Small pool of worker threads for data parallel loops.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CThreadPool Specific Includes
+//-----------------------------------------------------------------------------
+#include "ThreadPool.h"
+
+//-----------------------------------------------------------------------------
+// Name : CThreadPool () (Constructor)
+// Desc : CThreadPool Class Constructor
+//-----------------------------------------------------------------------------
+CThreadPool::CThreadPool(int iThreads)
+{
+	m_bQuit = false;
+
+	if (iThreads <= 0)
+	{
+		iThreads = (int)std::thread::hardware_concurrency();
+		if (iThreads <= 0) iThreads = 1;
+	}
+
+	// the calling thread is the first one
+	for (int i = 1; i < iThreads; i++)
+	{
+		m_Workers.push_back(std::thread(&CThreadPool::WorkerLoop, this));
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CThreadPool () (Destructor)
+// Desc : CThreadPool Class Destructor
+//-----------------------------------------------------------------------------
+CThreadPool::~CThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_bQuit = true;
+	}
+
+	m_JobReady.notify_all();
+
+	for (std::size_t i = 0; i < m_Workers.size(); i++)
+	{
+		m_Workers[i].join();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Shared () (Static)
+// Desc : Created on first use, lives until the program exits.
+//-----------------------------------------------------------------------------
+CThreadPool& CThreadPool::Shared()
+{
+	static CThreadPool pool;
+	return pool;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RangeCount () (Private)
+// Desc : One range per thread, fewer if that would make them smaller than
+//		the grain.
+//-----------------------------------------------------------------------------
+int CThreadPool::RangeCount(int iCount, int iGrain) const
+{
+	if (iGrain < 1) iGrain = 1;
+
+	int nRanges = (iCount + iGrain - 1) / iGrain;
+
+	return (nRanges < ThreadCount()) ? nRanges : ThreadCount();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Run () (Private)
+// Desc : Queues every range but the first, runs the first one on the caller
+//		then helps with the queue until all the ranges are finished.
+//-----------------------------------------------------------------------------
+void CThreadPool::Run(int iCount, int nRanges, const std::function<void(int, int)>& fn)
+{
+	int iRemaining = nRanges - 1;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		for (int r = 1; r < nRanges; r++)
+		{
+			int iBegin = (int)((long long)iCount * r / nRanges);
+			int iEnd = (int)((long long)iCount * (r + 1) / nRanges);
+
+			// iRemaining and fn live on this stack frame, which outlives the
+			// job because we do not return before iRemaining reaches 0
+			m_Jobs.push_back([&fn, &iRemaining, iBegin, iEnd, this]()
+			{
+				fn(iBegin, iEnd);
+
+				std::lock_guard<std::mutex> done(m_Mutex);
+				iRemaining--;
+			});
+		}
+	}
+
+	m_JobReady.notify_all();
+
+	fn(0, (int)((long long)iCount / nRanges));
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+
+	while (iRemaining > 0)
+	{
+		if (!RunPending(lock))
+		{
+			m_JobDone.wait(lock);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : RunPending () (Private)
+// Desc : Pops a job and runs it with the lock released.
+//-----------------------------------------------------------------------------
+bool CThreadPool::RunPending(std::unique_lock<std::mutex>& lock)
+{
+	if (m_Jobs.empty())
+	{
+		return false;
+	}
+
+	std::function<void()> job = m_Jobs.front();
+	m_Jobs.pop_front();
+
+	lock.unlock();
+	job();
+	lock.lock();
+
+	m_JobDone.notify_all();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WorkerLoop () (Private)
+// Desc : Body of the worker threads, sleeps until there is a job or the
+//		pool is destroyed.
+//-----------------------------------------------------------------------------
+void CThreadPool::WorkerLoop()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+
+	while (!m_bQuit)
+	{
+		if (!RunPending(lock))
+		{
+			m_JobReady.wait(lock);
+		}
+	}
+}
@@ -0,0 +1,274 @@
+//-----------------------------------------------------------------------------
+// File: TiledCompositor.cpp
+//
+// Desc: Deferred sprite compositing split in screen tiles.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CTiledCompositor Specific Includes
+//-----------------------------------------------------------------------------
+#include "TiledCompositor.h"
+#include "Blitters.h"
+#include "DirtyRegion.h"
+#include "RleSprite.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Name : CTiledCompositor () (Constructor)
+// Desc : CTiledCompositor Class Constructor
+//-----------------------------------------------------------------------------
+CTiledCompositor::CTiledCompositor(int iTileSize)
+{
+	m_iTileSize = std::max(iTileSize, 8);
+	m_iNextTile = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CTiledCompositor () (Destructor)
+// Desc : CTiledCompositor Class Destructor
+//-----------------------------------------------------------------------------
+CTiledCompositor::~CTiledCompositor()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Copy () / ColorKey () / Mask () / Rle ()
+// Desc : Record a blit for the next Flush(). The fields an operation doesn't
+//		use stay zero.
+//-----------------------------------------------------------------------------
+void CTiledCompositor::Copy(int x, int y, const CFrameBuffer& src, int sx, int sy, int w, int h)
+{
+	Command cmd = Command();
+	cmd.pSource			= &src;
+	cmd.iSourceWidth	= src.Width();
+	cmd.iSourceHeight	= src.Height();
+
+	Record(cmd, OP_COPY, x, y, sx, sy, w, h);
+}
+
+void CTiledCompositor::ColorKey(int x, int y, const CFrameBuffer& src, int sx, int sy, int w, int h, uint32_t uKey)
+{
+	Command cmd = Command();
+	cmd.pSource			= &src;
+	cmd.iSourceWidth	= src.Width();
+	cmd.iSourceHeight	= src.Height();
+	cmd.uColorKey		= uKey;
+
+	Record(cmd, OP_COLORKEY, x, y, sx, sy, w, h);
+}
+
+void CTiledCompositor::Mask(int x, int y, const CFrameBuffer& src, const CFrameBuffer& mask, int sx, int sy, int w, int h)
+{
+	Command cmd = Command();
+	cmd.pSource			= &src;
+	cmd.pMask			= &mask;
+	cmd.iSourceWidth	= src.Width();
+	cmd.iSourceHeight	= src.Height();
+
+	Record(cmd, OP_MASK, x, y, sx, sy, w, h);
+}
+
+void CTiledCompositor::Rle(int x, int y, const CRleSprite& sprite, int sx, int sy, int w, int h)
+{
+	Command cmd = Command();
+	cmd.pSprite			= &sprite;
+	cmd.iSourceWidth	= sprite.Width();
+	cmd.iSourceHeight	= sprite.Height();
+
+	Record(cmd, OP_RLE, x, y, sx, sy, w, h);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Record () (Private)
+// Desc : The blits that can't draw anything are dropped at once.
+//-----------------------------------------------------------------------------
+void CTiledCompositor::Record(Command& cmd, EOp eOp, int x, int y, int sx, int sy, int w, int h)
+{
+	if (cmd.iSourceWidth <= 0 || cmd.iSourceHeight <= 0 || w <= 0 || h <= 0)
+		return;
+
+	cmd.eOp			= eOp;
+	cmd.x			= x;
+	cmd.y			= y;
+	cmd.sx			= sx;
+	cmd.sy			= sy;
+	cmd.w			= w;
+	cmd.h			= h;
+
+	m_Commands.push_back(cmd);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Forgets the recorded blits.
+//-----------------------------------------------------------------------------
+void CTiledCompositor::Clear()
+{
+	m_Commands.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Bin () (Private)
+// Desc : Counting sort of the commands by tile: the tiles a command touches
+//		come from its rectangle clipped like CBlitter clips it, the counts
+//		give the start of every bin, then the commands are stored in order.
+//-----------------------------------------------------------------------------
+void CTiledCompositor::Bin(const CFrameBuffer& dst, int nColumns, int nRows, CDirtyRegion *pDirty)
+{
+	int nCommands = (int)m_Commands.size();
+
+	m_BinStart.assign(nColumns * nRows + 1, 0);
+	m_Spans.resize(nCommands * 4);
+
+	for (int i = 0; i < nCommands; i++)
+	{
+		const Command &cmd = m_Commands[i];
+		int *pSpan = &m_Spans[i * 4];
+		int x = cmd.x, y = cmd.y, sx = cmd.sx, sy = cmd.sy, w = cmd.w, h = cmd.h;
+
+		// same clipping as CBlitter::Clip
+		if (sx < 0) { x -= sx; w += sx; sx = 0; }
+		if (sy < 0) { y -= sy; h += sy; sy = 0; }
+		if (sx + w > cmd.iSourceWidth)  w = cmd.iSourceWidth - sx;
+		if (sy + h > cmd.iSourceHeight) h = cmd.iSourceHeight - sy;
+
+		if (x < 0) { w += x; x = 0; }
+		if (y < 0) { h += y; y = 0; }
+		if (x + w > dst.Width())  w = dst.Width() - x;
+		if (y + h > dst.Height()) h = dst.Height() - y;
+
+		if (w <= 0 || h <= 0)
+		{
+			// in no tile
+			pSpan[0] = pSpan[1] = 0;
+			pSpan[2] = pSpan[3] = -1;
+			continue;
+		}
+
+		if (pDirty != NULL)
+			pDirty->Mark(x, y, w, h);
+
+		pSpan[0] = x / m_iTileSize;
+		pSpan[1] = y / m_iTileSize;
+		pSpan[2] = (x + w - 1) / m_iTileSize;
+		pSpan[3] = (y + h - 1) / m_iTileSize;
+
+		for (int ty = pSpan[1]; ty <= pSpan[3]; ty++)
+		{
+			for (int tx = pSpan[0]; tx <= pSpan[2]; tx++)
+				m_BinStart[ty * nColumns + tx + 1]++;
+		}
+	}
+
+	for (int t = 0; t < nColumns * nRows; t++)
+	{
+		m_BinStart[t + 1] += m_BinStart[t];
+	}
+
+	// m_BinStart[t] is moved to the end of bin t while it is filled, and
+	// back afterwards
+	m_BinCommands.resize(m_BinStart[nColumns * nRows]);
+
+	for (int i = 0; i < nCommands; i++)
+	{
+		const int *pSpan = &m_Spans[i * 4];
+
+		for (int ty = pSpan[1]; ty <= pSpan[3]; ty++)
+		{
+			for (int tx = pSpan[0]; tx <= pSpan[2]; tx++)
+				m_BinCommands[m_BinStart[ty * nColumns + tx]++] = i;
+		}
+	}
+
+	for (int t = nColumns * nRows; t > 0; t--)
+	{
+		m_BinStart[t] = m_BinStart[t - 1];
+	}
+
+	m_BinStart[0] = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawTile () (Private)
+// Desc : The tile is a view of dst, the blits are moved to its corner and
+//		CBlitter clips them to it.
+//-----------------------------------------------------------------------------
+void CTiledCompositor::DrawTile(CFrameBuffer& dst, int iTile, int nColumns) const
+{
+	int x0 = (iTile % nColumns) * m_iTileSize;
+	int y0 = (iTile / nColumns) * m_iTileSize;
+
+	CFrameBuffer tile;
+	tile.Attach(dst.Row(y0) + x0, std::min(m_iTileSize, dst.Width() - x0), std::min(m_iTileSize, dst.Height() - y0), dst.Pitch());
+
+	for (int k = m_BinStart[iTile]; k < m_BinStart[iTile + 1]; k++)
+	{
+		const Command &cmd = m_Commands[m_BinCommands[k]];
+
+		switch (cmd.eOp)
+		{
+		case OP_COPY:
+			CBlitter::Copy(tile, cmd.x - x0, cmd.y - y0, *cmd.pSource, cmd.sx, cmd.sy, cmd.w, cmd.h);
+			break;
+
+		case OP_COLORKEY:
+			CBlitter::ColorKey(tile, cmd.x - x0, cmd.y - y0, *cmd.pSource, cmd.sx, cmd.sy, cmd.w, cmd.h, cmd.uColorKey);
+			break;
+
+		case OP_MASK:
+			CBlitter::Mask(tile, cmd.x - x0, cmd.y - y0, *cmd.pSource, *cmd.pMask, cmd.sx, cmd.sy, cmd.w, cmd.h);
+			break;
+
+		case OP_RLE:
+			cmd.pSprite->Draw(tile, cmd.x - x0, cmd.y - y0, cmd.sx, cmd.sy, cmd.w, cmd.h);
+			break;
+		}
+	}
+
+	tile.Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Flush ()
+// Desc : The tiles don't overlap, so they can be drawn in any order and on
+//		any thread. Every thread claims the next tile until none is left, as
+//		the tiles under the crowds of bullets take much longer than the rest.
+//-----------------------------------------------------------------------------
+void CTiledCompositor::Flush(CFrameBuffer& dst, CThreadPool *pPool, CDirtyRegion *pDirty)
+{
+	if (m_Commands.empty() || dst.IsEmpty())
+	{
+		Clear();
+		return;
+	}
+
+	int nColumns = (dst.Width() + m_iTileSize - 1) / m_iTileSize;
+	int nRows = (dst.Height() + m_iTileSize - 1) / m_iTileSize;
+	int nTiles = nColumns * nRows;
+
+	Bin(dst, nColumns, nRows, pDirty);
+
+	m_iNextTile = 0;
+
+	auto claim = [this, &dst, nTiles, nColumns](int, int)
+	{
+		for (int t = m_iNextTile++; t < nTiles; t = m_iNextTile++)
+		{
+			if (m_BinStart[t] < m_BinStart[t + 1])
+				DrawTile(dst, t, nColumns);
+		}
+	};
+
+	if (pPool != NULL)
+	{
+		// one range per thread, each one claims tiles until they run out
+		pPool->ParallelFor(pPool->ThreadCount(), 1, claim);
+	}
+	else
+	{
+		claim(0, 1);
+	}
+
+	Clear();
+}
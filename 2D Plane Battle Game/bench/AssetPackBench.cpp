@@ -0,0 +1,122 @@
+//-----------------------------------------------------------------------------
+// File: AssetPackBench.cpp
+//
+// Desc: Startup load of the bitmaps of Data through CAssetLoader, decoding
+//		the loose files against attaching them from an asset pack built
+//		from the same files (opening the pack is counted). Both must give
+//		the same pixels.
+//
+//		AssetPackBench [pack file] [loads]	(assets.pack in the current
+//											directory by default)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// AssetPackBench Specific Includes
+//-----------------------------------------------------------------------------
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "ThreadPool.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Name : TimeLoad ()
+// Desc : Best of the loads, in milliseconds. szPack opens the pack first.
+//-----------------------------------------------------------------------------
+static double TimeLoad(const std::vector<std::string>& files, const char *szPack, CThreadPool *pPool, int iLoads)
+{
+	double fBest = 1e30;
+
+	for (int k = 0; k < iLoads; k++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		CAssetPack pack;
+		CAssetLoader loader;
+
+		if (szPack)
+		{
+			pack.Open(szPack);
+			loader.SetPack(&pack);
+		}
+
+		for (size_t i = 0; i < files.size(); i++)
+			loader.Add(files[i].c_str());
+
+		loader.Start(pPool);
+		loader.Wait();
+
+		fBest = std::min(fBest, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return fBest;
+}
+
+int main(int argc, char **argv)
+{
+	const char *szPack = argc > 1 ? argv[1] : "assets.pack";
+	int iLoads = argc > 2 ? atoi(argv[2]) : 50;
+
+	const char *szNames[] = { "PlaneImg.bmp", "PlaneImgAndMask.bmp", "PlaneMask.bmp", "bullet1.bmp",
+							  "bullet1_mask.bmp", "enemy_plane.bmp", "explosion.bmp", "explosionmask.bmp" };
+	const int nNames = sizeof(szNames) / sizeof(szNames[0]);
+	std::vector<std::string> files;
+
+	for (int i = 0; i < nNames; i++)
+		files.push_back(std::string(GAME_DATA_DIR) + "/" + szNames[i]);
+
+	if (CAssetPack::Build(szPack, files) != nNames)
+	{
+		printf("can't build %s from %s\n", szPack, GAME_DATA_DIR);
+		return 1;
+	}
+
+	int iFailures = 0;
+	CAssetPack pack;
+
+	if (!pack.Open(szPack))
+	{
+		printf("can't open %s\n", szPack);
+		return 1;
+	}
+
+	for (int i = 0; i < nNames; i++)
+	{
+		CFrameBuffer loose, packed;
+
+		if (!CBmpDecoder::LoadFile(files[i].c_str(), loose) || !pack.GetImage(files[i].c_str(), packed) ||
+			loose.Width() != packed.Width() || loose.Height() != packed.Height())
+		{
+			printf("%s: not in the pack, or not the same size\n", szNames[i]);
+			iFailures++;
+			continue;
+		}
+
+		for (int y = 0; y < loose.Height(); y++)
+		{
+			if (memcmp(loose.Row(y), packed.Row(y), loose.Width() * sizeof(uint32_t)) != 0)
+			{
+				printf("%s: row %d differs in the pack\n", szNames[i], y);
+				iFailures++;
+				break;
+			}
+		}
+	}
+
+	CThreadPool pool;
+
+	printf("%d bitmaps, best of %d loads\n", nNames, iLoads);
+	printf("  loose files, one thread   %8.3f ms\n", TimeLoad(files, NULL, NULL, iLoads));
+	printf("  loose files, pool of %-4d %8.3f ms\n", pool.ThreadCount(), TimeLoad(files, NULL, &pool, iLoads));
+	printf("  pack, one thread          %8.3f ms\n", TimeLoad(files, szPack, NULL, iLoads));
+
+	if (iFailures)
+		printf("%d failures\n", iFailures);
+
+	return iFailures ? 1 : 0;
+}
@@ -0,0 +1,200 @@
+//-----------------------------------------------------------------------------
+// File: AtlasBench.cpp
+//
+// Desc: Frames of mixed sprites (planes, enemies, bullets and explosion
+//		frames at random places of a 1920x1080 frame) drawn from the
+//		surfaces of every image with CBlitter, from the RLE spans of every
+//		image, and from the pages of a CSpriteAtlas. The three must draw
+//		the same frame.
+//
+//		AtlasBench [sprites] [frames]
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// AtlasBench Specific Includes
+//-----------------------------------------------------------------------------
+#include "SpriteAtlas.h"
+#include "Blitters.h"
+#include "ImageCache.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+typedef std::shared_ptr<const SpriteImage> ImagePtr;
+
+static const int EXPLOSION_FRAME = 128;		// explosion.bmp is 4 x 4 frames
+
+struct BenchSprite
+{
+	int					iImage;
+	int					x, y;
+	int					sx, sy, w, h;
+};
+
+static ImagePtr LoadMasked(CImageCache& cache, const char *szImage, const char *szMask)
+{
+	std::string image = std::string(GAME_DATA_DIR) + "/" + szImage;
+	std::string mask = std::string(GAME_DATA_DIR) + "/" + szMask;
+
+	return cache.GetMasked(image.c_str(), mask.c_str(), CBmpDecoder::LoadFile);
+}
+
+static ImagePtr LoadColorKeyed(CImageCache& cache, const char *szImage)
+{
+	std::string image = std::string(GAME_DATA_DIR) + "/" + szImage;
+
+	return cache.GetColorKeyed(image.c_str(), 0x00FF00FF, CBmpDecoder::LoadFile);
+}
+
+static double TimeFrames(CFrameBuffer& frame, int iFrames, const std::function<void()>& draw)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int f = 0; f < iFrames; f++)
+	{
+		frame.Fill(0x00123456);
+		draw();
+	}
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iFrames;
+}
+
+int main(int argc, char **argv)
+{
+	int iSprites = argc > 1 ? atoi(argv[1]) : 5000;
+	int iFrames = argc > 2 ? atoi(argv[2]) : 20;
+
+	CImageCache cache;
+	ImagePtr images[] =
+	{
+		LoadColorKeyed(cache, "PlaneImgAndMask.bmp"),
+		LoadColorKeyed(cache, "enemy_plane.bmp"),
+		LoadMasked(cache, "bullet1.bmp", "bullet1_mask.bmp"),
+		LoadMasked(cache, "explosion.bmp", "explosionmask.bmp"),
+	};
+	const int nImages = sizeof(images) / sizeof(images[0]);
+
+	CSpriteAtlas atlas;
+
+	for (int i = 0; i < nImages; i++)
+	{
+		if (!images[i])
+		{
+			printf("can't load the sprites from %s\n", GAME_DATA_DIR);
+			return 1;
+		}
+
+		atlas.Add(images[i]);
+	}
+
+	atlas.Build();
+
+	// mostly bullets, like a busy frame of the game
+	CTestRandom random(1);
+	std::vector<BenchSprite> sprites(iSprites);
+
+	for (int i = 0; i < iSprites; i++)
+	{
+		BenchSprite &s = sprites[i];
+		int r = random.Range(0, 9);
+
+		s.iImage = r < 6 ? 2 : (r < 8 ? 3 : r - 8);
+		s.x = random.Range(-100, 1920);
+		s.y = random.Range(-100, 1080);
+
+		const CFrameBuffer &image = images[s.iImage]->image;
+
+		if (s.iImage == 3)
+		{
+			s.sx = random.Range(0, 3) * EXPLOSION_FRAME;
+			s.sy = random.Range(0, 3) * EXPLOSION_FRAME;
+			s.w = s.h = EXPLOSION_FRAME;
+		}
+		else
+		{
+			s.sx = s.sy = 0;
+			s.w = image.Width();
+			s.h = image.Height();
+		}
+	}
+
+	CFrameBuffer blitFrame, rleFrame, atlasFrame;
+	blitFrame.Create(1920, 1080);
+	rleFrame.Create(1920, 1080);
+	atlasFrame.Create(1920, 1080);
+
+	std::function<void()> drawBlit = [&]()
+	{
+		for (int i = 0; i < iSprites; i++)
+		{
+			const BenchSprite &s = sprites[i];
+			const SpriteImage &image = *images[s.iImage];
+
+			if (image.mask.IsEmpty())
+				CBlitter::ColorKey(blitFrame, s.x, s.y, image.image, s.sx, s.sy, s.w, s.h, image.uColorKey);
+			else
+				CBlitter::Mask(blitFrame, s.x, s.y, image.image, image.mask, s.sx, s.sy, s.w, s.h);
+		}
+	};
+
+	std::function<void()> drawRle = [&]()
+	{
+		for (int i = 0; i < iSprites; i++)
+		{
+			const BenchSprite &s = sprites[i];
+			images[s.iImage]->rle.Draw(rleFrame, s.x, s.y, s.sx, s.sy, s.w, s.h);
+		}
+	};
+
+	std::function<void()> drawAtlas = [&]()
+	{
+		for (int i = 0; i < iSprites; i++)
+		{
+			const BenchSprite &s = sprites[i];
+			atlas.Draw(atlasFrame, s.x, s.y, s.iImage, s.sx, s.sy, s.w, s.h);
+		}
+	};
+
+	// the best of a few interleaved rounds, the machine is rarely quiet
+	double fBlit = 1e30, fRle = 1e30, fAtlas = 1e30;
+
+	for (int r = 0; r < 3; r++)
+	{
+		fBlit = std::min(fBlit, TimeFrames(blitFrame, iFrames, drawBlit));
+		fRle = std::min(fRle, TimeFrames(rleFrame, iFrames, drawRle));
+		fAtlas = std::min(fAtlas, TimeFrames(atlasFrame, iFrames, drawAtlas));
+	}
+
+	int iFailures = 0;
+	size_t uBytes = (size_t)1920 * 1080 * sizeof(uint32_t);
+
+	if (memcmp(blitFrame.Pixels(), atlasFrame.Pixels(), uBytes) != 0)
+	{
+		printf("the atlas frame differs from the blitted one\n");
+		iFailures++;
+	}
+
+	if (memcmp(rleFrame.Pixels(), atlasFrame.Pixels(), uBytes) != 0)
+	{
+		printf("the atlas frame differs from the RLE one\n");
+		iFailures++;
+	}
+
+	printf("%d sprites, %d frames, %d atlas page(s) of %dx%d\n", iSprites, iFrames,
+		   atlas.PageCount(), atlas.PageImage(0).Width(), atlas.PageImage(0).Height());
+	printf("  image surfaces, CBlitter  %8.2f ms/frame\n", fBlit * 1e3);
+	printf("  image RLE spans           %8.2f ms/frame\n", fRle * 1e3);
+	printf("  atlas                     %8.2f ms/frame\n", fAtlas * 1e3);
+
+	if (iFailures)
+		printf("%d failures\n", iFailures);
+
+	return iFailures ? 1 : 0;
+}
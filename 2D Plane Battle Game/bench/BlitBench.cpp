@@ -0,0 +1,100 @@
+//-----------------------------------------------------------------------------
+// File: BlitBench.cpp
+//
+// Desc: Times the blitters on the sprites of the game, drawn at random
+//		places of a 1920x1080 frame, with every kernel path the processor
+//		has.
+//
+//		BlitBench [blits per sprite]
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BlitBench Specific Includes
+//-----------------------------------------------------------------------------
+#include "Blitters.h"
+#include "TestSupport.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char *s_szPath[] = { "scalar", "SSE2", "AVX2" };
+
+struct BenchSprite
+{
+	const char		*szName;
+	const char		*szImage;
+	const char		*szMask;			// NULL for the color keyed sprites
+	int				iFrameSize;			// 0: the whole image is one frame
+	CFrameBuffer	image, mask;
+};
+
+int main(int argc, char **argv)
+{
+	int iBlits = argc > 1 ? atoi(argv[1]) : 20000;
+
+	BenchSprite sprites[] =
+	{
+		{ "plane (key)",		"PlaneImgAndMask.bmp",	NULL,					0 },
+		{ "enemy (key)",		"enemy_plane.bmp",		NULL,					0 },
+		{ "plane (mask)",		"PlaneImg.bmp",			"PlaneMask.bmp",		0 },
+		{ "bullet (mask)",		"bullet1.bmp",			"bullet1_mask.bmp",		0 },
+		{ "explosion (mask)",	"explosion.bmp",		"explosionmask.bmp",	128 },
+	};
+
+	for (size_t i = 0; i < sizeof(sprites) / sizeof(sprites[0]); i++)
+	{
+		BenchSprite &sprite = sprites[i];
+
+		if (!LoadGameBitmap(sprite.szImage, sprite.image) || (sprite.szMask && !LoadGameBitmap(sprite.szMask, sprite.mask)))
+			return 1;
+	}
+
+	CFrameBuffer frame;
+	frame.Create(1920, 1080);
+	frame.Fill(0x00336699);
+
+	printf("%-18s %-7s %10s %12s\n", "sprite", "path", "ns/blit", "Mpixels/s");
+
+	for (size_t i = 0; i < sizeof(sprites) / sizeof(sprites[0]); i++)
+	{
+		BenchSprite &sprite = sprites[i];
+		int w = sprite.iFrameSize ? sprite.iFrameSize : sprite.image.Width();
+		int h = sprite.iFrameSize ? sprite.iFrameSize : sprite.image.Height();
+		int iFrames = (sprite.image.Width() / w) * (sprite.image.Height() / h);
+		double fBaseline = 0;
+
+		for (int p = CBlitter::PATH_SCALAR; p <= CBlitter::GetBestPath(); p++)
+		{
+			CTestRandom random(7);
+			CBlitter::SetPath((CBlitter::EPath)p);
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			for (int n = 0; n < iBlits; n++)
+			{
+				// the whole sprite stays on the frame, every blit draws w x h
+				int x = random.Range(0, frame.Width() - w);
+				int y = random.Range(0, frame.Height() - h);
+				int f = n % iFrames;
+				int sx = (f % (sprite.image.Width() / w)) * w;
+				int sy = (f / (sprite.image.Width() / w)) * h;
+
+				if (sprite.szMask)
+					CBlitter::Mask(frame, x, y, sprite.image, sprite.mask, sx, sy, w, h);
+				else
+					CBlitter::ColorKey(frame, x, y, sprite.image, sx, sy, w, h, 0x00FF00FF);
+			}
+
+			double fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			double fNs = fSeconds * 1e9 / iBlits;
+
+			if (p == CBlitter::PATH_SCALAR)
+				fBaseline = fNs;
+
+			printf("%-18s %-7s %10.0f %12.0f   x%.2f\n", sprite.szName, s_szPath[p], fNs,
+				   (double)w * h * iBlits / fSeconds / 1e6, fBaseline / fNs);
+		}
+	}
+
+	return 0;
+}
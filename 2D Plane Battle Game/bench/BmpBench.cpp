@@ -0,0 +1,162 @@
+//-----------------------------------------------------------------------------
+// File: BmpBench.cpp
+//
+// Desc: Load time of bitmaps with CBmpDecoder::LoadFile (the file mapped and
+//		decoded straight into the frame buffer) against the copies of the
+//		old CImageFile path: the whole file read into the heap, the pixel
+//		rows copied out of it like GetDIBits does, then converted to 32 bit
+//		one pixel at a time. Only the 24 bit files are loaded the old way,
+//		both must give the same pixels. The file cache is warm for both.
+//
+//		BmpBench [file.bmp ...]		(the bitmaps of Data by default)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BmpBench Specific Includes
+//-----------------------------------------------------------------------------
+#include "BmpDecoder.h"
+#include "TestSupport.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static const int LOADS = 50;
+
+//-----------------------------------------------------------------------------
+// Name : LoadWithCopies ()
+// Desc : The old path for a 24 bit bitmap, false for anything else.
+//-----------------------------------------------------------------------------
+static bool LoadWithCopies(const char *szFileName, std::vector<uint32_t>& pixels, int& w, int& h)
+{
+	FILE *pFile = fopen(szFileName, "rb");
+
+	if (!pFile)
+		return false;
+
+	fseek(pFile, 0, SEEK_END);
+	std::vector<uint8_t> file((size_t)ftell(pFile));
+	fseek(pFile, 0, SEEK_SET);
+	size_t uRead = fread(file.data(), 1, file.size(), pFile);
+	fclose(pFile);
+
+	CBmpDecoder::BmpInfo info;
+
+	if (uRead != file.size() || !CBmpDecoder::ReadInfo(file.data(), file.size(), info) || info.iBitCount != 24)
+		return false;
+
+	w = info.iWidth;
+	h = info.iHeight;
+
+	// GetDIBits: the padded rows, bottom-up, into pData
+	int iStride = (w * 3 + 3) & ~3;
+	uint32_t uOffset;
+	memcpy(&uOffset, &file[10], sizeof(uOffset));
+
+	std::vector<uint8_t> data((size_t)iStride * h);
+
+	for (int y = 0; y < h; y++)
+	{
+		int iFileRow = info.bTopDown ? h - 1 - y : y;
+		memcpy(&data[(size_t)y * iStride], &file[uOffset + (size_t)iFileRow * iStride], iStride);
+	}
+
+	// the conversion loop into m_pRGB, flipped to top-down like CFrameBuffer
+	pixels.resize((size_t)w * h);
+
+	for (int y = 0; y < h; y++)
+	{
+		const uint8_t *s = &data[(size_t)(h - 1 - y) * iStride];
+
+		for (int x = 0; x < w; x++)
+			pixels[(size_t)y * w + x] = s[x * 3] | (s[x * 3 + 1] << 8) | (s[x * 3 + 2] << 16);
+	}
+
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	std::vector<std::string> files;
+
+	for (int i = 1; i < argc; i++)
+		files.push_back(argv[i]);
+
+	if (files.empty())
+	{
+		const char *szNames[] = { "PlaneImg.bmp", "PlaneImgAndMask.bmp", "PlaneMask.bmp", "bullet1.bmp",
+								  "bullet1_mask.bmp", "enemy_plane.bmp", "explosion.bmp", "explosionmask.bmp" };
+
+		for (size_t i = 0; i < sizeof(szNames) / sizeof(szNames[0]); i++)
+			files.push_back(std::string(GAME_DATA_DIR) + "/" + szNames[i]);
+	}
+
+	int iFailures = 0;
+	double fTotalOld = 0, fTotalNew = 0;
+
+	printf("%-24s %10s %12s %12s %8s\n", "file", "size", "copies ms", "mapped ms", "speedup");
+
+	for (size_t f = 0; f < files.size(); f++)
+	{
+		const char *szFile = files[f].c_str();
+		const char *szName = strrchr(szFile, '/') ? strrchr(szFile, '/') + 1 : szFile;
+		CFrameBuffer image;
+
+		if (!CBmpDecoder::LoadFile(szFile, image))
+		{
+			printf("can't decode %s\n", szFile);
+			iFailures++;
+			continue;
+		}
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		for (int k = 0; k < LOADS; k++)
+		{
+			CFrameBuffer loaded;
+			CBmpDecoder::LoadFile(szFile, loaded);
+		}
+
+		double fNew = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / LOADS;
+
+		std::vector<uint32_t> pixels;
+		int w = 0, h = 0;
+
+		if (!LoadWithCopies(szFile, pixels, w, h))
+		{
+			printf("%-24s %5dx%-4d %12s %12.3f\n", szName, image.Width(), image.Height(), "-", fNew * 1e3);
+			continue;
+		}
+
+		for (int y = 0; y < h; y++)
+		{
+			if (memcmp(image.Row(y), &pixels[(size_t)y * w], w * sizeof(uint32_t)) != 0)
+			{
+				printf("%s: row %d differs from the old path\n", szName, y);
+				iFailures++;
+				break;
+			}
+		}
+
+		start = std::chrono::steady_clock::now();
+
+		for (int k = 0; k < LOADS; k++)
+			LoadWithCopies(szFile, pixels, w, h);
+
+		double fOld = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / LOADS;
+
+		fTotalOld += fOld;
+		fTotalNew += fNew;
+
+		printf("%-24s %5dx%-4d %12.3f %12.3f %7.1fx\n", szName, w, h, fOld * 1e3, fNew * 1e3, fOld / fNew);
+	}
+
+	if (fTotalNew > 0)
+		printf("%-24s %10s %12.3f %12.3f %7.1fx\n", "24 bit files", "", fTotalOld * 1e3, fTotalNew * 1e3, fTotalOld / fTotalNew);
+
+	if (iFailures)
+		printf("%d failures\n", iFailures);
+
+	return iFailures ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+//-----------------------------------------------------------------------------
+// File: BroadphaseBench.cpp
+//
+// Desc: Bullets against enemies, every bullet tested against every enemy
+//		(the old Sprite_Collide loop) against the CSpatialGrid of the
+//		game, rebuilt every frame. Both must find the same pairs of
+//		overlapping bounding boxes.
+//
+//		BroadphaseBench [bullets] [enemies] [frames]
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BroadphaseBench Specific Includes
+//-----------------------------------------------------------------------------
+#include "SpatialGrid.h"
+#include "TestSupport.h"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// The playfield, and the sizes of bullet1.bmp and enemy_plane.bmp
+static const int FIELD_WIDTH = 1920, FIELD_HEIGHT = 1080;
+static const float BULLET_W = 30.0f, BULLET_H = 53.0f;
+static const float ENEMY_W = 100.0f, ENEMY_H = 143.0f;
+
+struct Box
+{
+	float				x, y;			// center
+};
+
+static bool Overlap(const Box& a, float aw, float ah, const Box& b, float bw, float bh)
+{
+	return fabsf(a.x - b.x) * 2 < aw + bw && fabsf(a.y - b.y) * 2 < ah + bh;
+}
+
+static void Scatter(std::vector<Box>& boxes, CTestRandom& random)
+{
+	for (size_t i = 0; i < boxes.size(); i++)
+	{
+		boxes[i].x = (float)random.Range(0, FIELD_WIDTH - 1);
+		boxes[i].y = (float)random.Range(0, FIELD_HEIGHT - 1);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int iBullets = argc > 1 ? atoi(argv[1]) : 10000;
+	int iEnemies = argc > 2 ? atoi(argv[2]) : 500;
+	int iFrames = argc > 3 ? atoi(argv[3]) : 20;
+
+	CTestRandom random(1);
+	std::vector<Box> bullets(iBullets), enemies(iEnemies);
+	CSpatialGrid grid(FIELD_WIDTH, FIELD_HEIGHT, 128);
+	double fBrute = 0, fGrid = 0;
+	long long nPairs = 0, nTests = 0;
+	int iFailures = 0;
+
+	for (int f = 0; f < iFrames; f++)
+	{
+		Scatter(bullets, random);
+		Scatter(enemies, random);
+
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		long long nBrute = 0;
+
+		for (int b = 0; b < iBullets; b++)
+		{
+			for (int e = 0; e < iEnemies; e++)
+			{
+				if (Overlap(bullets[b], BULLET_W, BULLET_H, enemies[e], ENEMY_W, ENEMY_H))
+					nBrute++;
+			}
+		}
+
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+		long long nGrid = 0;
+
+		grid.Clear();
+
+		for (int e = 0; e < iEnemies; e++)
+			grid.InsertCentered(e, enemies[e].x, enemies[e].y, ENEMY_W, ENEMY_H);
+
+		grid.Build();
+
+		for (int b = 0; b < iBullets; b++)
+		{
+			const Box &bullet = bullets[b];
+
+			grid.QueryCentered(bullet.x, bullet.y, BULLET_W, BULLET_H, [&](int e)
+			{
+				nTests++;
+
+				if (Overlap(bullet, BULLET_W, BULLET_H, enemies[e], ENEMY_W, ENEMY_H))
+					nGrid++;
+
+				return false;
+			});
+		}
+
+		std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+		fBrute += std::chrono::duration<double>(t1 - t0).count();
+		fGrid += std::chrono::duration<double>(t2 - t1).count();
+		nPairs += nBrute;
+
+		if (nBrute != nGrid)
+		{
+			printf("frame %d: brute force found %lld pairs, the grid %lld\n", f, nBrute, nGrid);
+			iFailures++;
+		}
+	}
+
+	printf("%d bullets x %d enemies, %d frames, %.1f overlapping pairs a frame\n", iBullets, iEnemies, iFrames, (double)nPairs / iFrames);
+	printf("  brute force  %8.3f ms/frame  %10lld tests/frame\n", fBrute * 1e3 / iFrames, (long long)iBullets * iEnemies);
+	printf("  grid         %8.3f ms/frame  %10lld tests/frame\n", fGrid * 1e3 / iFrames, nTests / iFrames);
+	printf("  speedup      %8.1fx\n", fBrute / fGrid);
+
+	if (iFailures)
+		printf("%d failures\n", iFailures);
+
+	return iFailures ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+//-----------------------------------------------------------------------------
+// File: CollisionBench.cpp
+//
+// Desc: Cost and accuracy of the pixel exact collision test on the shapes
+//		of the game. The second shape is placed at random offsets where the
+//		bounding boxes overlap, so the bounding box test says "hit" every
+//		time; the masks tell how many of those hits were false positives.
+//		The packed CCollisionMask::Overlaps is checked against a per pixel
+//		loop over the intersection.
+//
+//		CollisionBench [tests per pair]
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CollisionBench Specific Includes
+//-----------------------------------------------------------------------------
+#include "CollisionMask.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+struct Offset
+{
+	int					dx, dy;
+};
+
+static bool LoadShape(const char *szName, bool bColorKeyed, CCollisionMask& mask)
+{
+	CFrameBuffer pixels;
+
+	if (!LoadGameBitmap(szName, pixels))
+		return false;
+
+	if (bColorKeyed)
+		mask.BuildFromColorKey(pixels.Pixels(), pixels.Width(), pixels.Height(), pixels.Pitch(), 0x00FF00FF);
+	else
+		mask.BuildFromMask(pixels.Pixels(), pixels.Width(), pixels.Height(), pixels.Pitch());
+
+	return true;
+}
+
+// The per pixel test, over the intersection of the boxes
+static bool OverlapsPerPixel(const CCollisionMask& a, const CCollisionMask& b, int dx, int dy)
+{
+	int x0 = std::max(0, dx), x1 = std::min(a.Width(), dx + b.Width());
+	int y0 = std::max(0, dy), y1 = std::min(a.Height(), dy + b.Height());
+
+	for (int y = y0; y < y1; y++)
+	{
+		for (int x = x0; x < x1; x++)
+		{
+			if (a.Test(x, y) && b.Test(x - dx, y - dy))
+				return true;
+		}
+	}
+
+	return false;
+}
+
+static bool OverlapsBox(const CCollisionMask& a, const CCollisionMask& b, int dx, int dy)
+{
+	return dx < a.Width() && dx + b.Width() > 0 && dy < a.Height() && dy + b.Height() > 0;
+}
+
+int main(int argc, char **argv)
+{
+	int iTests = argc > 1 ? atoi(argv[1]) : 200000;
+
+	CCollisionMask plane, enemy, bullet;
+
+	if (!LoadShape("PlaneImgAndMask.bmp", true, plane) ||
+		!LoadShape("enemy_plane.bmp", true, enemy) ||
+		!LoadShape("bullet1_mask.bmp", false, bullet))
+		return 1;
+
+	struct Pair { const char *szName; const CCollisionMask *a, *b; } pairs[] =
+	{
+		{ "bullet / enemy",	&enemy, &bullet },
+		{ "bullet / plane",	&plane, &bullet },
+		{ "plane / enemy",	&plane, &enemy },
+	};
+
+	CTestRandom random(1);
+	int iFailures = 0;
+
+	printf("%-16s %10s %10s %10s %16s\n", "pair", "box ns", "mask ns", "pixel ns", "false positives");
+
+	for (size_t p = 0; p < sizeof(pairs) / sizeof(pairs[0]); p++)
+	{
+		const CCollisionMask &a = *pairs[p].a, &b = *pairs[p].b;
+		std::vector<Offset> offsets(iTests);
+
+		for (int i = 0; i < iTests; i++)
+		{
+			offsets[i].dx = random.Range(1 - b.Width(), a.Width() - 1);
+			offsets[i].dy = random.Range(1 - b.Height(), a.Height() - 1);
+		}
+
+		std::vector<char> boxHits(iTests), maskHits(iTests), pixelHits(iTests);
+
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < iTests; i++)
+			boxHits[i] = OverlapsBox(a, b, offsets[i].dx, offsets[i].dy);
+
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < iTests; i++)
+			maskHits[i] = a.Overlaps(b, offsets[i].dx, offsets[i].dy);
+
+		std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < iTests; i++)
+			pixelHits[i] = OverlapsPerPixel(a, b, offsets[i].dx, offsets[i].dy);
+
+		std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+
+		int iBoxHits = 0, iMaskHits = 0;
+
+		for (int i = 0; i < iTests; i++)
+		{
+			iBoxHits += boxHits[i];
+			iMaskHits += maskHits[i];
+
+			if (maskHits[i] != pixelHits[i])
+			{
+				if (iFailures++ < 10)
+					printf("%s at (%d, %d): Overlaps %d, per pixel %d\n", pairs[p].szName, offsets[i].dx, offsets[i].dy, maskHits[i], pixelHits[i]);
+			}
+		}
+
+		double fScale = 1e9 / iTests;
+
+		printf("%-16s %10.2f %10.2f %10.2f %15.1f%%\n", pairs[p].szName,
+			std::chrono::duration<double>(t1 - t0).count() * fScale,
+			std::chrono::duration<double>(t2 - t1).count() * fScale,
+			std::chrono::duration<double>(t3 - t2).count() * fScale,
+			100.0 * (iBoxHits - iMaskHits) / iBoxHits);
+	}
+
+	if (iFailures)
+		printf("%d failures\n", iFailures);
+
+	return iFailures ? 1 : 0;
+}
@@ -0,0 +1,82 @@
+//-----------------------------------------------------------------------------
+// File: ColorSpaceBench.cpp
+//
+// Desc: Times ExtractRow and PasteRow of the six channels on a 1920x1080
+//		image (the explosion bitmap tiled over it) with every kernel path
+//		the processor has.
+//
+//		ColorSpaceBench [repeats]
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// ColorSpaceBench Specific Includes
+//-----------------------------------------------------------------------------
+#include "ColorSpace.h"
+#include "TestSupport.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static const char *s_szPath[] = { "scalar", "SSE2", "AVX2" };
+static const char *s_szChannel[] = { "red", "green", "blue", "hue", "saturation", "luminosity" };
+
+int main(int argc, char **argv)
+{
+	int iRepeats = argc > 1 ? atoi(argv[1]) : 10;
+	const int W = 1920, H = 1080;
+
+	CFrameBuffer tile, image;
+
+	if (!LoadGameBitmap("explosion.bmp", tile))
+		return 1;
+
+	image.Create(W, H);
+
+	for (int y = 0; y < H; y++)
+		for (int x = 0; x < W; x++)
+			image.Row(y)[x] = tile.Row(y % tile.Height())[x % tile.Width()];
+
+	std::vector<uint8_t> channel((size_t)W * H);
+	CFrameBuffer pasted;
+	pasted.Create(W, H);
+
+	printf("%-11s %-7s %12s %12s\n", "channel", "path", "extract ms", "paste ms");
+
+	for (int c = CColorSpace::CHANNEL_RED; c <= CColorSpace::CHANNEL_LUMINOSITY; c++)
+	{
+		CColorSpace::EChannel chn = (CColorSpace::EChannel)c;
+
+		for (int p = CColorSpace::PATH_SCALAR; p <= CColorSpace::GetBestPath(); p++)
+		{
+			CColorSpace::SetPath((CColorSpace::EPath)p);
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			for (int r = 0; r < iRepeats; r++)
+				for (int y = 0; y < H; y++)
+					CColorSpace::ExtractRow(chn, &channel[(size_t)y * W], image.Row(y), W);
+
+			std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+
+			for (int r = 0; r < iRepeats; r++)
+			{
+				// paste into a fresh copy, the hue of a pasted pixel would drift
+				for (int y = 0; y < H; y++)
+				{
+					memcpy(pasted.Row(y), image.Row(y), W * sizeof(uint32_t));
+					CColorSpace::PasteRow(chn, pasted.Row(y), &channel[(size_t)y * W], W);
+				}
+			}
+
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+			printf("%-11s %-7s %12.2f %12.2f\n", s_szChannel[c], s_szPath[p],
+				   std::chrono::duration<double, std::milli>(middle - start).count() / iRepeats,
+				   std::chrono::duration<double, std::milli>(end - middle).count() / iRepeats);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,157 @@
+//-----------------------------------------------------------------------------
+// File: CompositorBench.cpp
+//
+// Desc: A 1920x1080 frame of a background and many sprites (mostly bullets,
+//		some enemies and planes, partly off screen) drawn one after the other
+//		with CBlitter, against CTiledCompositor flushed on 1, 2, 4 and 8
+//		threads. Every tiled frame must be the serial one.
+//
+//		CompositorBench [sprites] [tile size]
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CompositorBench Specific Includes
+//-----------------------------------------------------------------------------
+#include "TiledCompositor.h"
+#include "Blitters.h"
+#include "ThreadPool.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static const int FRAME_WIDTH = 1920;
+static const int FRAME_HEIGHT = 1080;
+static const int ROUNDS = 10;
+
+enum ESpriteKind { SPRITE_BULLET, SPRITE_ENEMY, SPRITE_PLANE };
+
+struct BenchSprite
+{
+	ESpriteKind			eKind;
+	int					x, y;
+};
+
+struct BenchImages
+{
+	CFrameBuffer		bullet, bulletMask;
+	CFrameBuffer		enemy;
+	CFrameBuffer		plane, planeMask;
+};
+
+//-----------------------------------------------------------------------------
+// Name : Draw ()
+// Desc : Draws a sprite with CBlitter, or records it in the compositor.
+//-----------------------------------------------------------------------------
+static void Draw(CFrameBuffer& dst, const BenchSprite& s, const BenchImages& img)
+{
+	switch (s.eKind)
+	{
+	case SPRITE_BULLET:	CBlitter::Mask(dst, s.x, s.y, img.bullet, img.bulletMask, 0, 0, img.bullet.Width(), img.bullet.Height()); break;
+	case SPRITE_ENEMY:	CBlitter::ColorKey(dst, s.x, s.y, img.enemy, 0, 0, img.enemy.Width(), img.enemy.Height(), 0x00FF00FF); break;
+	case SPRITE_PLANE:	CBlitter::Mask(dst, s.x, s.y, img.plane, img.planeMask, 0, 0, img.plane.Width(), img.plane.Height()); break;
+	}
+}
+
+static void Draw(CTiledCompositor& dst, const BenchSprite& s, const BenchImages& img)
+{
+	switch (s.eKind)
+	{
+	case SPRITE_BULLET:	dst.Mask(s.x, s.y, img.bullet, img.bulletMask, 0, 0, img.bullet.Width(), img.bullet.Height()); break;
+	case SPRITE_ENEMY:	dst.ColorKey(s.x, s.y, img.enemy, 0, 0, img.enemy.Width(), img.enemy.Height(), 0x00FF00FF); break;
+	case SPRITE_PLANE:	dst.Mask(s.x, s.y, img.plane, img.planeMask, 0, 0, img.plane.Width(), img.plane.Height()); break;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int iSprites = argc > 1 ? atoi(argv[1]) : 10000;
+	int iTileSize = argc > 2 ? atoi(argv[2]) : CTiledCompositor::DEFAULT_TILE_SIZE;
+
+	BenchImages img;
+
+	if (!LoadGameBitmap("bullet1.bmp", img.bullet) || !LoadGameBitmap("bullet1_mask.bmp", img.bulletMask) ||
+		!LoadGameBitmap("enemy_plane.bmp", img.enemy) ||
+		!LoadGameBitmap("PlaneImg.bmp", img.plane) || !LoadGameBitmap("PlaneMask.bmp", img.planeMask))
+		return 1;
+
+	CTestRandom random(1);
+	std::vector<BenchSprite> sprites(iSprites);
+
+	for (int i = 0; i < iSprites; i++)
+	{
+		int r = random.Range(0, 9);
+
+		sprites[i].eKind = r < 7 ? SPRITE_BULLET : (r < 9 ? SPRITE_ENEMY : SPRITE_PLANE);
+		sprites[i].x = random.Range(-100, FRAME_WIDTH + 99);
+		sprites[i].y = random.Range(-100, FRAME_HEIGHT + 99);
+	}
+
+	CFrameBuffer background, serial, tiled;
+	background.Create(FRAME_WIDTH, FRAME_HEIGHT);
+	serial.Create(FRAME_WIDTH, FRAME_HEIGHT);
+	tiled.Create(FRAME_WIDTH, FRAME_HEIGHT);
+
+	for (int y = 0; y < FRAME_HEIGHT; y++)
+		for (int x = 0; x < FRAME_WIDTH; x++)
+			background.Row(y)[x] = ((x * 7 + y * 13) & 0xFF) * 0x00010101;
+
+	// best of the rounds, the background copy is part of the frame
+	double fSerial = 1e30;
+
+	for (int r = 0; r < ROUNDS; r++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		CBlitter::Copy(serial, 0, 0, background, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+
+		for (int i = 0; i < iSprites; i++)
+			Draw(serial, sprites[i], img);
+
+		fSerial = std::min(fSerial, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	printf("%d sprites, %dx%d, tiles of %d\n", iSprites, FRAME_WIDTH, FRAME_HEIGHT, iTileSize);
+	printf("  serial CBlitter      %8.2f ms\n", fSerial);
+
+	int iFailures = 0;
+	size_t uBytes = (size_t)FRAME_WIDTH * FRAME_HEIGHT * sizeof(uint32_t);
+
+	for (int t = 1; t <= 8; t *= 2)
+	{
+		CThreadPool pool(t);
+		CTiledCompositor compositor(iTileSize);
+		double fTiled = 1e30;
+
+		for (int r = 0; r < ROUNDS; r++)
+		{
+			memset(tiled.Pixels(), 0, uBytes);
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			compositor.Copy(0, 0, background, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+
+			for (int i = 0; i < iSprites; i++)
+				Draw(compositor, sprites[i], img);
+
+			compositor.Flush(tiled, &pool);
+
+			fTiled = std::min(fTiled, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		bool bSame = memcmp(tiled.Pixels(), serial.Pixels(), uBytes) == 0;
+
+		if (!bSame)
+			iFailures++;
+
+		printf("  tiled, %d thread(s)   %8.2f ms %5.2fx%s\n", t, fTiled, fSerial / fTiled, bSame ? "" : "  differs from the serial frame");
+	}
+
+	if (iFailures)
+		printf("%d failures\n", iFailures);
+
+	return iFailures ? 1 : 0;
+}
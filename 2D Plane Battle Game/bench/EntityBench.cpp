@@ -0,0 +1,178 @@
+//-----------------------------------------------------------------------------
+// File: EntityBench.cpp
+//
+// Desc: Per entity cost of a bullet update (save the position, move, drop
+//		the ones that left the field, spawn replacements) in CEntityStore
+//		against the std::list of heap objects the game used to keep, each
+//		holding a pointer to a sprite with the position inside.
+//
+//		EntityBench [frames]
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// EntityBench Specific Includes
+//-----------------------------------------------------------------------------
+#include "EntityStore.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static const float FIELD_TOP = 35.0f;
+static const float FIELD_BOTTOM = 960.0f;
+static const float DT = 1.0f / 60.0f;
+
+// The old layout: the list node points to the bullet, the bullet to its
+// sprite, the sprite has the GDI handles and the position / velocity
+struct LegacySprite
+{
+	void				*handles[12];
+	float				x, y;
+	float				vx, vy;
+};
+
+struct LegacyBullet
+{
+	LegacySprite		*pSprite;
+	float				prevX, prevY;
+	int					iFaction;
+};
+
+static float SpawnVelocity(CTestRandom& random)
+{
+	return (random.Range(0, 1) ? -1.0f : 1.0f) * (float)random.Range(60, 600);
+}
+
+//-----------------------------------------------------------------------------
+// Name : RunList ()
+// Desc : The update on the list, returns the seconds of the frames.
+//-----------------------------------------------------------------------------
+static double RunList(int iCount, int iFrames)
+{
+	CTestRandom random(1);
+	std::list<LegacyBullet*> bullets;
+
+	// Allocated in a random order, like bullets fired over a whole match
+	std::vector<LegacyBullet*> pool;
+
+	for (int i = 0; i < iCount; i++)
+	{
+		LegacyBullet *pBullet = new LegacyBullet;
+		pBullet->pSprite = new LegacySprite;
+		pool.push_back(pBullet);
+	}
+
+	for (int i = iCount - 1; i > 0; i--)
+		std::swap(pool[i], pool[random.Range(0, i)]);
+
+	for (int i = 0; i < iCount; i++)
+	{
+		LegacyBullet *pBullet = pool[i];
+		pBullet->pSprite->x = (float)random.Range(0, 1920);
+		pBullet->pSprite->y = (float)random.Range(40, 950);
+		pBullet->pSprite->vx = 0;
+		pBullet->pSprite->vy = SpawnVelocity(random);
+		pBullet->iFaction = i & 1;
+		bullets.push_back(pBullet);
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int f = 0; f < iFrames; f++)
+	{
+		for (std::list<LegacyBullet*>::iterator it = bullets.begin(); it != bullets.end(); )
+		{
+			LegacyBullet *pBullet = *it;
+			LegacySprite *pSprite = pBullet->pSprite;
+
+			pBullet->prevX = pSprite->x;
+			pBullet->prevY = pSprite->y;
+			pSprite->x += pSprite->vx * DT;
+			pSprite->y += pSprite->vy * DT;
+
+			if (pSprite->y < FIELD_TOP || pSprite->y > FIELD_BOTTOM)
+			{
+				delete pSprite;
+				delete pBullet;
+				it = bullets.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		while ((int)bullets.size() < iCount)
+		{
+			LegacyBullet *pBullet = new LegacyBullet;
+			pBullet->pSprite = new LegacySprite;
+			pBullet->pSprite->x = (float)random.Range(0, 1920);
+			pBullet->pSprite->y = 500.0f;
+			pBullet->pSprite->vx = 0;
+			pBullet->pSprite->vy = SpawnVelocity(random);
+			pBullet->iFaction = 0;
+			bullets.push_back(pBullet);
+		}
+	}
+
+	double fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (std::list<LegacyBullet*>::iterator it = bullets.begin(); it != bullets.end(); ++it)
+	{
+		delete (*it)->pSprite;
+		delete *it;
+	}
+
+	return fSeconds;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RunStore ()
+// Desc : The same update on CEntityStore.
+//-----------------------------------------------------------------------------
+static double RunStore(int iCount, int iFrames)
+{
+	CTestRandom random(1);
+	CEntityStore store(iCount);
+
+	for (int i = 0; i < iCount; i++)
+		store.Create((float)random.Range(0, 1920), (float)random.Range(40, 950), 0, SpawnVelocity(random), (unsigned char)(i & 1));
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int f = 0; f < iFrames; f++)
+	{
+		store.SavePositions();
+		store.Integrate(DT);
+
+		const float *py = store.PosY();
+		store.RemoveIf([py](int i) { return py[i] < FIELD_TOP || py[i] > FIELD_BOTTOM; });
+
+		while (store.Count() < iCount)
+			store.Create((float)random.Range(0, 1920), 500.0f, 0, SpawnVelocity(random), 0);
+	}
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	int iFrames = argc > 1 ? atoi(argv[1]) : 300;
+	const int counts[] = { 1000, 10000, 50000 };
+
+	printf("%8s %16s %16s %8s\n", "entities", "list ns/entity", "store ns/entity", "speedup");
+
+	for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+	{
+		double fList = RunList(counts[i], iFrames);
+		double fStore = RunStore(counts[i], iFrames);
+		double fPerEntity = 1e9 / ((double)counts[i] * iFrames);
+
+		printf("%8d %16.2f %16.2f %7.1fx\n", counts[i], fList * fPerEntity, fStore * fPerEntity, fList / fStore);
+	}
+
+	return 0;
+}
@@ -0,0 +1,705 @@
+//-----------------------------------------------------------------------------
+// File: ResizeBench.cpp
+//
+// Desc: Benchmarks of CResizableImage::Resample, on a 1920x1080 picture (a
+//		bitmap given on the command line, or a generated one since the
+//		backgrounds are not in the repository):
+//			threads		1, 2, 4 and 8 threads to 4K and to 720p, the output
+//						must be the one of the single threaded resample
+//			kernels		1920x1080 to 3840x2160 with every kernel path the
+//						processor has, and the largest error against a
+//						double precision reference
+//			vertical	the vertical pass of Resample on its own, with every
+//						kernel path, against the column at a time loop it
+//						replaced, for every filter at common resolutions
+//			cache		hits and misses of CWeightsCache, and tables
+//						evicted while a pass still holds them
+//			weights		the weights tables built through the virtual
+//						CGenericFilter::Filter against the compile time
+//						calls to the filters, and the error of the
+//						Lanczos3 lookup table
+//			rows		ResampleRows against Resample with every filter
+//						and kernel, to 4K and 8x down: the same pixels,
+//						and the peak heap memory each one needs
+//
+//		ResizeBench [picture.bmp]
+//
+// Note : CResizableImage needs windows.h, this benchmark is only built on
+//		Windows.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// ResizeBench Specific Includes
+//-----------------------------------------------------------------------------
+#include "ResizeEngine.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <math.h>
+#include <memory>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// CImageFile loads through the instance of the game
+HINSTANCE g_hInst = NULL;
+
+typedef std::chrono::steady_clock Clock;
+
+// Heap bytes in use and their peak, counted by the operator new / delete
+// below. The peak is reset before the call it measures.
+static std::atomic<size_t> s_uHeapUsed(0), s_uHeapPeak(0);
+
+void* operator new(size_t uSize)
+{
+	size_t *p = (size_t*)malloc(uSize + 16);
+
+	if (!p)
+		throw std::bad_alloc();
+
+	p[0] = uSize;
+	size_t uUsed = s_uHeapUsed += uSize, uPeak = s_uHeapPeak;
+
+	while (uUsed > uPeak && !s_uHeapPeak.compare_exchange_weak(uPeak, uUsed)) {}
+
+	return (char*)p + 16;
+}
+
+void operator delete(void *pMemory) noexcept
+{
+	if (pMemory)
+	{
+		size_t *p = (size_t*)((char*)pMemory - 16);
+		s_uHeapUsed -= p[0];
+		free(p);
+	}
+}
+
+void operator delete(void *pMemory, size_t) noexcept
+{
+	operator delete(pMemory);
+}
+
+static double Seconds(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+//-----------------------------------------------------------------------------
+// Name : CBenchImage (Class)
+// Desc : Gives the benchmark access to the pixels of the image.
+//-----------------------------------------------------------------------------
+class CBenchImage : public CResizableImage
+{
+public:
+	void					Set(int w, int h, const RGBQUAD *pPixels)
+	{
+		delete [] m_pRGB;
+		m_pRGB = new RGBQUAD[w * h];
+		memcpy(m_pRGB, pPixels, sizeof(RGBQUAD) * w * h);
+		width = w;
+		height = h;
+		m_biInfo.biWidth = w;
+		m_biInfo.biHeight = h;
+	}
+
+	const RGBQUAD*			Pixels() const { return m_pRGB; }
+
+	// The vertical pass of Resample alone, the width is kept
+	void					VerticalPass(int dh)
+	{
+		m_pResImg = new RGBQUAD[width * dh];
+		VerticalFilter(width, dh);
+
+		delete [] m_pRGB;
+		m_pRGB = m_pResImg;
+		height = dh;
+	}
+};
+
+// The same filters through their base class only, CWeightsTable falls back
+// to the virtual CGenericFilter::Filter for classes it does not know
+class CVirtualBox : public CBoxFilter {};
+class CVirtualBilinear : public CBilinearFilter {};
+class CVirtualBicubic : public CBicubicFilter {};
+class CVirtualLanczos3 : public CLanczos3Filter {};
+class CVirtualBSpline : public CBSplineFilter {};
+
+//-----------------------------------------------------------------------------
+// Name : MakePicture ()
+// Desc : The bitmap given, or smooth gradients with some noise on them.
+//-----------------------------------------------------------------------------
+static bool MakePicture(const char *szFile, int& w, int& h, std::vector<RGBQUAD>& pixels)
+{
+	if (szFile)
+	{
+		CFrameBuffer image;
+
+		if (!LoadBitmapFile(szFile, image))
+			return false;
+
+		w = image.Width();
+		h = image.Height();
+		pixels.resize(w * h);
+
+		for (int y = 0; y < h; y++)
+			memcpy(&pixels[y * w], image.Row(y), w * sizeof(RGBQUAD));
+	}
+	else
+	{
+		CTestRandom random(1);
+
+		w = 1920;
+		h = 1080;
+		pixels.resize(w * h);
+
+		for (int y = 0; y < h; y++)
+		{
+			for (int x = 0; x < w; x++)
+			{
+				RGBQUAD &p = pixels[y * w + x];
+				int iNoise = random.Range(-24, 24);
+
+				p.rgbBlue		= (BYTE)std::min(255, std::max(0, x * 255 / w + iNoise));
+				p.rgbGreen		= (BYTE)std::min(255, std::max(0, y * 255 / h + iNoise));
+				p.rgbRed		= (BYTE)std::min(255, std::max(0, ((x ^ y) & 255) + iNoise));
+				p.rgbReserved	= 0;
+			}
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : TimeResample ()
+// Desc : Best of three resamples of the picture, the last output is kept.
+//-----------------------------------------------------------------------------
+static double TimeResample(const std::vector<RGBQUAD>& src, int w, int h, int dw, int dh,
+						   CGenericFilter *pFilter, CThreadPool *pPool, std::vector<RGBQUAD>& out)
+{
+	double fBest = 1e30;
+
+	for (int k = 0; k < 3; k++)
+	{
+		CBenchImage image;
+		image.Set(w, h, &src[0]);
+		image.SetFilter(pFilter);
+		image.SetThreadPool(pPool);
+
+		Clock::time_point start = Clock::now();
+		image.Resample(dw, dh);
+		fBest = std::min(fBest, Seconds(start));
+
+		out.assign(image.Pixels(), image.Pixels() + dw * dh);
+	}
+
+	return fBest;
+}
+
+//-----------------------------------------------------------------------------
+// Name : TimeVertical ()
+// Desc : Best of three vertical passes on the calling thread, the last
+//		output is kept.
+//-----------------------------------------------------------------------------
+static double TimeVertical(const std::vector<RGBQUAD>& src, int w, int h, int dh,
+						   CGenericFilter *pFilter, std::vector<RGBQUAD>& out)
+{
+	double fBest = 1e30;
+
+	for (int k = 0; k < 3; k++)
+	{
+		CBenchImage image;
+		image.Set(w, h, &src[0]);
+		image.SetFilter(pFilter);
+		image.SetThreadPool(NULL);
+
+		Clock::time_point start = Clock::now();
+		image.VerticalPass(dh);
+		fBest = std::min(fBest, Seconds(start));
+
+		out.assign(image.Pixels(), image.Pixels() + w * dh);
+	}
+
+	return fBest;
+}
+
+//-----------------------------------------------------------------------------
+// Name : MeasureResample () / MeasureResampleRows ()
+// Desc : One resample of the picture on the calling thread, with the
+//		weights tables already in the shared cache. Returns the seconds
+//		taken, uPeak is the most heap memory the call held at once.
+//-----------------------------------------------------------------------------
+static double MeasureResample(const std::vector<RGBQUAD>& src, int w, int h, int dw, int dh,
+							  CGenericFilter *pFilter, std::vector<RGBQUAD>& out, size_t& uPeak)
+{
+	CBenchImage image;
+	image.Set(w, h, &src[0]);
+	image.SetFilter(pFilter);
+	image.SetThreadPool(NULL);
+
+	size_t uBase = s_uHeapUsed;
+	s_uHeapPeak = uBase;
+	Clock::time_point start = Clock::now();
+	image.Resample(dw, dh);
+	double fTime = Seconds(start);
+	uPeak = s_uHeapPeak - uBase;
+
+	out.assign(image.Pixels(), image.Pixels() + dw * dh);
+	return fTime;
+}
+
+static double MeasureResampleRows(const std::vector<RGBQUAD>& src, int w, int h, int dw, int dh,
+								  CGenericFilter *pFilter, std::vector<RGBQUAD>& out, size_t& uPeak)
+{
+	CBenchImage image;
+	image.Set(w, h, &src[0]);
+	image.SetFilter(pFilter);
+
+	out.assign(dw * dh, RGBQUAD());
+	RGBQUAD *pOut = &out[0];
+	CResizableImage::RowSink sink = [pOut, dw](unsigned int row, const RGBQUAD *pRow)
+	{
+		memcpy(pOut + row * dw, pRow, dw * sizeof(RGBQUAD));
+	};
+
+	size_t uBase = s_uHeapUsed;
+	s_uHeapPeak = uBase;
+	Clock::time_point start = Clock::now();
+	image.ResampleRows(dw, dh, sink);
+	double fTime = Seconds(start);
+	uPeak = s_uHeapPeak - uBase;
+
+	return fTime;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReferencePass ()
+// Desc : One pass in double precision, rounded to bytes like the kernels.
+//		bVertical filters the columns.
+//-----------------------------------------------------------------------------
+static std::vector<double> ReferencePass(const std::vector<double>& src, int w, int h, int iDstSize,
+										 bool bVertical, CGenericFilter *pFilter)
+{
+	int dw = bVertical ? w : iDstSize, dh = bVertical ? iDstSize : h;
+	CWeightsTable table(pFilter, iDstSize, bVertical ? h : w);
+	std::vector<double> dst(dw * dh * 4);
+
+	for (int y = 0; y < dh; y++)
+	{
+		for (int x = 0; x < dw; x++)
+		{
+			int u = bVertical ? y : x;
+			int iLeft = table.getLeftBoundary(u), iRight = table.getRightBoundary(u);
+
+			for (int c = 0; c < 4; c++)
+			{
+				double fSum = 0;
+
+				for (int i = iLeft; i <= iRight; i++)
+				{
+					int s = bVertical ? i * w + x : y * w + i;
+					fSum += table.getWeight(u, i - iLeft) * src[s * 4 + c];
+				}
+
+				dst[(y * dw + x) * 4 + c] = std::min(255.0, std::max(0.0, floor(fSum + 0.5)));
+			}
+		}
+	}
+
+	return dst;
+}
+
+// Both passes, in the order Resample picks
+static std::vector<double> Reference(const std::vector<RGBQUAD>& pixels, int w, int h, int dw, int dh, CGenericFilter *pFilter)
+{
+	std::vector<double> src(w * h * 4);
+
+	for (int i = 0; i < w * h; i++)
+	{
+		src[i * 4 + 0] = pixels[i].rgbBlue;
+		src[i * 4 + 1] = pixels[i].rgbGreen;
+		src[i * 4 + 2] = pixels[i].rgbRed;
+		src[i * 4 + 3] = pixels[i].rgbReserved;
+	}
+
+	if ((long long)dw * h <= (long long)dh * w)
+		return ReferencePass(ReferencePass(src, w, h, dw, false, pFilter), dw, h, dh, true, pFilter);
+
+	return ReferencePass(ReferencePass(src, w, h, dh, true, pFilter), w, dh, dw, false, pFilter);
+}
+
+static int MaxError(const std::vector<RGBQUAD>& image, const std::vector<double>& reference)
+{
+	int iMax = 0;
+
+	for (size_t i = 0; i < image.size(); i++)
+	{
+		const BYTE *p = &image[i].rgbBlue;
+
+		for (int c = 0; c < 4; c++)
+			iMax = std::max(iMax, abs((int)p[c] - (int)reference[i * 4 + c]));
+	}
+
+	return iMax;
+}
+
+//-----------------------------------------------------------------------------
+// Name : VerticalByColumns ()
+// Desc : The scalar fixed point vertical pass walking down every column,
+//		the loop order of the ScaleCol that ScaleCols replaced.
+//-----------------------------------------------------------------------------
+static inline BYTE Clamp(int iValue)
+{
+	iValue >>= RESIZE_FIXED_BITS;
+	return (BYTE)(iValue < 0 ? 0 : (iValue > 255 ? 255 : iValue));
+}
+
+static void VerticalByColumns(const RGBQUAD *pSrc, RGBQUAD *pDst, int w, int dh, const CWeightsTable& table)
+{
+	for (int x = 0; x < w; x++)
+	{
+		for (int y = 0; y < dh; y++)
+		{
+			int iLeft = table.getLeftBoundary(y);
+			int nTaps = table.getRightBoundary(y) - iLeft + 1;
+			const short *pWeights = table.getFixedWeights(y);
+			int b = RESIZE_FIXED_ONE / 2, g = b, r = b, a = b;
+
+			for (int i = 0; i < nTaps; i++)
+			{
+				const RGBQUAD &s = pSrc[(iLeft + i) * w + x];
+
+				b += pWeights[i] * s.rgbBlue;
+				g += pWeights[i] * s.rgbGreen;
+				r += pWeights[i] * s.rgbRed;
+				a += pWeights[i] * s.rgbReserved;
+			}
+
+			RGBQUAD &d = pDst[y * w + x];
+			d.rgbBlue = Clamp(b); d.rgbGreen = Clamp(g); d.rgbRed = Clamp(r); d.rgbReserved = Clamp(a);
+		}
+	}
+}
+
+static bool Same(const std::vector<RGBQUAD>& a, const std::vector<RGBQUAD>& b)
+{
+	return a.size() == b.size() && memcmp(&a[0], &b[0], a.size() * sizeof(RGBQUAD)) == 0;
+}
+
+static const char *s_szKernel[] = { "scalar", "SSE2", "AVX2" };
+
+int main(int argc, char **argv)
+{
+	int w, h;
+	std::vector<RGBQUAD> src;
+
+	if (!MakePicture(argc > 1 ? argv[1] : NULL, w, h, src))
+		return 1;
+
+	CBoxFilter box;
+	CBilinearFilter bilinear;
+	CBicubicFilter bicubic;
+	CLanczos3Filter lanczos3;
+	CBSplineFilter bspline;
+	CVirtualBox vbox;
+	CVirtualBilinear vbilinear;
+	CVirtualBicubic vbicubic;
+	CVirtualLanczos3 vlanczos3;
+	CVirtualBSpline vbspline;
+
+	struct { const char *szName; CGenericFilter *pFilter, *pVirtual; } filters[] =
+	{
+		{ "box",		&box,		&vbox },
+		{ "bilinear",	&bilinear,	&vbilinear },
+		{ "bicubic",	&bicubic,	&vbicubic },
+		{ "lanczos3",	&lanczos3,	&vlanczos3 },
+		{ "bspline",	&bspline,	&vbspline },
+	};
+	const int nFilters = sizeof(filters) / sizeof(filters[0]);
+
+	int iFailures = 0;
+	std::vector<RGBQUAD> out, first;
+
+	// the weights come from the shared cache after the first resample of a
+	// size, like they do in the game
+	printf("threads: %dx%d, bicubic, %s kernel\n", w, h, s_szKernel[CResizableImage::GetKernel()]);
+
+	const int sizes[][2] = { { 3840, 2160 }, { 1280, 720 } };
+
+	for (int s = 0; s < 2; s++)
+	{
+		double fSingle = 0;
+
+		for (int t = 1; t <= 8; t *= 2)
+		{
+			CThreadPool pool(t);
+			double f = TimeResample(src, w, h, sizes[s][0], sizes[s][1], &bicubic, &pool, out);
+
+			if (t == 1)
+			{
+				fSingle = f;
+				first = out;
+			}
+			else if (!Same(out, first))
+			{
+				printf("  %d threads: the output differs from the single threaded one\n", t);
+				iFailures++;
+			}
+
+			printf("  to %4dx%-4d %d threads %8.2f ms %5.2fx\n", sizes[s][0], sizes[s][1], t, f * 1e3, fSingle / f);
+		}
+	}
+
+	printf("kernels: %dx%d to 3840x2160, one thread\n", w, h);
+
+	for (int f = 0; f < nFilters; f++)
+	{
+		std::vector<double> reference = Reference(src, w, h, 3840, 2160, filters[f].pFilter);
+		double fScalar = 0;
+
+		for (int k = CResizableImage::KERNEL_SCALAR; k <= CResizableImage::GetBestKernel(); k++)
+		{
+			CResizableImage::SetKernel((CResizableImage::EKernel)k);
+
+			double fTime = TimeResample(src, w, h, 3840, 2160, filters[f].pFilter, NULL, out);
+			int iError = MaxError(out, reference);
+
+			if (k == CResizableImage::KERNEL_SCALAR)
+			{
+				fScalar = fTime;
+				first = out;
+			}
+			else if (!Same(out, first))
+			{
+				printf("  %s %s: the output differs from the scalar kernel\n", filters[f].szName, s_szKernel[k]);
+				iFailures++;
+			}
+
+			printf("  %-9s %-6s %8.2f ms %5.2fx  max error %d\n", filters[f].szName, s_szKernel[k], fTime * 1e3, fScalar / fTime, iError);
+		}
+	}
+
+	printf("vertical: the pass alone on one thread, against the column at a time loop\n");
+
+	const int passes[][3] = { { 1280, 720, 1080 }, { 1920, 1080, 1440 }, { 1920, 1080, 2160 }, { 1920, 1080, 720 } };
+
+	for (int p = 0; p < 4; p++)
+	{
+		int pw = passes[p][0], ph = passes[p][1], dh = passes[p][2];
+		std::vector<RGBQUAD> pass(pw * ph), byColumns(pw * dh);
+
+		for (int y = 0; y < ph; y++)
+			memcpy(&pass[y * pw], &src[(y % h) * w], std::min(pw, w) * sizeof(RGBQUAD));
+
+		for (int f = 0; f < nFilters; f++)
+		{
+			CWeightsTable table(filters[f].pFilter, dh, ph);
+			double fColumns = 1e30;
+
+			for (int k = 0; k < 3; k++)
+			{
+				Clock::time_point start = Clock::now();
+				VerticalByColumns(&pass[0], &byColumns[0], pw, dh, table);
+				fColumns = std::min(fColumns, Seconds(start));
+			}
+
+			printf("  %4dx%-4d to %4dx%-4d %-9s columns %7.2f ms", pw, ph, pw, dh, filters[f].szName, fColumns * 1e3);
+
+			for (int k = CResizableImage::KERNEL_SCALAR; k <= CResizableImage::GetBestKernel(); k++)
+			{
+				CResizableImage::SetKernel((CResizableImage::EKernel)k);
+
+				double fTime = TimeVertical(pass, pw, ph, dh, filters[f].pFilter, out);
+
+				if (!Same(out, byColumns))
+				{
+					printf("\n  %s %s: the pass differs from the column loop", filters[f].szName, s_szKernel[k]);
+					iFailures++;
+				}
+
+				printf("  %s %7.2f ms %5.2fx", s_szKernel[k], fTime * 1e3, fColumns / fTime);
+			}
+
+			printf("\n");
+		}
+	}
+
+	CResizableImage::SetKernel(CResizableImage::GetBestKernel());
+
+	printf("cache: a private CWeightsCache, one thread\n");
+
+	{
+		CWeightsCache cache;
+		CBicubicFilter sharper(0, 0.5);
+		CBenchImage image;
+
+		auto check = [&](bool bPassed, const char *szWhat)
+		{
+			if (!bPassed)
+			{
+				printf("  %s (%lu hits, %lu misses)\n", szWhat, cache.GetHits(), cache.GetMisses());
+				iFailures++;
+			}
+		};
+
+		// a resample needs two tables, the same sizes again only hit
+		image.Set(w, h, &src[0]);
+		image.SetFilter(&bicubic);
+		image.SetThreadPool(NULL);
+		image.SetWeightsCache(&cache);
+		image.Resample(1280, 720);
+		check(cache.GetHits() == 0 && cache.GetMisses() == 2, "the first resample must build its two tables");
+
+		image.Set(w, h, &src[0]);
+		image.Resample(1280, 720);
+		check(cache.GetHits() == 2 && cache.GetMisses() == 2, "the second resample must find both tables");
+
+		// b and c change the shape of the curve, so they are part of the key
+		std::shared_ptr<const CWeightsTable> pHeld = cache.Get(&sharper, 720, 1080);
+		check(cache.GetMisses() == 3, "a bicubic with another b and c must miss");
+
+		size_t uBefore = cache.GetMemoryUsed();
+		cache.SetBudget(0);
+		check(cache.GetMemoryUsed() == 0, "SetBudget(0) must drop every table");
+
+		// the evicted table stays whole while it is held
+		CWeightsTable fresh(&sharper, 720, 1080);
+		bool bIntact = true;
+
+		for (int y = 0; y < 720; y++)
+		{
+			int iLeft = fresh.getLeftBoundary(y), nTaps = fresh.getRightBoundary(y) - iLeft + 1;
+
+			bIntact = bIntact && pHeld->getLeftBoundary(y) == iLeft && pHeld->getRightBoundary(y) == iLeft + nTaps - 1 &&
+					  memcmp(pHeld->getFixedWeights(y), fresh.getFixedWeights(y), nTaps * sizeof(short)) == 0;
+		}
+
+		check(bIntact, "a held table must stay valid after its eviction");
+
+		cache.Get(&bicubic, 720, 1080);
+		check(cache.GetMisses() == 4, "an evicted table must be built again");
+
+		printf("  %lu hits, %lu misses, %u bytes kept before SetBudget(0), %u after\n",
+			   cache.GetHits(), cache.GetMisses(), (unsigned)uBefore, (unsigned)cache.GetMemoryUsed());
+	}
+
+	printf("weights: 20 tables per mapping, virtual Filter against compile time calls\n");
+
+	const int mappings[][2] = { { 1920, 3840 }, { 3840, 640 } };
+
+	for (int m = 0; m < 2; m++)
+	{
+		int iSrc = mappings[m][0], iDst = mappings[m][1];
+
+		for (int f = 0; f < nFilters; f++)
+		{
+			Clock::time_point start = Clock::now();
+			for (int k = 0; k < 20; k++) { CWeightsTable table(filters[f].pVirtual, iDst, iSrc); }
+			double fVirtual = Seconds(start) / 20;
+
+			start = Clock::now();
+			for (int k = 0; k < 20; k++) { CWeightsTable table(filters[f].pFilter, iDst, iSrc); }
+			double fDirect = Seconds(start) / 20;
+
+			// the fixed point weights must not depend on the call
+			CWeightsTable virtualTable(filters[f].pVirtual, iDst, iSrc), directTable(filters[f].pFilter, iDst, iSrc);
+
+			for (int x = 0; x < iDst; x++)
+			{
+				int nTaps = directTable.getRightBoundary(x) - directTable.getLeftBoundary(x) + 1;
+
+				if (memcmp(virtualTable.getFixedWeights(x), directTable.getFixedWeights(x), nTaps * sizeof(short)) != 0)
+				{
+					printf("  %s %d to %d: the weights of pixel %d differ\n", filters[f].szName, iSrc, iDst, x);
+					iFailures++;
+					break;
+				}
+			}
+
+			printf("  %4d to %-4d %-9s virtual %7.3f ms  direct %7.3f ms %5.2fx\n",
+				   iSrc, iDst, filters[f].szName, fVirtual * 1e3, fDirect * 1e3, fVirtual / fDirect);
+		}
+	}
+
+	// the lookup against the curve it samples, between and on the samples
+	double fLookupError = 0;
+
+	for (int i = 0; i <= 3 * 1000000; i++)
+	{
+		double x = i / 1000000.0;
+		fLookupError = std::max(fLookupError, fabs(CLanczos3Filter::FilterLookup(x) - lanczos3.Filter(x)));
+	}
+
+	printf("  lanczos3 lookup table: max error %.2g against sin()\n", fLookupError);
+
+	if (fLookupError >= 1e-6)
+	{
+		printf("  the lanczos3 lookup is off by more than 1e-6\n");
+		iFailures++;
+	}
+
+	printf("rows: ResampleRows against Resample, %dx%d, one thread\n", w, h);
+
+	const int streams[][2] = { { 3840, 2160 }, { w / 8, h / 8 }, { w, h / 4 } };
+
+	for (int m = 0; m < 3; m++)
+	{
+		int dw = streams[m][0], dh = streams[m][1];
+		// the last mapping is filtered vertically first by Resample
+		bool bSameOrder = (long long)dw * h <= (long long)dh * w;
+
+		for (int f = 0; f < nFilters; f++)
+		{
+			for (int k = CResizableImage::KERNEL_SCALAR; k <= CResizableImage::GetBestKernel(); k++)
+			{
+				CResizableImage::SetKernel((CResizableImage::EKernel)k);
+
+				size_t uResample, uRows;
+				std::vector<RGBQUAD> rows;
+
+				MeasureResample(src, w, h, dw, dh, filters[f].pFilter, out, uResample);
+				double fResample = MeasureResample(src, w, h, dw, dh, filters[f].pFilter, out, uResample);
+				double fRows = MeasureResampleRows(src, w, h, dw, dh, filters[f].pFilter, rows, uRows);
+				int iDiff = 0;
+
+				for (size_t i = 0; i < out.size(); i++)
+				{
+					const BYTE *a = &out[i].rgbBlue, *b = &rows[i].rgbBlue;
+
+					for (int c = 0; c < 4; c++)
+						iDiff = std::max(iDiff, abs((int)a[c] - (int)b[c]));
+				}
+
+				if (bSameOrder && iDiff)
+				{
+					printf("  %s %s to %dx%d: the rows differ from Resample\n", filters[f].szName, s_szKernel[k], dw, dh);
+					iFailures++;
+				}
+
+				// the ring of (window + 1) rows, the output row and the row pointers
+				size_t nSlots = CWeightsTable(filters[f].pFilter, dh, h).getWindowSize() + 1;
+
+				if (uRows > (nSlots + 1) * dw * sizeof(RGBQUAD) + nSlots * sizeof(RGBQUAD*))
+				{
+					printf("  %s %s to %dx%d: the rows need more than their ring buffer\n", filters[f].szName, s_szKernel[k], dw, dh);
+					iFailures++;
+				}
+
+				printf("  to %4dx%-4d %-9s %-6s Resample %8.2f ms %9u bytes  ResampleRows %8.2f ms %7u bytes  %s %d\n",
+					   dw, dh, filters[f].szName, s_szKernel[k], fResample * 1e3, (unsigned)uResample, fRows * 1e3, (unsigned)uRows,
+					   bSameOrder ? "differs by" : "vertical first, differs by", iDiff);
+			}
+		}
+	}
+
+	CResizableImage::SetKernel(CResizableImage::GetBestKernel());
+
+	if (iFailures)
+		printf("%d failures\n", iFailures);
+
+	return iFailures ? 1 : 0;
+}
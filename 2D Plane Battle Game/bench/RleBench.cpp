@@ -0,0 +1,129 @@
+//-----------------------------------------------------------------------------
+// File: RleBench.cpp
+//
+// Desc: Cost of one whole blit of every sprite of the game, and of every
+//		frame of the explosion, with the mask or color key blitters against
+//		the RLE sprite compiled from the same pixels. Both must leave the
+//		same frame.
+//
+//		RleBench [blits per sprite]
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// RleBench Specific Includes
+//-----------------------------------------------------------------------------
+#include "RleSprite.h"
+#include "Blitters.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int FRAME_WIDTH = 1024;
+static const int FRAME_HEIGHT = 768;
+static const uint32_t COLOR_KEY = 0x00FF00FF;
+
+//-----------------------------------------------------------------------------
+// Name : BenchSprite ()
+// Desc : Times iBlits blits of the rectangle (sx, sy, w, h), mask is NULL
+//		for a color keyed image. Returns false if the frames differ.
+//-----------------------------------------------------------------------------
+static bool BenchSprite(const char *szName, const CFrameBuffer& image, const CFrameBuffer *pMask,
+						int sx, int sy, int w, int h, int iBlits, CFrameBuffer& blitFrame, CFrameBuffer& rleFrame)
+{
+	CRleSprite rle;
+
+	if (pMask)
+		rle.BuildFromMask(image, *pMask, sx, sy, w, h);
+	else
+		rle.BuildFromColorKey(image, sx, sy, w, h, COLOR_KEY);
+
+	blitFrame.Fill(0x00203040);
+	rleFrame.Fill(0x00203040);
+
+	// the same places for both, spread over the frame; the best of a few
+	// interleaved rounds, the machine is rarely quiet
+	double fBlit = 1e30, fRle = 1e30;
+
+	for (int r = 0; r < 3; r++)
+	{
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < iBlits; i++)
+		{
+			int x = (i * 37) % (FRAME_WIDTH - w), y = (i * 91) % (FRAME_HEIGHT - h);
+
+			if (pMask)
+				CBlitter::Mask(blitFrame, x, y, image, *pMask, sx, sy, w, h);
+			else
+				CBlitter::ColorKey(blitFrame, x, y, image, sx, sy, w, h, COLOR_KEY);
+		}
+
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < iBlits; i++)
+		{
+			int x = (i * 37) % (FRAME_WIDTH - w), y = (i * 91) % (FRAME_HEIGHT - h);
+			rle.Draw(rleFrame, x, y, 0, 0, w, h);
+		}
+
+		std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+		fBlit = std::min(fBlit, std::chrono::duration<double, std::nano>(t1 - t0).count() / iBlits);
+		fRle = std::min(fRle, std::chrono::duration<double, std::nano>(t2 - t1).count() / iBlits);
+	}
+
+	printf("%-20s %3dx%-3d %7.1f%% %6d %10.0f %10.0f %7.2fx\n", szName, w, h,
+		   100.0 * rle.OpaqueCount() / (w * h), rle.SpanCount(), fBlit, fRle, fBlit / fRle);
+
+	if (memcmp(blitFrame.Pixels(), rleFrame.Pixels(), (size_t)FRAME_WIDTH * FRAME_HEIGHT * sizeof(uint32_t)) != 0)
+	{
+		printf("%s: the RLE frame differs from the blitted one\n", szName);
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	int iBlits = argc > 1 ? atoi(argv[1]) : 50000;
+
+	CFrameBuffer plane, planeImage, planeMask, enemy, bullet, bulletMask, explosion, explosionMask;
+
+	if (!LoadGameBitmap("PlaneImgAndMask.bmp", plane) ||
+		!LoadGameBitmap("PlaneImg.bmp", planeImage) || !LoadGameBitmap("PlaneMask.bmp", planeMask) ||
+		!LoadGameBitmap("enemy_plane.bmp", enemy) ||
+		!LoadGameBitmap("bullet1.bmp", bullet) || !LoadGameBitmap("bullet1_mask.bmp", bulletMask) ||
+		!LoadGameBitmap("explosion.bmp", explosion) || !LoadGameBitmap("explosionmask.bmp", explosionMask))
+		return 1;
+
+	CFrameBuffer blitFrame, rleFrame;
+	blitFrame.Create(FRAME_WIDTH, FRAME_HEIGHT);
+	rleFrame.Create(FRAME_WIDTH, FRAME_HEIGHT);
+
+	int iFailures = 0;
+
+	printf("%-20s %7s %8s %6s %10s %10s %8s\n", "sprite", "size", "opaque", "spans", "blit ns", "rle ns", "speedup");
+
+	iFailures += !BenchSprite("plane (key)", plane, NULL, 0, 0, plane.Width(), plane.Height(), iBlits, blitFrame, rleFrame);
+	iFailures += !BenchSprite("plane (mask)", planeImage, &planeMask, 0, 0, planeImage.Width(), planeImage.Height(), iBlits, blitFrame, rleFrame);
+	iFailures += !BenchSprite("enemy (key)", enemy, NULL, 0, 0, enemy.Width(), enemy.Height(), iBlits, blitFrame, rleFrame);
+	iFailures += !BenchSprite("bullet (mask)", bullet, &bulletMask, 0, 0, bullet.Width(), bullet.Height(), iBlits, blitFrame, rleFrame);
+
+	// explosion.bmp is 4 x 4 frames of 128 x 128
+	for (int f = 0; f < 16; f++)
+	{
+		char szName[32];
+		snprintf(szName, sizeof(szName), "explosion frame %d", f);
+
+		iFailures += !BenchSprite(szName, explosion, &explosionMask, (f % 4) * 128, (f / 4) * 128, 128, 128, iBlits / 4, blitFrame, rleFrame);
+	}
+
+	if (iFailures)
+		printf("%d failures\n", iFailures);
+
+	return iFailures ? 1 : 0;
+}
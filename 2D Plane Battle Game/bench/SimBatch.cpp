@@ -0,0 +1,56 @@
+//-----------------------------------------------------------------------------
+// File: SimBatch.cpp
+//
+// Desc: Plays scripted matches of the headless simulation as fast as the
+//		processor allows and reports the outcomes and the ticks per second.
+//
+//		SimBatch [matches] [first seed] [max ticks per match]
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// SimBatch Specific Includes
+//-----------------------------------------------------------------------------
+#include "Simulation.h"
+#include "TestSupport.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv)
+{
+	int iMatches = argc > 1 ? atoi(argv[1]) : 200;
+	uint32_t uFirstSeed = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 1;
+	unsigned long ulMaxTicks = argc > 3 ? strtoul(argv[3], NULL, 10) : 200000;
+
+	CSimulation sim;
+	sim.SetTickTime(1.0f / 60.0f);
+
+	if (!LoadGameShapes(sim))
+		return 1;
+
+	int iWon = 0, iLost = 0, iUnfinished = 0;
+	unsigned long long ullTicks = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < iMatches; i++)
+	{
+		ullTicks += PlayScriptedMatch(sim, uFirstSeed + i, ulMaxTicks);
+
+		if (sim.EnemyLives() == -1)
+			iWon++;
+		else if (sim.PlayerLives() == -1)
+			iLost++;
+		else
+			iUnfinished++;
+	}
+
+	double fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	printf("%d matches (seeds %u..%u): %d won, %d lost, %d unfinished\n",
+		   iMatches, uFirstSeed, uFirstSeed + iMatches - 1, iWon, iLost, iUnfinished);
+	printf("%llu ticks in %.3f s, %.0f ticks/s, %.1f ticks per match\n",
+		   ullTicks, fSeconds, ullTicks / fSeconds, iMatches ? (double)ullTicks / iMatches : 0.0);
+
+	return 0;
+}
@@ -0,0 +1,253 @@
+//-----------------------------------------------------------------------------
+// File: BlitterTest.cpp
+//
+// Desc: Pixel exact test of the blitters. Random Copy / ColorKey / Mask
+//		blits, many of them crossing the edges of the surfaces, are drawn
+//		with every kernel path the processor has and compared with a pixel
+//		by pixel reference; the scalar path is checked against the
+//		reference and the SIMD paths against the scalar one. The surfaces
+//		have a pitch wider than their width and are framed by guard pixels
+//		that no blit may touch.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BlitterTest Specific Includes
+//-----------------------------------------------------------------------------
+#include "Blitters.h"
+#include "TestSupport.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static const uint32_t GUARD = 0xDEADBEEF;
+static const uint32_t COLOR_KEY = 0x00FF00FF;
+static const int BORDER = 16;			// guard pixels around a surface
+
+enum EOp { OP_COPY, OP_COLORKEY, OP_MASK, OP_COUNT };
+static const char *s_szOp[OP_COUNT] = { "Copy", "ColorKey", "Mask" };
+
+//-----------------------------------------------------------------------------
+// Name : CGuardedSurface (Class)
+// Desc : A CFrameBuffer attached inside a larger buffer of guard pixels.
+//-----------------------------------------------------------------------------
+class CGuardedSurface
+{
+public:
+	void					Create(int iWidth, int iHeight, int iPadding)
+	{
+		m_iPitch = iWidth + iPadding + 2 * BORDER;
+		m_Memory.assign((size_t)m_iPitch * (iHeight + 2 * BORDER), GUARD);
+		m_Buffer.Attach(&m_Memory[BORDER * m_iPitch + BORDER], iWidth, iHeight, m_iPitch);
+	}
+
+	// The padding at the end of the rows is guarded too
+	bool					GuardIntact() const
+	{
+		for (size_t i = 0; i < m_Memory.size(); i++)
+		{
+			int x = (int)(i % m_iPitch) - BORDER, y = (int)(i / m_iPitch) - BORDER;
+
+			if ((x < 0 || y < 0 || x >= m_Buffer.Width() || y >= m_Buffer.Height()) && m_Memory[i] != GUARD)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool					SamePixels(const CGuardedSurface& other) const
+	{
+		for (int y = 0; y < m_Buffer.Height(); y++)
+		{
+			if (memcmp(m_Buffer.Row(y), other.m_Buffer.Row(y), m_Buffer.Width() * sizeof(uint32_t)) != 0)
+				return false;
+		}
+
+		return true;
+	}
+
+	CFrameBuffer&			Buffer() { return m_Buffer; }
+	const CFrameBuffer&		Buffer() const { return m_Buffer; }
+
+private:
+	std::vector<uint32_t>	m_Memory;
+	CFrameBuffer			m_Buffer;
+	int						m_iPitch;
+};
+
+//-----------------------------------------------------------------------------
+// Name : ReferenceBlit ()
+// Desc : Every pixel of the rectangle that is inside both surfaces, one by
+//		one, with the formulas of Blitters.h.
+//-----------------------------------------------------------------------------
+static void ReferenceBlit(EOp op, CFrameBuffer& dst, int x, int y, const CFrameBuffer& src, const CFrameBuffer& mask, int sx, int sy, int w, int h)
+{
+	for (int j = 0; j < h; j++)
+	{
+		for (int i = 0; i < w; i++)
+		{
+			int srcX = sx + i, srcY = sy + j, dstX = x + i, dstY = y + j;
+
+			if (srcX < 0 || srcY < 0 || srcX >= src.Width() || srcY >= src.Height() ||
+				dstX < 0 || dstY < 0 || dstX >= dst.Width() || dstY >= dst.Height())
+				continue;
+
+			uint32_t s = src.Row(srcY)[srcX];
+			uint32_t &d = dst.Row(dstY)[dstX];
+
+			switch (op)
+			{
+			case OP_COPY:		d = s; break;
+			case OP_COLORKEY:	if ((s & 0x00FFFFFF) != COLOR_KEY) d = s; break;
+			default:			d = (d & mask.Row(srcY)[srcX]) | s; break;
+			}
+		}
+	}
+}
+
+static void Blit(EOp op, CFrameBuffer& dst, int x, int y, const CFrameBuffer& src, const CFrameBuffer& mask, int sx, int sy, int w, int h)
+{
+	switch (op)
+	{
+	case OP_COPY:		CBlitter::Copy(dst, x, y, src, sx, sy, w, h); break;
+	case OP_COLORKEY:	CBlitter::ColorKey(dst, x, y, src, sx, sy, w, h, COLOR_KEY | 0xAB000000); break;
+	default:			CBlitter::Mask(dst, x, y, src, mask, sx, sy, w, h); break;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : FillSprite ()
+// Desc : Image pixels with random top bytes, a third of them the color key
+//		(also with random top bytes); the mask is black, white or random.
+//-----------------------------------------------------------------------------
+static void FillSprite(CTestRandom& random, CFrameBuffer& image, CFrameBuffer& mask)
+{
+	for (int y = 0; y < image.Height(); y++)
+	{
+		for (int x = 0; x < image.Width(); x++)
+		{
+			uint32_t r = random.Next();
+
+			image.Row(y)[x] = (r % 3 == 0) ? (COLOR_KEY | (r & 0xFF000000)) : random.Next();
+
+			switch (random.Range(0, 2))
+			{
+			case 0:		mask.Row(y)[x] = 0; break;
+			case 1:		mask.Row(y)[x] = 0x00FFFFFF; break;
+			default:	mask.Row(y)[x] = random.Next(); break;
+			}
+		}
+	}
+}
+
+static void FillRandom(CTestRandom& random, CFrameBuffer& surface)
+{
+	for (int y = 0; y < surface.Height(); y++)
+		for (int x = 0; x < surface.Width(); x++)
+			surface.Row(y)[x] = random.Next();
+}
+
+int main()
+{
+	CTestRandom random(2024);
+	int iFailures = 0;
+
+	// The paths this processor can run
+	std::vector<CBlitter::EPath> paths;
+
+	for (int p = CBlitter::PATH_SCALAR; p <= CBlitter::GetBestPath(); p++)
+		paths.push_back((CBlitter::EPath)p);
+
+	printf("paths tested: %d (best %d)\n", (int)paths.size(), (int)CBlitter::GetBestPath());
+
+	for (int iSprite = 0; iSprite < 40; iSprite++)
+	{
+		// Odd sizes so the SIMD loops leave tails of every length
+		int iSrcW = random.Range(1, 75), iSrcH = random.Range(1, 40);
+		int iDstW = random.Range(1, 130), iDstH = random.Range(1, 70);
+
+		CGuardedSurface image, mask;
+		image.Create(iSrcW, iSrcH, random.Range(0, 5));
+		mask.Create(iSrcW, iSrcH, random.Range(0, 5));
+		FillSprite(random, image.Buffer(), mask.Buffer());
+
+		for (int iBlit = 0; iBlit < 250; iBlit++)
+		{
+			EOp op = (EOp)random.Range(0, OP_COUNT - 1);
+
+			// Rectangles from well outside to well inside both surfaces,
+			// some larger than the source, some empty
+			int sx = random.Range(-8, iSrcW + 2), sy = random.Range(-8, iSrcH + 2);
+			int w = random.Range(-2, iSrcW + 10), h = random.Range(-2, iSrcH + 10);
+			int x = random.Range(-iSrcW - 4, iDstW + 4), y = random.Range(-iSrcH - 4, iDstH + 4);
+
+			uint32_t uSeed = random.Next();
+			int iPadding = random.Range(0, 9);
+
+			CGuardedSurface expected;
+			expected.Create(iDstW, iDstH, iPadding);
+
+			CTestRandom fill(uSeed);
+			FillRandom(fill, expected.Buffer());
+			ReferenceBlit(op, expected.Buffer(), x, y, image.Buffer(), mask.Buffer(), sx, sy, w, h);
+
+			for (size_t p = 0; p < paths.size(); p++)
+			{
+				CGuardedSurface dst;
+				dst.Create(iDstW, iDstH, iPadding);
+
+				CTestRandom refill(uSeed);
+				FillRandom(refill, dst.Buffer());
+
+				CBlitter::SetPath(paths[p]);
+				Blit(op, dst.Buffer(), x, y, image.Buffer(), mask.Buffer(), sx, sy, w, h);
+
+				// the scalar path is the one the reference checks, the
+				// others must match it (and so the reference)
+				if (!dst.SamePixels(expected) || !dst.GuardIntact())
+				{
+					printf("%s path %d: dst %dx%d, src %dx%d, (%d, %d) <- (%d, %d, %d, %d) differs\n",
+						   s_szOp[op], (int)paths[p], iDstW, iDstH, iSrcW, iSrcH, x, y, sx, sy, w, h);
+					iFailures++;
+				}
+			}
+		}
+	}
+
+	// MaskRow on its own, every length up to a few vectors
+	for (int n = 0; n <= 40; n++)
+	{
+		std::vector<uint32_t> s(n), m(n), d0(n);
+
+		for (int i = 0; i < n; i++)
+		{
+			s[i] = random.Next();
+			m[i] = random.Next();
+			d0[i] = random.Next();
+		}
+
+		std::vector<uint32_t> expected(d0);
+
+		for (int i = 0; i < n; i++)
+			expected[i] = (expected[i] & m[i]) | s[i];
+
+		for (size_t p = 0; p < paths.size(); p++)
+		{
+			std::vector<uint32_t> d(d0);
+
+			CBlitter::SetPath(paths[p]);
+			CBlitter::MaskRow(d.data(), s.data(), m.data(), n);
+
+			if (d != expected)
+			{
+				printf("MaskRow path %d, %d pixels differs\n", (int)paths[p], n);
+				iFailures++;
+			}
+		}
+	}
+
+	CBlitter::SetPath(CBlitter::GetBestPath());
+
+	printf("%d failures\n", iFailures);
+
+	return iFailures ? 1 : 0;
+}
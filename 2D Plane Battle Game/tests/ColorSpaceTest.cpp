@@ -0,0 +1,170 @@
+//-----------------------------------------------------------------------------
+// File: ColorSpaceTest.cpp
+//
+// Desc: Exact match test of the channel kernels. ExtractRow and PasteRow of
+//		the six channels run over all 2^24 colors (with random top bytes),
+//		cut into rows of random lengths so the SIMD loops start at every
+//		alignment and leave tails of every length. The SSE2 / AVX2 paths
+//		must give the bytes of PATH_SCALAR; the red / green / blue channels
+//		and the top bytes are also checked directly.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// ColorSpaceTest Specific Includes
+//-----------------------------------------------------------------------------
+#include "ColorSpace.h"
+#include "TestSupport.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static const int COLOR_COUNT = 1 << 24;
+static const char *s_szChannel[] = { "red", "green", "blue", "hue", "saturation", "luminosity" };
+
+//-----------------------------------------------------------------------------
+// Name : ForEachRow ()
+// Desc : Calls fn(offset, n) on consecutive rows of 1 to 300 pixels
+//		covering [0, iCount).
+//-----------------------------------------------------------------------------
+template <typename Fn>
+static void ForEachRow(int iCount, Fn fn)
+{
+	CTestRandom random(99);
+
+	for (int i = 0; i < iCount; )
+	{
+		int n = random.Range(1, 300);
+
+		if (n > iCount - i)
+			n = iCount - i;
+
+		fn(i, n);
+		i += n;
+	}
+}
+
+static int FirstDifference(const uint8_t *a, const uint8_t *b, int n)
+{
+	for (int i = 0; i < n; i++)
+		if (a[i] != b[i])
+			return i;
+
+	return -1;
+}
+
+static int FirstDifference(const uint32_t *a, const uint32_t *b, int n)
+{
+	for (int i = 0; i < n; i++)
+		if (a[i] != b[i])
+			return i;
+
+	return -1;
+}
+
+int main()
+{
+	std::vector<CColorSpace::EPath> paths;
+
+	for (int p = CColorSpace::PATH_SCALAR; p <= CColorSpace::GetBestPath(); p++)
+		paths.push_back((CColorSpace::EPath)p);
+
+	printf("paths tested: %d (best %d)\n", (int)paths.size(), (int)CColorSpace::GetBestPath());
+
+	// Every color once, with a random top byte
+	CTestRandom random(5);
+	std::vector<uint32_t> colors(COLOR_COUNT);
+	std::vector<uint8_t> values(COLOR_COUNT);
+
+	for (int i = 0; i < COLOR_COUNT; i++)
+	{
+		colors[i] = (uint32_t)i | (random.Next() & 0xFF000000);
+		values[i] = (uint8_t)(random.Next() >> 24);
+	}
+
+	std::vector<uint8_t> expected(COLOR_COUNT), extracted(COLOR_COUNT);
+	std::vector<uint32_t> expectedPixels(COLOR_COUNT), pasted(COLOR_COUNT);
+	int iFailures = 0;
+
+	for (int c = CColorSpace::CHANNEL_RED; c <= CColorSpace::CHANNEL_LUMINOSITY; c++)
+	{
+		CColorSpace::EChannel chn = (CColorSpace::EChannel)c;
+
+		for (size_t p = 0; p < paths.size(); p++)
+		{
+			CColorSpace::SetPath(paths[p]);
+
+			// ExtractRow
+			std::vector<uint8_t> &dst = (p == 0) ? expected : extracted;
+
+			ForEachRow(COLOR_COUNT, [&](int i, int n)
+			{
+				CColorSpace::ExtractRow(chn, &dst[i], &colors[i], n);
+			});
+
+			int iBad = -1;
+
+			if (p == 0 && chn < CColorSpace::CHANNEL_HUE)
+			{
+				int iShift = 16 - 8 * c;
+
+				for (int i = 0; i < COLOR_COUNT && iBad < 0; i++)
+					if (expected[i] != (uint8_t)(colors[i] >> iShift))
+						iBad = i;
+			}
+			else if (p != 0)
+			{
+				iBad = FirstDifference(&expected[0], &extracted[0], COLOR_COUNT);
+			}
+
+			if (iBad >= 0)
+			{
+				printf("ExtractRow %s path %d: color %06X gives %d\n", s_szChannel[c], (int)paths[p],
+					   colors[iBad] & 0x00FFFFFF, (p == 0) ? expected[iBad] : extracted[iBad]);
+				iFailures++;
+			}
+
+			// PasteRow
+			std::vector<uint32_t> &pixels = (p == 0) ? expectedPixels : pasted;
+			pixels = colors;
+
+			ForEachRow(COLOR_COUNT, [&](int i, int n)
+			{
+				CColorSpace::PasteRow(chn, &pixels[i], &values[i], n);
+			});
+
+			iBad = -1;
+
+			for (int i = 0; i < COLOR_COUNT && iBad < 0; i++)
+			{
+				bool bTopKept = (pixels[i] & 0xFF000000) == (colors[i] & 0xFF000000);
+				bool bByteSet = true;
+
+				if (chn < CColorSpace::CHANNEL_HUE)
+				{
+					int iShift = 16 - 8 * c;
+					uint32_t uExpected = (colors[i] & ~(0xFFu << iShift)) | ((uint32_t)values[i] << iShift);
+					bByteSet = (pixels[i] == uExpected);
+				}
+
+				if (!bTopKept || !bByteSet)
+					iBad = i;
+			}
+
+			if (iBad < 0 && p != 0)
+				iBad = FirstDifference(&expectedPixels[0], &pasted[0], COLOR_COUNT);
+
+			if (iBad >= 0)
+			{
+				printf("PasteRow %s path %d: %d into %08X gives %08X\n", s_szChannel[c], (int)paths[p],
+					   values[iBad], colors[iBad], pixels[iBad]);
+				iFailures++;
+			}
+		}
+	}
+
+	CColorSpace::SetPath(CColorSpace::GetBestPath());
+
+	printf("%d failures\n", iFailures);
+
+	return iFailures ? 1 : 0;
+}
@@ -0,0 +1,210 @@
+//-----------------------------------------------------------------------------
+// File: SimulationTest.cpp
+//
+// Desc: Regression test of the match rules. Scripted matches must end the
+//		way they did when the table below was recorded (winner, length,
+//		lives left and what happened along the way), and playing a seed
+//		twice must give the same match. The planes, bullets and enemies
+//		must also move and shoot at the same speed whatever the tick rate.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// SimulationTest Specific Includes
+//-----------------------------------------------------------------------------
+#include "Simulation.h"
+#include "TestSupport.h"
+#include <math.h>
+#include <stdio.h>
+
+static const unsigned long MAX_TICKS = 200000;
+static const float TICK_RATES[] = { 30.0f, 60.0f, 120.0f, 240.0f };
+
+struct MatchRecord
+{
+	uint32_t		uSeed;
+	unsigned long	ulTicks;
+	int				iPlayerLives;		// -1 when the match was lost
+	int				iEnemyLives;		// -1 when the match was won
+	int				iExploded;			// SIM_EVENT_PLAYER_EXPLODED
+	int				iPlayerHit;			// SIM_EVENT_PLAYER_HIT
+	int				iEnemyHit;			// SIM_EVENT_ENEMY_HIT
+};
+
+static const MatchRecord s_Expected[] =
+{
+	{  1,   600, -1,  2, 1, 2, 0 },
+	{  2,   875, -1,  0, 1, 2, 2 },
+	{  3,   585, -1,  0, 1, 2, 2 },
+	{  4,   768, -1,  2, 1, 2, 0 },
+	{  5,   790, -1,  1, 1, 2, 1 },
+	{  6,   401, -1,  2, 1, 2, 0 },
+	{  7,   625, -1,  0, 1, 2, 2 },
+	{  8,   340, -1,  2, 1, 2, 0 },
+	{  9,   576,  2, -1, 0, 0, 2 },
+	{ 10,   461, -1,  2, 1, 2, 0 },
+	{ 11,   614, -1,  1, 1, 2, 1 },
+	{ 12,   587, -1,  1, 1, 2, 1 },
+};
+
+//-----------------------------------------------------------------------------
+// Name : PlayMatch ()
+// Desc : PlayScriptedMatch, counting the events. The match must end with
+//		exactly one MATCH_WON or MATCH_LOST event, on its last tick.
+//-----------------------------------------------------------------------------
+static bool PlayMatch(CSimulation& sim, uint32_t uSeed, MatchRecord& record)
+{
+	CSimScript script(uSeed);
+	SimInput input;
+	int iEnds = 0;
+	bool bOk = true;
+
+	record.uSeed		= uSeed;
+	record.iExploded	= 0;
+	record.iPlayerHit	= 0;
+	record.iEnemyHit	= 0;
+
+	sim.Reset();
+
+	while (!sim.IsOver() && sim.TickCount() < MAX_TICKS)
+	{
+		script.Next(input);
+		sim.Tick(input);
+
+		const std::vector<SimEvent> &events = sim.Events();
+
+		for (size_t i = 0; i < events.size(); i++)
+		{
+			switch (events[i].type)
+			{
+			case SIM_EVENT_PLAYER_EXPLODED:	record.iExploded++; break;
+			case SIM_EVENT_PLAYER_HIT:		record.iPlayerHit++; break;
+			case SIM_EVENT_ENEMY_HIT:		record.iEnemyHit++; break;
+			case SIM_EVENT_MATCH_WON:
+			case SIM_EVENT_MATCH_LOST:
+				iEnds++;
+				bOk &= sim.IsOver();
+				break;
+			}
+		}
+	}
+
+	record.ulTicks		= sim.TickCount();
+	record.iPlayerLives	= sim.PlayerLives();
+	record.iEnemyLives	= sim.EnemyLives();
+
+	if (!bOk || iEnds != (sim.IsOver() ? 1 : 0))
+	{
+		printf("seed %u: the match ended %d times\n", uSeed, iEnds);
+		return false;
+	}
+
+	return true;
+}
+
+static bool SameRecord(const MatchRecord& a, const MatchRecord& b)
+{
+	return a.ulTicks == b.ulTicks && a.iPlayerLives == b.iPlayerLives && a.iEnemyLives == b.iEnemyLives &&
+		   a.iExploded == b.iExploded && a.iPlayerHit == b.iPlayerHit && a.iEnemyHit == b.iEnemyHit;
+}
+
+static void PrintRecord(const char *szWhat, const MatchRecord& r)
+{
+	printf("%s { %2u, %5lu, %2d, %2d, %d, %d, %d }\n", szWhat, r.uSeed, r.ulTicks,
+		   r.iPlayerLives, r.iEnemyLives, r.iExploded, r.iPlayerHit, r.iEnemyHit);
+}
+
+//-----------------------------------------------------------------------------
+// Name : CheckTickRate ()
+// Desc : Three seconds of a fresh match at fTicksPerSecond, the first plane
+//		holding right for the first second, a player bullet fired from the
+//		bottom of the field. Where things are after one second and how many
+//		shots the enemies fired must not depend on the tick rate (up to the
+//		integration error of the plane).
+//-----------------------------------------------------------------------------
+static bool CheckTickRate(CSimulation& sim, float fTicksPerSecond)
+{
+	SimInput input = {};
+	int iTicksPerSecond = (int)fTicksPerSecond;
+	bool bOk = true;
+
+	sim.SetTickTime(1.0f / fTicksPerSecond);
+	sim.Reset();
+
+	float startX = sim.Player(0).x;
+	EntityHandle bullet = sim.SpawnBullet(960, 900, FACTION_PLAYER);
+
+	input.uDirection[0] = SIM_DIR_RIGHT;
+
+	for (int t = 0; t < iTicksPerSecond; t++)
+		sim.Tick(input);
+
+	float planeDX = sim.Player(0).x - startX;
+	float bulletY = sim.Bullets().PosY()[sim.Bullets().SlotOf(bullet)];
+	float enemyX = sim.Enemies().PosX()[0];
+
+	input.uDirection[0] = 0;
+
+	for (int t = 0; t < 2 * iTicksPerSecond; t++)
+		sim.Tick(input);
+
+	int iEnemyShots = sim.Bullets().Count() - 1;
+
+	if (fabsf(planeDX - 105.0f) > 4.0f || fabsf(bulletY - 720.0f) > 1.0f || fabsf(enemyX - 1130.0f) > 1.0f || iEnemyShots != 3)
+	{
+		printf("%g ticks/s: plane moved %.1f, bullet at %.1f, enemy at %.1f, %d enemy shots\n",
+			   fTicksPerSecond, planeDX, bulletY, enemyX, iEnemyShots);
+		bOk = false;
+	}
+
+	sim.SetTickTime(1.0f / 60.0f);
+
+	return bOk;
+}
+
+int main()
+{
+	CSimulation sim;
+	sim.SetTickTime(1.0f / 60.0f);
+
+	if (!LoadGameShapes(sim))
+		return 1;
+
+	int iFailures = 0;
+	int iCount = (int)(sizeof(s_Expected) / sizeof(s_Expected[0]));
+
+	for (int i = 0; i < iCount; i++)
+	{
+		MatchRecord first, second;
+
+		if (!PlayMatch(sim, s_Expected[i].uSeed, first) || !PlayMatch(sim, s_Expected[i].uSeed, second))
+		{
+			iFailures++;
+			continue;
+		}
+
+		if (!SameRecord(first, s_Expected[i]))
+		{
+			PrintRecord("expected", s_Expected[i]);
+			PrintRecord("played  ", first);
+			iFailures++;
+		}
+
+		if (!SameRecord(first, second))
+		{
+			PrintRecord("replayed", second);
+			iFailures++;
+		}
+	}
+
+	int iRates = (int)(sizeof(TICK_RATES) / sizeof(TICK_RATES[0]));
+
+	for (int i = 0; i < iRates; i++)
+	{
+		if (!CheckTickRate(sim, TICK_RATES[i]))
+			iFailures++;
+	}
+
+	printf("%d matches, %d tick rates, %d failures\n", iCount, iRates, iFailures);
+
+	return iFailures ? 1 : 0;
+}
@@ -0,0 +1,220 @@
+//-----------------------------------------------------------------------------
+// File: SpriteAtlasTest.cpp
+//
+// Desc: Test of the sprite atlas: the packed rectangles stay inside their
+//		pages without overlapping, every image draws from the atlas exactly
+//		as from its own surfaces, and an image the caller let go of is still
+//		packed (and drawn) correctly by a second Build().
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// SpriteAtlasTest Specific Includes
+//-----------------------------------------------------------------------------
+#include "SpriteAtlas.h"
+#include "Blitters.h"
+#include "TestSupport.h"
+#include <stdio.h>
+#include <string.h>
+#include <memory>
+#include <vector>
+
+typedef std::shared_ptr<SpriteImage> ImagePtr;
+
+//-----------------------------------------------------------------------------
+// Name : MakeImage ()
+// Desc : A random image, masked or color keyed (a third of its pixels are
+//		the key).
+//-----------------------------------------------------------------------------
+static ImagePtr MakeImage(CTestRandom& random, int w, int h, bool bMasked)
+{
+	ImagePtr pImage(new SpriteImage);
+	pImage->image.Create(w, h);
+	pImage->uColorKey = 0x00FF00FF;
+
+	if (bMasked)
+		pImage->mask.Create(w, h);
+
+	for (int y = 0; y < h; y++)
+	{
+		for (int x = 0; x < w; x++)
+		{
+			uint32_t r = random.Next();
+
+			if (bMasked)
+			{
+				pImage->mask.Row(y)[x] = (r & 1) ? 0x00FFFFFF : 0;
+				pImage->image.Row(y)[x] = (r & 1) ? 0 : (random.Next() & 0x00FFFFFF);
+			}
+			else
+			{
+				pImage->image.Row(y)[x] = (r % 3 == 0) ? 0x00FF00FF : (random.Next() & 0x00FFFFFF);
+			}
+		}
+	}
+
+	return pImage;
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawsLikeItsImage ()
+// Desc : The atlas image drawn at a few places (some crossing the edges of
+//		the frame) against the same blits from the image itself.
+//-----------------------------------------------------------------------------
+static bool DrawsLikeItsImage(const CSpriteAtlas& atlas, int iIndex, const SpriteImage& image, CTestRandom& random)
+{
+	const int W = 200, H = 150;
+	CFrameBuffer expected, drawn;
+	expected.Create(W, H);
+	drawn.Create(W, H);
+
+	for (int n = 0; n < 8; n++)
+	{
+		int w = image.image.Width(), h = image.image.Height();
+		int x = random.Range(-w, W), y = random.Range(-h, H);
+		int sx = random.Range(-4, w / 2), sy = random.Range(-4, h / 2);
+		int cw = random.Range(1, w + 8), ch = random.Range(1, h + 8);
+
+		expected.Fill(0x00123456);
+		drawn.Fill(0x00123456);
+
+		if (image.mask.IsEmpty())
+			CBlitter::ColorKey(expected, x, y, image.image, sx, sy, cw, ch, image.uColorKey);
+		else
+			CBlitter::Mask(expected, x, y, image.image, image.mask, sx, sy, cw, ch);
+
+		atlas.Draw(drawn, x, y, iIndex, sx, sy, cw, ch);
+
+		if (memcmp(expected.Pixels(), drawn.Pixels(), W * H * sizeof(uint32_t)) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CheckPacking ()
+// Desc : Every rectangle inside its page, no two overlapping.
+//-----------------------------------------------------------------------------
+static bool CheckPacking(const CSpriteAtlas& atlas)
+{
+	for (int i = 0; i < atlas.Count(); i++)
+	{
+		const CSpriteAtlas::AtlasRect &a = atlas.Rect(i);
+		const CFrameBuffer &page = atlas.PageImage(a.iPage);
+
+		if (a.x < 0 || a.y < 0 || a.x + a.w > page.Width() || a.y + a.h > page.Height())
+			return false;
+
+		for (int j = 0; j < i; j++)
+		{
+			const CSpriteAtlas::AtlasRect &b = atlas.Rect(j);
+
+			if (a.iPage == b.iPage && a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+int main()
+{
+	CTestRandom random(19);
+	int iFailures = 0;
+
+	// Random sets of images, packed in small pages
+	for (int iSet = 0; iSet < 20; iSet++)
+	{
+		CSpriteAtlas atlas;
+		std::vector<ImagePtr> images;
+		int iCount = random.Range(1, 40);
+
+		for (int i = 0; i < iCount; i++)
+		{
+			images.push_back(MakeImage(random, random.Range(1, 150), random.Range(1, 150), random.Range(0, 1) != 0));
+
+			if (atlas.Add(images.back()) != i)
+				iFailures++;
+		}
+
+		// adding an image again gives its index
+		if (atlas.Add(images[0]) != 0)
+			iFailures++;
+
+		atlas.Build(256);
+
+		if (!CheckPacking(atlas))
+		{
+			printf("set %d: bad packing\n", iSet);
+			iFailures++;
+		}
+
+		for (int i = 0; i < iCount; i++)
+		{
+			if (atlas.Find(images[i]) != i || !DrawsLikeItsImage(atlas, i, *images[i], random))
+			{
+				printf("set %d: image %d doesn't draw like itself\n", iSet, i);
+				iFailures++;
+			}
+		}
+	}
+
+	// The atlas keeps the images it is given: the caller drops its
+	// references, new images are allocated (they could take the freed
+	// addresses) and the atlas is built twice
+	{
+		CSpriteAtlas atlas;
+		std::vector<ImagePtr> copies;
+
+		for (int i = 0; i < 10; i++)
+		{
+			ImagePtr pImage = MakeImage(random, random.Range(8, 60), random.Range(8, 60), (i & 1) != 0);
+
+			atlas.Add(pImage);
+
+			// a copy of the pixels to compare with, the atlas has the only reference
+			ImagePtr pCopy(new SpriteImage);
+			pCopy->image.Create(pImage->image.Width(), pImage->image.Height());
+			CBlitter::Copy(pCopy->image, 0, 0, pImage->image, 0, 0, pImage->image.Width(), pImage->image.Height());
+
+			if (!pImage->mask.IsEmpty())
+			{
+				pCopy->mask.Create(pImage->mask.Width(), pImage->mask.Height());
+				CBlitter::Copy(pCopy->mask, 0, 0, pImage->mask, 0, 0, pImage->mask.Width(), pImage->mask.Height());
+			}
+
+			pCopy->uColorKey = pImage->uColorKey;
+			copies.push_back(pCopy);
+		}
+
+		atlas.Build(128);
+
+		std::vector<ImagePtr> others;
+
+		for (int i = 0; i < 10; i++)
+		{
+			others.push_back(MakeImage(random, 20, 20, false));
+
+			if (atlas.Find(others.back()) >= 0)
+			{
+				printf("a new image is found in the atlas\n");
+				iFailures++;
+			}
+		}
+
+		atlas.Build(128);
+
+		for (int i = 0; i < 10; i++)
+		{
+			if (!DrawsLikeItsImage(atlas, i, *copies[i], random))
+			{
+				printf("image %d changed after its owner let it go\n", i);
+				iFailures++;
+			}
+		}
+	}
+
+	printf("%d failures\n", iFailures);
+
+	return iFailures ? 1 : 0;
+}
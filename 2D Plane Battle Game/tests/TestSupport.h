@@ -0,0 +1,164 @@
+//-----------------------------------------------------------------------------
+// File: TestSupport.h
+//
+// Desc: Helpers shared by the tests and the benchmarks: a seeded random
+//		generator (the results must not depend on the C library), the
+//		bitmaps of the game, and scripted players for the simulation.
+//
+// Note : This file must not depend on windows.h.
+//-----------------------------------------------------------------------------
+
+#ifndef _TESTSUPPORT_H_
+#define _TESTSUPPORT_H_
+
+//-----------------------------------------------------------------------------
+// TestSupport Specific Includes
+//-----------------------------------------------------------------------------
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include "BmpDecoder.h"
+#include "CollisionMask.h"
+#include "FrameBuffer.h"
+#include "Simulation.h"
+
+#ifndef GAME_DATA_DIR
+#define GAME_DATA_DIR "Data"
+#endif
+
+//-----------------------------------------------------------------------------
+// Name : CTestRandom (Class)
+// Desc : xorshift32, the same sequence on every platform.
+//-----------------------------------------------------------------------------
+class CTestRandom
+{
+public:
+	explicit CTestRandom(uint32_t uSeed) : m_uState(uSeed ? uSeed : 0x9E3779B9u) {}
+
+	uint32_t				Next()
+	{
+		m_uState ^= m_uState << 13;
+		m_uState ^= m_uState >> 17;
+		m_uState ^= m_uState << 5;
+		return m_uState;
+	}
+
+	// Uniform in [lo, hi]
+	int						Range(int lo, int hi) { return lo + (int)(Next() % (uint32_t)(hi - lo + 1)); }
+
+private:
+	uint32_t				m_uState;
+};
+
+//-----------------------------------------------------------------------------
+// Name : LoadBitmapFile ()
+// Desc : Decodes a bitmap, reports a file it can't read.
+//-----------------------------------------------------------------------------
+inline bool LoadBitmapFile(const char *szPath, CFrameBuffer& pixels)
+{
+	if (!CBmpDecoder::LoadFile(szPath, pixels))
+	{
+		fprintf(stderr, "can't load %s\n", szPath);
+		return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadGameBitmap ()
+// Desc : Decodes one of the bitmaps of the Data directory.
+//-----------------------------------------------------------------------------
+inline bool LoadGameBitmap(const char *szName, CFrameBuffer& pixels)
+{
+	return LoadBitmapFile((std::string(GAME_DATA_DIR) + "/" + szName).c_str(), pixels);
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadGameShapes ()
+// Desc : The collision masks the game gives the simulation: the plane and
+//		the enemy are color keyed (magenta), the bullet has a mask bitmap.
+//-----------------------------------------------------------------------------
+inline bool LoadGameShapes(CSimulation& sim)
+{
+	CFrameBuffer plane, enemy, bullet;
+	CCollisionMask mask;
+
+	if (!LoadGameBitmap("PlaneImgAndMask.bmp", plane) ||
+		!LoadGameBitmap("enemy_plane.bmp", enemy) ||
+		!LoadGameBitmap("bullet1_mask.bmp", bullet))
+		return false;
+
+	mask.BuildFromColorKey(plane.Pixels(), plane.Width(), plane.Height(), plane.Pitch(), 0x00FF00FF);
+	sim.SetShape(SIM_SHAPE_PLAYER, mask);
+
+	mask.BuildFromColorKey(enemy.Pixels(), enemy.Width(), enemy.Height(), enemy.Pitch(), 0x00FF00FF);
+	sim.SetShape(SIM_SHAPE_ENEMY, mask);
+
+	mask.BuildFromMask(bullet.Pixels(), bullet.Width(), bullet.Height(), bullet.Pitch());
+	sim.SetShape(SIM_SHAPE_BULLET, mask);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CSimScript (Class)
+// Desc : Plays both planes from a seed: every plane holds a random set of
+//		direction keys for a random number of ticks and keeps the fire key
+//		down most of the time. The same seed always gives the same match.
+//-----------------------------------------------------------------------------
+class CSimScript
+{
+public:
+	explicit CSimScript(uint32_t uSeed) : m_Random(uSeed)
+	{
+		for (int p = 0; p < SIM_PLAYER_COUNT; p++)
+		{
+			m_uDirection[p]	= 0;
+			m_iHold[p]		= 0;
+		}
+	}
+
+	void					Next(SimInput& input)
+	{
+		for (int p = 0; p < SIM_PLAYER_COUNT; p++)
+		{
+			if (--m_iHold[p] <= 0)
+			{
+				m_uDirection[p]	= m_Random.Next() & (SIM_DIR_FORWARD | SIM_DIR_BACKWARD | SIM_DIR_LEFT | SIM_DIR_RIGHT);
+				m_iHold[p]		= m_Random.Range(10, 90);
+			}
+
+			input.uDirection[p]	= m_uDirection[p];
+			input.bShoot[p]		= m_Random.Range(0, 3) != 0;
+		}
+	}
+
+private:
+	CTestRandom				m_Random;
+	unsigned int			m_uDirection[SIM_PLAYER_COUNT];
+	int						m_iHold[SIM_PLAYER_COUNT];
+};
+
+//-----------------------------------------------------------------------------
+// Name : PlayScriptedMatch ()
+// Desc : Resets the simulation and plays it with the script of uSeed until
+//		the match is over or ulMaxTicks have passed. Returns the ticks played.
+//-----------------------------------------------------------------------------
+inline unsigned long PlayScriptedMatch(CSimulation& sim, uint32_t uSeed, unsigned long ulMaxTicks)
+{
+	CSimScript script(uSeed);
+	SimInput input;
+
+	sim.Reset();
+
+	while (!sim.IsOver() && sim.TickCount() < ulMaxTicks)
+	{
+		script.Next(input);
+		sim.Tick(input);
+	}
+
+	return sim.TickCount();
+}
+
+#endif // _TESTSUPPORT_H_
@@ -0,0 +1,55 @@
+//-----------------------------------------------------------------------------
+// File: PackAssets.cpp
+//
+// Desc: Bakes bitmaps into an asset pack with CAssetPack::Build, without
+//		the game or windows.h. The images are found in the pack by the names
+//		given here, so give them the way the game loads them, from the game
+//		directory:
+//
+//		PackAssets data/assets.pack data/*.bmp
+//
+//		The exit code is 1 when the pack can't be written or a bitmap was
+//		left out.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// PackAssets Specific Includes
+//-----------------------------------------------------------------------------
+#include "AssetPack.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+	if (argc < 3)
+	{
+		printf("usage: PackAssets <pack file> <file.bmp> ...\n");
+		return 1;
+	}
+
+	std::vector<std::string> files(argv + 2, argv + argc);
+	int nPacked = CAssetPack::Build(argv[1], files);
+
+	if (nPacked < 0)
+	{
+		printf("failed to write %s\n", argv[1]);
+		return 1;
+	}
+
+	// report which ones Build left out (unreadable, or a name too long)
+	CAssetPack pack;
+
+	if (pack.Open(argv[1]))
+	{
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			if (pack.Find(files[i].c_str()) == -1)
+				printf("left out %s\n", files[i].c_str());
+		}
+	}
+
+	printf("packed %d of %d bitmaps into %s\n", nPacked, (int)files.size(), argv[1]);
+
+	return nPacked == (int)files.size() ? 0 : 1;
+}